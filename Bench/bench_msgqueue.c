@@ -0,0 +1,414 @@
+/************************************************************************************
+// Copyright (c) 2021 SS USA Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+************************************************************************************/
+
+/*
+ * Benchmark of per-device request queues. Requests are passed between threads of
+ * one process as pointers, once through SysV message queues with msgsnd()/msgrcv()
+ * as stack did before, and once through OSAL message queues (in-process ring with
+ * futex wakeups). Producers post at a fixed rate and one consumer receives, like
+ * application threads and the event loop serving a device.
+ *
+ * Usage: bench_msgqueue [rate req/s, 0 = unpaced] [seconds] [producers]
+ * Without arguments rates 10000, 50000, 100000 and unpaced are measured.
+ */
+
+/*
+ ===============================================================================
+ Includes :
+ ===============================================================================
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/ipc.h>
+#include <sys/msg.h>
+#include <sys/resource.h>
+#include "osalLinux.h"
+
+/*
+ ===============================================================================
+ Macro Definitions
+ ===============================================================================
+ */
+
+// Latency histogram resolution is 1 us, latencies above last bucket are counted in it
+#define BENCH_LAT_BUCKETS 200000
+// Producers post paced requests once per tick
+#define BENCH_TICK_NS 1000000L
+#define BENCH_MAX_PRODUCERS 64
+
+/*
+ ===============================================================================
+ Type Definitions
+ ===============================================================================
+ */
+
+typedef enum
+{
+	BENCH_QUEUE_SYSV,
+	BENCH_QUEUE_OSAL
+}eBenchQueue_t;
+
+typedef struct
+{
+	eBenchQueue_t m_eQueue;				// queue implementation under test
+	int m_iQueueId;						// queue id
+	long m_lRatePerProducer;			// requests per second, 0 for unpaced
+	long m_lCount;						// requests to post
+	long m_lFailed;						// failed posts
+}stBenchProducer_t;
+
+typedef struct
+{
+	eBenchQueue_t m_eQueue;
+	int m_iQueueId;
+	long m_lReceived;					// requests received
+	uint32_t *m_pu32LatHist;			// latency histogram, 1 us buckets
+}stBenchConsumer_t;
+
+/*
+ ===============================================================================
+ Function Definitions
+ ===============================================================================
+ */
+
+/**
+ * @fn static uint64_t getNowNs(void)
+ *
+ * @brief This function returns CLOCK_MONOTONIC time in ns.
+ *
+ * @return [out] uint64_t time in ns
+ *
+ */
+static uint64_t getNowNs(void)
+{
+	struct timespec stTs;
+	clock_gettime(CLOCK_MONOTONIC, &stTs);
+	return (uint64_t)stTs.tv_sec * 1000000000ULL + (uint64_t)stTs.tv_nsec;
+} // End of getNowNs
+
+/**
+ * @fn static bool postBenchMsg(eBenchQueue_t a_eQueue, int a_iQueueId, void *a_pvMsg)
+ *
+ * @brief This function posts a pointer to queue under test. SysV path is the
+ * one OSAL_Post_Message() used before: msgsnd() of Linux_Msg_t.
+ *
+ * @param a_eQueue 	 [in] eBenchQueue_t queue implementation
+ * @param a_iQueueId [in] int queue id
+ * @param a_pvMsg 	 [in] void* pointer to post
+ *
+ * @return [out] bool true if message is posted
+ *
+ */
+static bool postBenchMsg(eBenchQueue_t a_eQueue, int a_iQueueId, void *a_pvMsg)
+{
+	if(BENCH_QUEUE_SYSV == a_eQueue)
+	{
+		Linux_Msg_t stMsgData = {.mtype = 1, .wParam = a_pvMsg, .lParam = NULL};
+		return 0 == msgsnd(a_iQueueId, &stMsgData, sizeof(Linux_Msg_t) - sizeof(long), 0);
+	}
+	else
+	{
+		Post_Thread_Msg_t stPostMsg = {.idThread = a_iQueueId, .MsgType = 1,
+				.wParam = a_pvMsg, .lParam = NULL};
+		return OSAL_Post_Message(&stPostMsg);
+	}
+} // End of postBenchMsg
+
+/**
+ * @fn static bool getBenchMsg(eBenchQueue_t a_eQueue, int a_iQueueId, Linux_Msg_t *a_pstMsg)
+ *
+ * @brief This function waits for a message of queue under test.
+ *
+ * @param a_eQueue 	 [in]  eBenchQueue_t queue implementation
+ * @param a_iQueueId [in]  int queue id
+ * @param a_pstMsg 	 [out] Linux_Msg_t* received message
+ *
+ * @return [out] bool true if a message is received
+ *
+ */
+static bool getBenchMsg(eBenchQueue_t a_eQueue, int a_iQueueId, Linux_Msg_t *a_pstMsg)
+{
+	if(BENCH_QUEUE_SYSV == a_eQueue)
+	{
+		ssize_t lRet;
+		do
+		{
+			lRet = msgrcv(a_iQueueId, a_pstMsg, sizeof(Linux_Msg_t) - sizeof(long),
+					-OSAL_MSG_PRIORITY_LEVELS, 0);
+		}while(lRet < 0 && EINTR == errno);
+		return lRet > 0;
+	}
+	return OSAL_Get_Message(a_pstMsg, a_iQueueId);
+} // End of getBenchMsg
+
+/**
+ * @fn static void* producerThread(void *a_pvArg)
+ *
+ * @brief This function is producer thread routine. It posts send time of each
+ * request in place of request pointer, paced per tick if rate is given.
+ *
+ * @param a_pvArg [in] void* producer of type stBenchProducer_t
+ *
+ * @return [out] void* NULL
+ *
+ */
+static void* producerThread(void *a_pvArg)
+{
+	stBenchProducer_t *pstProd = (stBenchProducer_t *)a_pvArg;
+	struct timespec stNext;
+	long lPosted = 0;
+	long lTick = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &stNext);
+	while(lPosted < pstProd->m_lCount)
+	{
+		// requests due up to the end of this tick
+		long lDue = pstProd->m_lCount;
+		if(pstProd->m_lRatePerProducer > 0)
+		{
+			++lTick;
+			lDue = (lTick * pstProd->m_lRatePerProducer * BENCH_TICK_NS) / 1000000000L;
+			if(lDue > pstProd->m_lCount)
+			{
+				lDue = pstProd->m_lCount;
+			}
+		}
+		for(; lPosted < lDue; ++lPosted)
+		{
+			if(false == postBenchMsg(pstProd->m_eQueue, pstProd->m_iQueueId,
+					(void *)(uintptr_t)getNowNs()))
+			{
+				++pstProd->m_lFailed;
+			}
+		}
+		if(pstProd->m_lRatePerProducer > 0)
+		{
+			stNext.tv_nsec += BENCH_TICK_NS;
+			if(stNext.tv_nsec >= 1000000000L)
+			{
+				stNext.tv_nsec -= 1000000000L;
+				++stNext.tv_sec;
+			}
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &stNext, NULL);
+		}
+	}
+	return NULL;
+} // End of producerThread
+
+/**
+ * @fn static void* consumerThread(void *a_pvArg)
+ *
+ * @brief This function is consumer thread routine. It receives requests till a
+ * NULL request is received and records their queueing latency.
+ *
+ * @param a_pvArg [in] void* consumer of type stBenchConsumer_t
+ *
+ * @return [out] void* NULL
+ *
+ */
+static void* consumerThread(void *a_pvArg)
+{
+	stBenchConsumer_t *pstCons = (stBenchConsumer_t *)a_pvArg;
+	Linux_Msg_t stMsg;
+
+	while(getBenchMsg(pstCons->m_eQueue, pstCons->m_iQueueId, &stMsg))
+	{
+		uint64_t u64Lat;
+		if(NULL == stMsg.wParam)
+		{
+			break;
+		}
+		u64Lat = (getNowNs() - (uint64_t)(uintptr_t)stMsg.wParam) / 1000;
+		if(u64Lat >= BENCH_LAT_BUCKETS)
+		{
+			u64Lat = BENCH_LAT_BUCKETS - 1;
+		}
+		++pstCons->m_pu32LatHist[u64Lat];
+		++pstCons->m_lReceived;
+	}
+	return NULL;
+} // End of consumerThread
+
+/**
+ * @fn static long getPercentileUs(const uint32_t *a_pu32Hist, long a_lTotal, double a_dPct)
+ *
+ * @brief This function returns a percentile of latency histogram.
+ *
+ * @param a_pu32Hist [in] const uint32_t* histogram with 1 us buckets
+ * @param a_lTotal 	 [in] long number of samples
+ * @param a_dPct 	 [in] double percentile
+ *
+ * @return [out] long latency in us
+ *
+ */
+static long getPercentileUs(const uint32_t *a_pu32Hist, long a_lTotal, double a_dPct)
+{
+	long lRank = (long)(a_lTotal * a_dPct / 100.0);
+	long lSeen = 0;
+	long lBucket;
+
+	for(lBucket = 0; lBucket < BENCH_LAT_BUCKETS; ++lBucket)
+	{
+		lSeen += a_pu32Hist[lBucket];
+		if(lSeen > lRank)
+		{
+			break;
+		}
+	}
+	return lBucket;
+} // End of getPercentileUs
+
+/**
+ * @fn static double getCpuSec(void)
+ *
+ * @brief This function returns user and system CPU time of process.
+ *
+ * @return [out] double CPU time in s
+ *
+ */
+static double getCpuSec(void)
+{
+	struct rusage stUsage;
+	getrusage(RUSAGE_SELF, &stUsage);
+	return stUsage.ru_utime.tv_sec + stUsage.ru_stime.tv_sec +
+			(stUsage.ru_utime.tv_usec + stUsage.ru_stime.tv_usec) / 1e6;
+} // End of getCpuSec
+
+/**
+ * @fn static void runBench(eBenchQueue_t a_eQueue, long a_lRate, long a_lSec, int a_iProducers)
+ *
+ * @brief This function runs one measurement and prints achieved rate, CPU time
+ * per request and queueing latency.
+ *
+ * @param a_eQueue 	   [in] eBenchQueue_t queue implementation
+ * @param a_lRate 	   [in] long total requests per second, 0 for unpaced
+ * @param a_lSec 	   [in] long duration of paced run in s
+ * @param a_iProducers [in] int number of producer threads
+ *
+ */
+static void runBench(eBenchQueue_t a_eQueue, long a_lRate, long a_lSec, int a_iProducers)
+{
+	stBenchProducer_t astProd[BENCH_MAX_PRODUCERS];
+	stBenchConsumer_t stCons = {0};
+	pthread_t tidCons;
+	pthread_t atidProd[BENCH_MAX_PRODUCERS];
+	long lTotal = (a_lRate > 0 ? a_lRate : 500000) * a_lSec;
+	long lFailed = 0;
+	uint64_t u64Start, u64End;
+	double dCpuStart, dCpuEnd;
+	int iQueueId;
+	int i;
+
+	if(BENCH_QUEUE_SYSV == a_eQueue)
+	{
+		iQueueId = msgget(IPC_PRIVATE, (IPC_CREAT | IPC_EXCL | 0666));
+	}
+	else
+	{
+		iQueueId = OSAL_Init_Message_Queue();
+	}
+	if(iQueueId < 0)
+	{
+		perror("failed to create message queue");
+		return;
+	}
+	stCons.m_eQueue = a_eQueue;
+	stCons.m_iQueueId = iQueueId;
+	stCons.m_pu32LatHist = calloc(BENCH_LAT_BUCKETS, sizeof(uint32_t));
+	if(NULL == stCons.m_pu32LatHist)
+	{
+		return;
+	}
+
+	u64Start = getNowNs();
+	dCpuStart = getCpuSec();
+	pthread_create(&tidCons, NULL, consumerThread, &stCons);
+	for(i = 0; i < a_iProducers; ++i)
+	{
+		astProd[i].m_eQueue = a_eQueue;
+		astProd[i].m_iQueueId = iQueueId;
+		astProd[i].m_lRatePerProducer = a_lRate / a_iProducers;
+		astProd[i].m_lCount = lTotal / a_iProducers;
+		astProd[i].m_lFailed = 0;
+		pthread_create(&atidProd[i], NULL, producerThread, &astProd[i]);
+	}
+	for(i = 0; i < a_iProducers; ++i)
+	{
+		pthread_join(atidProd[i], NULL);
+		lFailed += astProd[i].m_lFailed;
+	}
+	postBenchMsg(a_eQueue, iQueueId, NULL);
+	pthread_join(tidCons, NULL);
+	u64End = getNowNs();
+	dCpuEnd = getCpuSec();
+
+	printf("%-5s rate=%-7ld posted=%-8ld failed=%-4ld achieved=%8.0f req/s"
+			"  cpu/req=%6.2f us  lat p50=%ld us p99=%ld us\n",
+			BENCH_QUEUE_SYSV == a_eQueue ? "sysv" : "osal", a_lRate,
+			stCons.m_lReceived, lFailed,
+			stCons.m_lReceived / ((u64End - u64Start) / 1e9),
+			(dCpuEnd - dCpuStart) * 1e6 / (stCons.m_lReceived ? stCons.m_lReceived : 1),
+			getPercentileUs(stCons.m_pu32LatHist, stCons.m_lReceived, 50.0),
+			getPercentileUs(stCons.m_pu32LatHist, stCons.m_lReceived, 99.0));
+
+	if(BENCH_QUEUE_SYSV == a_eQueue)
+	{
+		msgctl(iQueueId, IPC_RMID, NULL);
+	}
+	else
+	{
+		OSAL_Delete_Message_Queue(iQueueId);
+	}
+	free(stCons.m_pu32LatHist);
+} // End of runBench
+
+int main(int argc, char **argv)
+{
+	static const long alRates[] = {10000, 50000, 100000, 0};
+	long lSec = (argc > 2) ? atol(argv[2]) : 3;
+	int iProducers = (argc > 3) ? atoi(argv[3]) : 4;
+	size_t i;
+
+	if(iProducers < 1 || iProducers > BENCH_MAX_PRODUCERS || lSec < 1)
+	{
+		printf("Usage: %s [rate req/s, 0 = unpaced] [seconds] [producers 1-%d]\n",
+				argv[0], BENCH_MAX_PRODUCERS);
+		return 1;
+	}
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	printf("producers=%d duration=%ld s\n", iProducers, lSec);
+	for(i = 0; i < sizeof(alRates) / sizeof(alRates[0]); ++i)
+	{
+		long lRate = (argc > 1) ? atol(argv[1]) : alRates[i];
+		runBench(BENCH_QUEUE_SYSV, lRate, lSec, iProducers);
+		runBench(BENCH_QUEUE_OSAL, lRate, lSec, iProducers);
+		if(argc > 1)
+		{
+			break;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,449 @@
+/************************************************************************************
+// Copyright (c) 2021 SS USA Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+************************************************************************************/
+
+/*
+ * Benchmark of request pool layout. Allocator, timeout sweep and response matching
+ * of the stack are replayed on stReqHotMeta_t records in two layouts:
+ *  - split: hot metadata array parallel to request array, as stack keeps them
+ *  - inline: hot metadata stored in each request node next to its payload,
+ *    as it was before metadata was split out
+ * Nodes are visited in random order, like free-list and timeout lists are after
+ * requests of many devices have been interleaved.
+ *
+ * Usage: bench_reqlayout [pool size]
+ * Without arguments pool sizes 1024, MAX_REQUESTS, 16384 and 65536 are measured.
+ */
+
+/*
+ ===============================================================================
+ Includes :
+ ===============================================================================
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "StackConfig.h"
+
+/*
+ ===============================================================================
+ Macro Definitions
+ ===============================================================================
+ */
+
+// Each operation visits at least this many nodes
+#define BENCH_MIN_VISITS 20000000L
+// Timeout sweep relinks requests to this many lists, like a wheel cascade
+#define BENCH_SWEEP_LISTS 256
+
+/*
+ ===============================================================================
+ Type Definitions
+ ===============================================================================
+ */
+
+// Request node with inline metadata, layout before the split
+typedef struct
+{
+	stReqHotMeta_t m_stHot;
+	stMbusPacketVariables_t m_stReq;
+}stBenchInlineNode_t;
+
+typedef struct
+{
+	const char *m_pcName;
+	uint8_t *m_pu8HotBase;			// address of hot metadata of node 0
+	size_t m_szHotStride;			// distance between hot metadata of two nodes
+	uint8_t *m_pu8ReqBase;			// address of payload of node 0
+	size_t m_szReqStride;			// distance between payloads of two nodes
+}stBenchLayout_t;
+
+typedef struct
+{
+	int32_t m_i32Start;
+	int32_t m_i32Last;
+}stBenchList_t;
+
+/*
+ ===============================================================================
+ Function Definitions
+ ===============================================================================
+ */
+
+/**
+ * @fn static double getNowSec(void)
+ *
+ * @brief This function returns CLOCK_MONOTONIC time in s.
+ *
+ * @return [out] double time in s
+ *
+ */
+static double getNowSec(void)
+{
+	struct timespec stTs;
+	clock_gettime(CLOCK_MONOTONIC, &stTs);
+	return stTs.tv_sec + stTs.tv_nsec / 1e9;
+} // End of getNowSec
+
+/**
+ * @fn static inline stReqHotMeta_t* getHot(const stBenchLayout_t *a_pstLayout, uint32_t a_u32Id)
+ *
+ * @brief This function returns hot metadata of a node in layout under test.
+ *
+ * @param a_pstLayout [in] const stBenchLayout_t* layout under test
+ * @param a_u32Id 	  [in] uint32_t node index
+ *
+ * @return [out] stReqHotMeta_t* hot metadata of node
+ *
+ */
+static inline stReqHotMeta_t* getHot(const stBenchLayout_t *a_pstLayout, uint32_t a_u32Id)
+{
+	return (stReqHotMeta_t *)(a_pstLayout->m_pu8HotBase + a_u32Id * a_pstLayout->m_szHotStride);
+} // End of getHot
+
+/**
+ * @fn static inline stMbusPacketVariables_t* getReq(const stBenchLayout_t *a_pstLayout, uint32_t a_u32Id)
+ *
+ * @brief This function returns payload of a node in layout under test.
+ *
+ * @param a_pstLayout [in] const stBenchLayout_t* layout under test
+ * @param a_u32Id 	  [in] uint32_t node index
+ *
+ * @return [out] stMbusPacketVariables_t* payload of node
+ *
+ */
+static inline stMbusPacketVariables_t* getReq(const stBenchLayout_t *a_pstLayout, uint32_t a_u32Id)
+{
+	return (stMbusPacketVariables_t *)(a_pstLayout->m_pu8ReqBase + a_u32Id * a_pstLayout->m_szReqStride);
+} // End of getReq
+
+/**
+ * @fn static void shuffleIds(uint32_t *a_pu32Ids, uint32_t a_u32Count)
+ *
+ * @brief This function fills array with node indices in random order.
+ *
+ * @param a_pu32Ids   [out] uint32_t* array of indices
+ * @param a_u32Count  [in]  uint32_t number of nodes
+ *
+ */
+static void shuffleIds(uint32_t *a_pu32Ids, uint32_t a_u32Count)
+{
+	uint32_t u32Id;
+
+	for(u32Id = 0; u32Id < a_u32Count; ++u32Id)
+	{
+		a_pu32Ids[u32Id] = u32Id;
+	}
+	for(u32Id = a_u32Count - 1; u32Id > 0; --u32Id)
+	{
+		uint32_t u32Swap = (uint32_t)random() % (u32Id + 1);
+		uint32_t u32Tmp = a_pu32Ids[u32Id];
+		a_pu32Ids[u32Id] = a_pu32Ids[u32Swap];
+		a_pu32Ids[u32Swap] = u32Tmp;
+	}
+} // End of shuffleIds
+
+/**
+ * @fn static double benchAllocator(const stBenchLayout_t *a_pstLayout, uint32_t a_u32Count,
+ * 									const uint32_t *a_pu32Order, long a_lRounds)
+ *
+ * @brief This function replays the allocator: all nodes are popped from free-list and
+ * reserved like getAvailableReqNode() does, then released and pushed back like
+ * putBackReqNode() does.
+ *
+ * @param a_pstLayout [in] const stBenchLayout_t* layout under test
+ * @param a_u32Count  [in] uint32_t number of nodes
+ * @param a_pu32Order [in] const uint32_t* order nodes are freed in
+ * @param a_lRounds   [in] long number of rounds
+ *
+ * @return [out] double ns per node taken and given back
+ *
+ */
+static double benchAllocator(const stBenchLayout_t *a_pstLayout, uint32_t a_u32Count,
+		const uint32_t *a_pu32Order, long a_lRounds)
+{
+	uint32_t u32Head = REQ_FREE_LIST_END;
+	uint32_t u32Taken = REQ_FREE_LIST_END;
+	double dStart;
+	uint32_t u32Pos;
+	long lRound;
+
+	for(u32Pos = 0; u32Pos < a_u32Count; ++u32Pos)
+	{
+		stReqHotMeta_t *pstHot = getHot(a_pstLayout, a_pu32Order[u32Pos]);
+		atomic_store(&pstHot->m_state, IdleState);
+		atomic_store(&pstHot->m_u32NextFree, u32Head);
+		u32Head = a_pu32Order[u32Pos];
+	}
+
+	dStart = getNowSec();
+	for(lRound = 0; lRound < a_lRounds; ++lRound)
+	{
+		// take all nodes, taken nodes are chained to be given back in another order
+		while(REQ_FREE_LIST_END != u32Head)
+		{
+			stReqHotMeta_t *pstHot = getHot(a_pstLayout, u32Head);
+			eTransactionState expected = IdleState;
+			uint32_t u32Node = u32Head;
+
+			u32Head = atomic_load(&pstHot->m_u32NextFree);
+			if(atomic_compare_exchange_strong(&pstHot->m_state, &expected, RESERVED))
+			{
+				pstHot->m_i32TimeoutNext = (int32_t)u32Taken;
+				u32Taken = u32Node;
+			}
+		}
+		while(REQ_FREE_LIST_END != u32Taken)
+		{
+			stReqHotMeta_t *pstHot = getHot(a_pstLayout, u32Taken);
+			eTransactionState expected = RESERVED;
+			uint32_t u32Node = u32Taken;
+
+			u32Taken = (uint32_t)pstHot->m_i32TimeoutNext;
+			if(atomic_compare_exchange_strong(&pstHot->m_state, &expected, IdleState))
+			{
+				atomic_store(&pstHot->m_u32NextFree, u32Head);
+				u32Head = u32Node;
+			}
+		}
+	}
+	return (getNowSec() - dStart) * 1e9 / ((double)a_lRounds * a_u32Count);
+} // End of benchAllocator
+
+/**
+ * @fn static double benchTimeoutSweep(const stBenchLayout_t *a_pstLayout, uint32_t a_u32Count,
+ * 									const uint32_t *a_pu32Order, long a_lRounds)
+ *
+ * @brief This function replays a timeout sweep: a list of all requests in flight is
+ * walked like cascadeWheelList() does, and each request is relinked by its deadline.
+ *
+ * @param a_pstLayout [in] const stBenchLayout_t* layout under test
+ * @param a_u32Count  [in] uint32_t number of nodes
+ * @param a_pu32Order [in] const uint32_t* order of nodes in list
+ * @param a_lRounds   [in] long number of rounds
+ *
+ * @return [out] double ns per request visited
+ *
+ */
+static double benchTimeoutSweep(const stBenchLayout_t *a_pstLayout, uint32_t a_u32Count,
+		const uint32_t *a_pu32Order, long a_lRounds)
+{
+	stBenchList_t astLists[BENCH_SWEEP_LISTS];
+	int32_t i32Start = REQ_LINK_NONE;
+	double dStart;
+	uint32_t u32Pos;
+	long lRound;
+	int iList;
+
+	for(u32Pos = 0; u32Pos < a_u32Count; ++u32Pos)
+	{
+		stReqHotMeta_t *pstHot = getHot(a_pstLayout, a_pu32Order[u32Pos]);
+		atomic_store(&pstHot->m_state, REQ_SENT_ON_NETWORK);
+		pstHot->m_u32DeadlineMs = (uint32_t)random();
+		pstHot->m_i32TimeoutNext = i32Start;
+		pstHot->m_i32TimeoutPrev = REQ_LINK_NONE;
+		i32Start = (int32_t)a_pu32Order[u32Pos];
+	}
+
+	dStart = getNowSec();
+	for(lRound = 0; lRound < a_lRounds; ++lRound)
+	{
+		int32_t i32NextNode = i32Start;
+
+		for(iList = 0; iList < BENCH_SWEEP_LISTS; ++iList)
+		{
+			astLists[iList].m_i32Start = REQ_LINK_NONE;
+			astLists[iList].m_i32Last = REQ_LINK_NONE;
+		}
+		while(REQ_LINK_NONE != i32NextNode)
+		{
+			int32_t i32Cur = i32NextNode;
+			stReqHotMeta_t *pstHot = getHot(a_pstLayout, (uint32_t)i32Cur);
+			stBenchList_t *pstList;
+
+			i32NextNode = pstHot->m_i32TimeoutNext;
+			pstList = &astLists[(pstHot->m_u32DeadlineMs >> 8) % BENCH_SWEEP_LISTS];
+			pstHot->m_iTimeOutIndex = (int)(pstList - astLists);
+			pstHot->m_i32TimeoutNext = REQ_LINK_NONE;
+			pstHot->m_i32TimeoutPrev = pstList->m_i32Last;
+			if(REQ_LINK_NONE == pstList->m_i32Last)
+			{
+				pstList->m_i32Start = i32Cur;
+			}
+			else
+			{
+				getHot(a_pstLayout, (uint32_t)pstList->m_i32Last)->m_i32TimeoutNext = i32Cur;
+			}
+			pstList->m_i32Last = i32Cur;
+		}
+		// lists are chained back to one list for next round
+		i32Start = REQ_LINK_NONE;
+		for(iList = BENCH_SWEEP_LISTS - 1; iList >= 0; --iList)
+		{
+			if(REQ_LINK_NONE != astLists[iList].m_i32Start)
+			{
+				getHot(a_pstLayout, (uint32_t)astLists[iList].m_i32Last)->m_i32TimeoutNext = i32Start;
+				i32Start = astLists[iList].m_i32Start;
+			}
+		}
+	}
+	return (getNowSec() - dStart) * 1e9 / ((double)a_lRounds * a_u32Count);
+} // End of benchTimeoutSweep
+
+/**
+ * @fn static double benchRespMatch(const stBenchLayout_t *a_pstLayout, uint32_t a_u32Count,
+ * 									const uint32_t *a_pu32Order, long a_lRounds)
+ *
+ * @brief This function replays response matching like markRespRcvd() does: request
+ * is found by index in transaction id and checked on hot metadata, connection is
+ * read from payload only when metadata matches. One of four responses is stale.
+ *
+ * @param a_pstLayout [in] const stBenchLayout_t* layout under test
+ * @param a_u32Count  [in] uint32_t number of nodes
+ * @param a_pu32Order [in] const uint32_t* order responses arrive in
+ * @param a_lRounds   [in] long number of rounds
+ *
+ * @return [out] double ns per response
+ *
+ */
+static double benchRespMatch(const stBenchLayout_t *a_pstLayout, uint32_t a_u32Count,
+		const uint32_t *a_pu32Order, long a_lRounds)
+{
+	long lMatched = 0;
+	double dStart;
+	double dNs;
+	uint32_t u32Pos;
+	long lRound;
+
+	for(u32Pos = 0; u32Pos < a_u32Count; ++u32Pos)
+	{
+		stReqHotMeta_t *pstHot = getHot(a_pstLayout, u32Pos);
+		atomic_store(&pstHot->m_state, REQ_SENT_ON_NETWORK);
+		pstHot->m_u16TransactionID = (uint16_t)u32Pos;
+		pstHot->m_u8UnitID = (uint8_t)(u32Pos & 3);
+		getReq(a_pstLayout, u32Pos)->m_pstConn = NULL;
+	}
+
+	dStart = getNowSec();
+	for(lRound = 0; lRound < a_lRounds; ++lRound)
+	{
+		for(u32Pos = 0; u32Pos < a_u32Count; ++u32Pos)
+		{
+			uint32_t u32Index = a_pu32Order[u32Pos];
+			stReqHotMeta_t *pstHot = getHot(a_pstLayout, u32Index);
+			eTransactionState expected = REQ_SENT_ON_NETWORK;
+			// stale responses carry unit id of another request
+			uint8_t u8UnitID = (uint8_t)((u32Index + (0 == (u32Pos & 3) ? 1 : 0)) & 3);
+
+			if(u8UnitID == pstHot->m_u8UnitID && (uint16_t)u32Index == pstHot->m_u16TransactionID &&
+					expected == atomic_load(&pstHot->m_state) &&
+					NULL == getReq(a_pstLayout, u32Index)->m_pstConn)
+			{
+				if(atomic_compare_exchange_strong(&pstHot->m_state, &expected, RESP_RCVD_FROM_NETWORK))
+				{
+					++lMatched;
+					atomic_store(&pstHot->m_state, REQ_SENT_ON_NETWORK);
+				}
+			}
+		}
+	}
+	dNs = (getNowSec() - dStart) * 1e9 / ((double)a_lRounds * a_u32Count);
+	if(lMatched != a_lRounds * (long)(a_u32Count - (a_u32Count + 3) / 4))
+	{
+		printf("unexpected match count %ld\n", lMatched);
+	}
+	return dNs;
+} // End of benchRespMatch
+
+/**
+ * @fn static void runBench(uint32_t a_u32Count)
+ *
+ * @brief This function measures all operations on both layouts for a pool size.
+ *
+ * @param a_u32Count [in] uint32_t number of request nodes
+ *
+ */
+static void runBench(uint32_t a_u32Count)
+{
+	stReqHotMeta_t *pstHot = calloc(a_u32Count, sizeof(stReqHotMeta_t));
+	stMbusPacketVariables_t *pstReq = calloc(a_u32Count, sizeof(stMbusPacketVariables_t));
+	stBenchInlineNode_t *pstInline = calloc(a_u32Count, sizeof(stBenchInlineNode_t));
+	uint32_t *pu32Order = calloc(a_u32Count, sizeof(uint32_t));
+	long lRounds = BENCH_MIN_VISITS / a_u32Count + 1;
+	stBenchLayout_t astLayout[2] = {
+		{"split", (uint8_t *)pstHot, sizeof(stReqHotMeta_t),
+				(uint8_t *)pstReq, sizeof(stMbusPacketVariables_t)},
+		{"inline", (uint8_t *)&pstInline[0].m_stHot, sizeof(stBenchInlineNode_t),
+				(uint8_t *)&pstInline[0].m_stReq, sizeof(stBenchInlineNode_t)}
+	};
+	int i;
+
+	if(NULL == pstHot || NULL == pstReq || NULL == pstInline || NULL == pu32Order)
+	{
+		printf("Memory allocation failed\n");
+		return;
+	}
+	for(i = 0; i < 2; ++i)
+	{
+		double dAlloc, dSweep, dMatch;
+
+		srandom(a_u32Count);
+		shuffleIds(pu32Order, a_u32Count);
+		dAlloc = benchAllocator(&astLayout[i], a_u32Count, pu32Order, lRounds);
+		dSweep = benchTimeoutSweep(&astLayout[i], a_u32Count, pu32Order, lRounds);
+		dMatch = benchRespMatch(&astLayout[i], a_u32Count, pu32Order, lRounds);
+		printf("pool=%-6u %-6s alloc=%6.2f ns/node  sweep=%6.2f ns/req  match=%6.2f ns/resp\n",
+				a_u32Count, astLayout[i].m_pcName, dAlloc, dSweep, dMatch);
+	}
+	free(pstHot);
+	free(pstReq);
+	free(pstInline);
+	free(pu32Order);
+} // End of runBench
+
+int main(int argc, char **argv)
+{
+	static const uint32_t au32Sizes[] = {1024, MAX_REQUESTS, 16384, 65536};
+	size_t i;
+
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	printf("sizeof(stReqHotMeta_t)=%zu sizeof(stMbusPacketVariables_t)=%zu\n",
+			sizeof(stReqHotMeta_t), sizeof(stMbusPacketVariables_t));
+	if(argc > 1)
+	{
+		uint32_t u32Count = (uint32_t)strtoul(argv[1], NULL, 0);
+		if(u32Count < 4 || u32Count > 65536)
+		{
+			printf("Usage: %s [pool size 4-65536]\n", argv[0]);
+			return 1;
+		}
+		runBench(u32Count);
+		return 0;
+	}
+	for(i = 0; i < sizeof(au32Sizes) / sizeof(au32Sizes[0]); ++i)
+	{
+		runBench(au32Sizes[i]);
+	}
+	return 0;
+}
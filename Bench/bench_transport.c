@@ -0,0 +1,584 @@
+/************************************************************************************
+// Copyright (c) 2021 SS USA Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+************************************************************************************/
+
+/*
+ * Loopback benchmark of Modbus TCP transport. It is built twice, with event loops
+ * using epoll and with MODBUS_STACK_IO_URING_ENABLED, from the same source.
+ * A Modbus TCP server process answers read holding registers requests on loopback.
+ * Client process sends requests through the stack with a fixed number in flight,
+ * once to measure round trip latency, and once traced with ptrace() to count
+ * system calls of all stack and application threads per transaction.
+ *
+ * Usage: bench_transport [devices] [in flight per device] [requests]
+ * Without arguments 1 device with 1 request in flight and 4 devices with 16
+ * requests in flight each are measured.
+ */
+
+/*
+ ===============================================================================
+ Includes :
+ ===============================================================================
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <errno.h>
+#include <signal.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/ptrace.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include "API.h"
+
+/*
+ ===============================================================================
+ Macro Definitions
+ ===============================================================================
+ */
+
+#define BENCH_MAX_DEVICES 64
+// Latency histogram resolution is 1 us, latencies above last bucket are counted in it
+#define BENCH_LAT_BUCKETS 100000
+// Traced run sends this share of requests, since every system call stops client twice
+#define BENCH_TRACE_DIVISOR 10
+// Largest system call number counted
+#define BENCH_MAX_SYSCALL 512
+// Registers read by each request
+#define BENCH_REGISTERS 10
+
+/*
+ ===============================================================================
+ Global Variables
+ ===============================================================================
+ */
+
+static sem_t g_semSlots;								// free request slots of client
+static _Atomic long g_lDone;							// responses received by client
+static _Atomic long g_lFailed;							// error or timeout responses
+static uint64_t g_au64SentNs[65536];					// send time by application transaction id
+static _Atomic uint32_t g_au32LatHist[BENCH_LAT_BUCKETS];	// round trip latency, 1 us buckets
+
+/*
+ ===============================================================================
+ Function Definitions
+ ===============================================================================
+ */
+
+/**
+ * @fn static uint64_t getNowNs(void)
+ *
+ * @brief This function returns CLOCK_MONOTONIC time in ns.
+ *
+ * @return [out] uint64_t time in ns
+ *
+ */
+static uint64_t getNowNs(void)
+{
+	struct timespec stTs;
+	clock_gettime(CLOCK_MONOTONIC, &stTs);
+	return (uint64_t)stTs.tv_sec * 1000000000ULL + (uint64_t)stTs.tv_nsec;
+} // End of getNowNs
+
+/**
+ * @fn static void serveConnection(int a_iFd, uint8_t *a_pu8Buf, size_t *a_pszFill)
+ *
+ * @brief This function reads a server connection and answers every complete request
+ * frame with BENCH_REGISTERS registers. Answers of one read are sent together.
+ *
+ * @param a_iFd 	 [in] 	  int connection socket
+ * @param a_pu8Buf 	 [in,out] uint8_t* receive buffer of connection, 4096 bytes
+ * @param a_pszFill  [in,out] size_t* bytes held in receive buffer
+ *
+ * @return [out] none; connection is closed on error
+ *
+ */
+static void serveConnection(int a_iFd, uint8_t *a_pu8Buf, size_t *a_pszFill)
+{
+	uint8_t au8Out[16384];
+	ssize_t lRead;
+
+	while((lRead = read(a_iFd, a_pu8Buf + *a_pszFill, 4096 - *a_pszFill)) > 0)
+	{
+		size_t szOut = 0;
+		size_t szPos = 0;
+
+		*a_pszFill += (size_t)lRead;
+		while(*a_pszFill - szPos >= 7)
+		{
+			size_t szFrame = 6 + (((size_t)a_pu8Buf[szPos + 4] << 8) | a_pu8Buf[szPos + 5]);
+			uint8_t *pu8Resp = au8Out + szOut;
+			int i;
+
+			if(*a_pszFill - szPos < szFrame || szOut + 9 + 2 * BENCH_REGISTERS > sizeof(au8Out))
+			{
+				break;
+			}
+			// MBAP header: transaction id, protocol id, length, unit id
+			memcpy(pu8Resp, a_pu8Buf + szPos, 4);
+			pu8Resp[4] = 0;
+			pu8Resp[5] = 3 + 2 * BENCH_REGISTERS;
+			pu8Resp[6] = a_pu8Buf[szPos + 6];
+			pu8Resp[7] = a_pu8Buf[szPos + 7];
+			pu8Resp[8] = 2 * BENCH_REGISTERS;
+			for(i = 0; i < 2 * BENCH_REGISTERS; ++i)
+			{
+				pu8Resp[9 + i] = (uint8_t)i;
+			}
+			szOut += 9 + 2 * BENCH_REGISTERS;
+			szPos += szFrame;
+		}
+		memmove(a_pu8Buf, a_pu8Buf + szPos, *a_pszFill - szPos);
+		*a_pszFill -= szPos;
+		if(szOut > 0 && send(a_iFd, au8Out, szOut, MSG_NOSIGNAL) != (ssize_t)szOut)
+		{
+			break;
+		}
+	}
+	if(0 == lRead || (lRead < 0 && EAGAIN != errno))
+	{
+		close(a_iFd);
+	}
+} // End of serveConnection
+
+/**
+ * @fn static void runServer(const int *a_piListenFds, int a_iCount)
+ *
+ * @brief This function is Modbus TCP server process routine, serving all
+ * connections from one epoll loop. It never returns.
+ *
+ * @param a_piListenFds [in] const int* listening sockets, one per device
+ * @param a_iCount 		[in] int number of listening sockets
+ *
+ */
+static void runServer(const int *a_piListenFds, int a_iCount)
+{
+	static uint8_t au8Bufs[1024][4096];
+	static size_t aszFill[1024];
+	struct epoll_event astEvents[64];
+	int iEpollFd = epoll_create1(0);
+	int i;
+
+	for(i = 0; i < a_iCount; ++i)
+	{
+		struct epoll_event stEvent = {.events = EPOLLIN, .data.u64 = (uint32_t)a_piListenFds[i]};
+		epoll_ctl(iEpollFd, EPOLL_CTL_ADD, a_piListenFds[i], &stEvent);
+	}
+	while(1)
+	{
+		int iReady = epoll_wait(iEpollFd, astEvents, 64, -1);
+		for(i = 0; i < iReady; ++i)
+		{
+			int iFd = (int)(uint32_t)astEvents[i].data.u64;
+			if(astEvents[i].data.u64 >> 32)
+			{
+				// connection, upper half of data marks it
+				serveConnection(iFd, au8Bufs[iFd], &aszFill[iFd]);
+			}
+			else
+			{
+				int iConnFd = accept4(iFd, NULL, NULL, SOCK_NONBLOCK);
+				if(iConnFd >= 0 && iConnFd < 1024)
+				{
+					struct epoll_event stEvent = {.events = EPOLLIN | EPOLLET,
+							.data.u64 = (1ULL << 32) | (uint32_t)iConnFd};
+					aszFill[iConnFd] = 0;
+					epoll_ctl(iEpollFd, EPOLL_CTL_ADD, iConnFd, &stEvent);
+				}
+			}
+		}
+	}
+} // End of runServer
+
+/**
+ * @fn static void respCallback(stMbusAppCallbackParams_t *a_pstParams, uint16_t a_u16TransactionID)
+ *
+ * @brief This function is response callback of client. It records round trip
+ * latency of request and frees its slot.
+ *
+ * @param a_pstParams 		 [in] stMbusAppCallbackParams_t* response
+ * @param a_u16TransactionID [in] uint16_t transaction id sent on network
+ *
+ */
+static void respCallback(stMbusAppCallbackParams_t *a_pstParams, uint16_t a_u16TransactionID)
+{
+	uint64_t u64Lat = (getNowNs() - g_au64SentNs[a_pstParams->m_u16TransactionID]) / 1000;
+
+	(void)a_u16TransactionID;
+	if(0 != a_pstParams->m_u8ExceptionExcStatus)
+	{
+		atomic_fetch_add(&g_lFailed, 1);
+	}
+	if(u64Lat >= BENCH_LAT_BUCKETS)
+	{
+		u64Lat = BENCH_LAT_BUCKETS - 1;
+	}
+	atomic_fetch_add(&g_au32LatHist[u64Lat], 1);
+	atomic_fetch_add(&g_lDone, 1);
+	sem_post(&g_semSlots);
+} // End of respCallback
+
+/**
+ * @fn static long getPercentileUs(long a_lTotal, double a_dPct)
+ *
+ * @brief This function returns a percentile of latency histogram.
+ *
+ * @param a_lTotal [in] long number of samples
+ * @param a_dPct   [in] double percentile
+ *
+ * @return [out] long latency in us
+ *
+ */
+static long getPercentileUs(long a_lTotal, double a_dPct)
+{
+	long lRank = (long)(a_lTotal * a_dPct / 100.0);
+	long lSeen = 0;
+	long lBucket;
+
+	for(lBucket = 0; lBucket < BENCH_LAT_BUCKETS; ++lBucket)
+	{
+		lSeen += atomic_load(&g_au32LatHist[lBucket]);
+		if(lSeen > lRank)
+		{
+			break;
+		}
+	}
+	return lBucket;
+} // End of getPercentileUs
+
+/**
+ * @fn static void runClient(const uint16_t *a_pu16Ports, int a_iDevices, int a_iWindow,
+ * 							long a_lRequests, bool a_bTraced)
+ *
+ * @brief This function is client process routine. Requests are sent round robin to
+ * devices with at most a_iWindow requests in flight per device. Measured phase is
+ * marked with getppid() calls for tracer. It never returns.
+ *
+ * @param a_pu16Ports [in] const uint16_t* server port of each device
+ * @param a_iDevices  [in] int number of devices
+ * @param a_iWindow   [in] int requests in flight per device
+ * @param a_lRequests [in] long requests to send
+ * @param a_bTraced   [in] bool true if process is traced, latency is not reported
+ *
+ */
+static void runClient(const uint16_t *a_pu16Ports, int a_iDevices, int a_iWindow,
+		long a_lRequests, bool a_bTraced)
+{
+	stStackInitConfig_t stConfig = {0};
+	stDevConfig_t stDevConfig = {0};
+	uint8_t au8Ip[4] = {127, 0, 0, 1};
+	int aiCtx[BENCH_MAX_DEVICES];
+	uint64_t u64Start;
+	double dSec;
+	long lReq;
+	int i;
+
+	if(true == a_bTraced)
+	{
+		ptrace(PTRACE_TRACEME, 0, NULL, NULL);
+		raise(SIGSTOP);
+	}
+	// stack messages are shown once, by latency run
+	if(true == a_bTraced && NULL == freopen("/dev/null", "w", stdout))
+	{
+		_exit(1);
+	}
+	stDevConfig.m_lResponseTimeout = 4000;
+	AppMbusMaster_SetStackConfigParam(&stDevConfig);
+	stConfig.m_u32Reactors = 1;
+	stConfig.m_u32RespDispatchers = 1;
+	if(STS_MBUS_STACK_NO_ERROR != AppMbusMaster_StackInit(&stConfig))
+	{
+		fprintf(stderr, "stack init failed\n");
+		_exit(1);
+	}
+	for(i = 0; i < a_iDevices; ++i)
+	{
+		stCtxInfo stCtx = {0};
+		stCtx.pu8SerIpAddr = au8Ip;
+		stCtx.u16Port = a_pu16Ports[i];
+		if(STS_MBUS_STACK_NO_ERROR != getTCPCtx(&aiCtx[i], &stCtx))
+		{
+			fprintf(stderr, "context create failed\n");
+			_exit(1);
+		}
+	}
+	sem_init(&g_semSlots, 0, (unsigned int)(a_iDevices * a_iWindow));
+	// connections are set up by first requests, before measured phase
+	for(lReq = 0; lReq < a_iDevices; ++lReq)
+	{
+		sem_wait(&g_semSlots);
+		Modbus_Read_Holding_Registers(0, BENCH_REGISTERS, (uint16_t)lReq, 1, 1, aiCtx[lReq], respCallback);
+	}
+	while(atomic_load(&g_lDone) < a_iDevices)
+	{
+		usleep(1000);
+	}
+	memset(g_au32LatHist, 0, sizeof(g_au32LatHist));
+	atomic_store(&g_lDone, 0);
+	atomic_store(&g_lFailed, 0);
+
+	syscall(SYS_getppid);
+	u64Start = getNowNs();
+	for(lReq = 0; lReq < a_lRequests; ++lReq)
+	{
+		t_Status eStatus;
+
+		sem_wait(&g_semSlots);
+		g_au64SentNs[(uint16_t)lReq] = getNowNs();
+		while(STS_MBUS_STACK_ERROR_MAX_REQ_SENT == (eStatus = Modbus_Read_Holding_Registers(0,
+				BENCH_REGISTERS, (uint16_t)lReq, 1, 1, aiCtx[lReq % a_iDevices], respCallback)))
+		{
+			usleep(100);
+		}
+		if(STS_MBUS_STACK_NO_ERROR != eStatus)
+		{
+			atomic_fetch_add(&g_lFailed, 1);
+			atomic_fetch_add(&g_lDone, 1);
+			sem_post(&g_semSlots);
+		}
+	}
+	for(i = 0; i < a_iDevices * a_iWindow; ++i)
+	{
+		sem_wait(&g_semSlots);
+	}
+	dSec = (getNowNs() - u64Start) / 1e9;
+	syscall(SYS_getppid);
+
+	if(false == a_bTraced)
+	{
+		fprintf(stderr, "  latency: %.0f trans/s  p50=%ld us  p99=%ld us  failed=%ld\n",
+				a_lRequests / dSec, getPercentileUs(a_lRequests, 50.0),
+				getPercentileUs(a_lRequests, 99.0), atomic_load(&g_lFailed));
+	}
+	_exit(0);
+} // End of runClient
+
+/**
+ * @fn static const char* getSyscallName(long a_lNr)
+ *
+ * @brief This function names system calls used on transaction path.
+ *
+ * @param a_lNr [in] long system call number
+ *
+ * @return [out] const char* name; NULL for other system calls
+ *
+ */
+static const char* getSyscallName(long a_lNr)
+{
+	switch(a_lNr)
+	{
+	case SYS_io_uring_enter: return "io_uring_enter";
+	case SYS_epoll_wait: return "epoll_wait";
+	case SYS_epoll_pwait: return "epoll_pwait";
+	case SYS_sendto: return "sendto";
+	case SYS_recvfrom: return "recvfrom";
+	case SYS_recvmsg: return "recvmsg";
+	case SYS_read: return "read";
+	case SYS_write: return "write";
+	case SYS_futex: return "futex";
+	case SYS_timerfd_settime: return "timerfd_settime";
+	default: return NULL;
+	}
+} // End of getSyscallName
+
+/**
+ * @fn static void traceClient(pid_t a_pidClient, long a_lRequests)
+ *
+ * @brief This function traces all threads of client process and counts system
+ * calls they enter between the two getppid() marks of measured phase.
+ *
+ * @param a_pidClient [in] pid_t client process stopped after PTRACE_TRACEME
+ * @param a_lRequests [in] long transactions of measured phase
+ *
+ */
+static void traceClient(pid_t a_pidClient, long a_lRequests)
+{
+	static long alCount[BENCH_MAX_SYSCALL];
+	struct __ptrace_syscall_info stInfo;
+	bool bCounting = false;
+	long lTotal = 0;
+	long lOther = 0;
+	long lNr;
+	int iStatus;
+	pid_t tid;
+
+	memset(alCount, 0, sizeof(alCount));
+	waitpid(a_pidClient, &iStatus, 0);
+	ptrace(PTRACE_SETOPTIONS, a_pidClient, NULL,
+			PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACECLONE | PTRACE_O_EXITKILL);
+	ptrace(PTRACE_SYSCALL, a_pidClient, NULL, NULL);
+	while((tid = waitpid(-1, &iStatus, __WALL)) > 0)
+	{
+		int iSig = 0;
+
+		if(WIFEXITED(iStatus) || WIFSIGNALED(iStatus))
+		{
+			if(tid == a_pidClient)
+			{
+				break;
+			}
+			continue;
+		}
+		if((SIGTRAP | 0x80) == WSTOPSIG(iStatus))
+		{
+			if(ptrace(PTRACE_GET_SYSCALL_INFO, tid, (void *)sizeof(stInfo), &stInfo) > 0 &&
+					PTRACE_SYSCALL_INFO_ENTRY == stInfo.op)
+			{
+				lNr = (long)stInfo.entry.nr;
+				if(SYS_getppid == lNr)
+				{
+					bCounting = !bCounting;
+				}
+				else if(true == bCounting && lNr >= 0 && lNr < BENCH_MAX_SYSCALL)
+				{
+					++alCount[lNr];
+				}
+			}
+		}
+		else if(0 == (iStatus >> 16) && SIGSTOP != WSTOPSIG(iStatus))
+		{
+			// signal is delivered; SIGSTOP of threads attached on clone is not
+			iSig = WSTOPSIG(iStatus);
+		}
+		ptrace(PTRACE_SYSCALL, tid, NULL, (void *)(long)iSig);
+	}
+
+	for(lNr = 0; lNr < BENCH_MAX_SYSCALL; ++lNr)
+	{
+		lTotal += alCount[lNr];
+		if(NULL == getSyscallName(lNr))
+		{
+			lOther += alCount[lNr];
+		}
+	}
+	fprintf(stderr, "  syscalls: %.2f per transaction (", (double)lTotal / a_lRequests);
+	for(lNr = 0; lNr < BENCH_MAX_SYSCALL; ++lNr)
+	{
+		if(NULL != getSyscallName(lNr) && alCount[lNr] > 0)
+		{
+			fprintf(stderr, "%s %.2f, ", getSyscallName(lNr), (double)alCount[lNr] / a_lRequests);
+		}
+	}
+	fprintf(stderr, "other %.2f)\n", (double)lOther / a_lRequests);
+} // End of traceClient
+
+/**
+ * @fn static void runBench(int a_iDevices, int a_iWindow, long a_lRequests)
+ *
+ * @brief This function starts server process and measures latency and system calls
+ * of a client process each.
+ *
+ * @param a_iDevices  [in] int number of devices
+ * @param a_iWindow   [in] int requests in flight per device
+ * @param a_lRequests [in] long requests of latency run
+ *
+ */
+static void runBench(int a_iDevices, int a_iWindow, long a_lRequests)
+{
+	int aiListenFds[BENCH_MAX_DEVICES];
+	uint16_t au16Ports[BENCH_MAX_DEVICES];
+	pid_t pidServer, pidClient;
+	int iStatus;
+	int i;
+
+	for(i = 0; i < a_iDevices; ++i)
+	{
+		struct sockaddr_in stAddr = {0};
+		socklen_t addrLen = sizeof(stAddr);
+
+		stAddr.sin_family = AF_INET;
+		stAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		aiListenFds[i] = socket(AF_INET, SOCK_STREAM, 0);
+		if(aiListenFds[i] < 0 || bind(aiListenFds[i], (struct sockaddr *)&stAddr, sizeof(stAddr)) < 0 ||
+				listen(aiListenFds[i], 16) < 0 ||
+				getsockname(aiListenFds[i], (struct sockaddr *)&stAddr, &addrLen) < 0)
+		{
+			perror("server listen failed");
+			exit(1);
+		}
+		au16Ports[i] = ntohs(stAddr.sin_port);
+	}
+	pidServer = fork();
+	if(0 == pidServer)
+	{
+		runServer(aiListenFds, a_iDevices);
+	}
+	for(i = 0; i < a_iDevices; ++i)
+	{
+		close(aiListenFds[i]);
+	}
+
+	fprintf(stderr, "devices=%d in flight/device=%d requests=%ld (traced %ld)\n",
+			a_iDevices, a_iWindow, a_lRequests, a_lRequests / BENCH_TRACE_DIVISOR);
+	pidClient = fork();
+	if(0 == pidClient)
+	{
+		runClient(au16Ports, a_iDevices, a_iWindow, a_lRequests, false);
+	}
+	waitpid(pidClient, &iStatus, 0);
+
+	pidClient = fork();
+	if(0 == pidClient)
+	{
+		runClient(au16Ports, a_iDevices, a_iWindow, a_lRequests / BENCH_TRACE_DIVISOR, true);
+	}
+	traceClient(pidClient, a_lRequests / BENCH_TRACE_DIVISOR);
+
+	kill(pidServer, SIGKILL);
+	waitpid(pidServer, &iStatus, 0);
+} // End of runBench
+
+int main(int argc, char **argv)
+{
+	int iDevices = (argc > 1) ? atoi(argv[1]) : 0;
+	int iWindow = (argc > 2) ? atoi(argv[2]) : 1;
+	long lRequests = (argc > 3) ? atol(argv[3]) : 100000;
+
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+	fprintf(stderr, "event loops: io_uring\n");
+#else
+	fprintf(stderr, "event loops: epoll\n");
+#endif
+	if(0 == iDevices)
+	{
+		runBench(1, 1, lRequests);
+		runBench(4, 16, lRequests);
+		return 0;
+	}
+	if(iDevices > BENCH_MAX_DEVICES || iWindow < 1 || iWindow * iDevices > 60000 ||
+			lRequests < BENCH_TRACE_DIVISOR)
+	{
+		fprintf(stderr, "Usage: %s [devices 1-%d] [in flight per device] [requests]\n",
+				argv[0], BENCH_MAX_DEVICES);
+		return 1;
+	}
+	runBench(iDevices, iWindow, lRequests);
+	return 0;
+}
@@ -0,0 +1,266 @@
+/************************************************************************************
+// Copyright (c) 2021 SS USA Inc.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+************************************************************************************/
+
+/*
+ * Benchmark of sending an ADU from request node. The transmit path before the change
+ * filled a 260 byte stack buffer with memset(), copied the ADU of the node into it with
+ * memcpy_s() and sent the copy; now the ADU is sent from m_stMbusTxData of the node.
+ * Both are measured on a pool of MAX_REQUESTS nodes used round robin, once without
+ * the system call and once with send() on a loopback TCP connection.
+ *
+ * Usage: bench_txcopy [requests without send(), a quarter of it is sent]
+ */
+
+/*
+ ===============================================================================
+ Includes :
+ ===============================================================================
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "StackConfig.h"
+#include "safe_lib.h"
+
+/*
+ ===============================================================================
+ Macro Definitions
+ ===============================================================================
+ */
+
+// ADU lengths measured: read holding registers request and largest TCP ADU
+#define BENCH_SHORT_ADU 12
+#define BENCH_LONG_ADU TCP_MODBUS_ADU_LENGTH
+// Each mode is measured this many times
+#define BENCH_REPETITIONS 5
+
+/*
+ ===============================================================================
+ Global Variables
+ ===============================================================================
+ */
+
+// Consumes frames so that copies are not optimized away
+static volatile uint32_t g_u32Sink;
+
+/*
+ ===============================================================================
+ Function Definitions
+ ===============================================================================
+ */
+
+/**
+ * @fn static double getNowSec(void)
+ *
+ * @brief This function returns CLOCK_MONOTONIC time in s.
+ *
+ * @return [out] double time in s
+ *
+ */
+static double getNowSec(void)
+{
+	struct timespec stTs;
+	clock_gettime(CLOCK_MONOTONIC, &stTs);
+	return stTs.tv_sec + stTs.tv_nsec / 1e9;
+} // End of getNowSec
+
+/**
+ * @fn static void __attribute__((noinline)) consumeFrame(const uint8_t *a_pu8Frame, uint16_t a_u16Length)
+ *
+ * @brief This function stands in for send() when system call is not measured.
+ *
+ * @param a_pu8Frame  [in] const uint8_t* frame to send
+ * @param a_u16Length [in] uint16_t frame length
+ *
+ */
+static void __attribute__((noinline)) consumeFrame(const uint8_t *a_pu8Frame, uint16_t a_u16Length)
+{
+	g_u32Sink += a_pu8Frame[0] + a_pu8Frame[a_u16Length - 1];
+} // End of consumeFrame
+
+/**
+ * @fn static bool openLoopback(int *a_piSendFd, int *a_piRecvFd)
+ *
+ * @brief This function connects a TCP socket pair on loopback interface.
+ *
+ * @param a_piSendFd [out] int* socket requests are sent on
+ * @param a_piRecvFd [out] int* socket requests are received on
+ *
+ * @return [out] bool true on success
+ *
+ */
+static bool openLoopback(int *a_piSendFd, int *a_piRecvFd)
+{
+	struct sockaddr_in stAddr = {0};
+	socklen_t addrLen = sizeof(stAddr);
+	int iListenFd = socket(AF_INET, SOCK_STREAM, 0);
+	int iOn = 1;
+
+	stAddr.sin_family = AF_INET;
+	stAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if(iListenFd < 0 || bind(iListenFd, (struct sockaddr *)&stAddr, sizeof(stAddr)) < 0 ||
+			listen(iListenFd, 1) < 0 ||
+			getsockname(iListenFd, (struct sockaddr *)&stAddr, &addrLen) < 0)
+	{
+		perror("loopback listen failed");
+		return false;
+	}
+	*a_piSendFd = socket(AF_INET, SOCK_STREAM, 0);
+	if(*a_piSendFd < 0 || connect(*a_piSendFd, (struct sockaddr *)&stAddr, sizeof(stAddr)) < 0)
+	{
+		perror("loopback connect failed");
+		return false;
+	}
+	*a_piRecvFd = accept(iListenFd, NULL, NULL);
+	close(iListenFd);
+	setsockopt(*a_piSendFd, IPPROTO_TCP, TCP_NODELAY, &iOn, sizeof(iOn));
+	return *a_piRecvFd >= 0;
+} // End of openLoopback
+
+/**
+ * @fn static void* drainThread(void *a_pvArg)
+ *
+ * @brief This function is thread routine reading everything sent on loopback connection.
+ *
+ * @param a_pvArg [in] void* pointer to receiving socket
+ *
+ * @return [out] void* NULL
+ *
+ */
+static void* drainThread(void *a_pvArg)
+{
+	uint8_t au8Buf[65536];
+	int iFd = *(int *)a_pvArg;
+
+	while(read(iFd, au8Buf, sizeof(au8Buf)) > 0)
+	{
+	}
+	return NULL;
+} // End of drainThread
+
+/**
+ * @fn static double runBench(stMbusPacketVariables_t *a_pstPool, long a_lCount,
+ * 							bool a_bCopy, int a_iSockFd)
+ *
+ * @brief This function sends requests of pool round robin and returns time per request.
+ *
+ * @param a_pstPool  [in] stMbusPacketVariables_t* pool of MAX_REQUESTS nodes
+ * @param a_lCount 	 [in] long number of requests
+ * @param a_bCopy 	 [in] bool true to send from copy in stack buffer as before
+ * @param a_iSockFd  [in] int socket to send on; -1 not to call send()
+ *
+ * @return [out] double ns per request
+ *
+ */
+static double runBench(stMbusPacketVariables_t *a_pstPool, long a_lCount, bool a_bCopy, int a_iSockFd)
+{
+	double dStart = getNowSec();
+	long lReq;
+
+	for(lReq = 0; lReq < a_lCount; ++lReq)
+	{
+		stMbusPacketVariables_t *pstMBusRequesPacket = &a_pstPool[lReq % MAX_REQUESTS];
+		const uint8_t *pu8Frame = pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields;
+		uint8_t recvBuff[260];
+
+		if(true == a_bCopy)
+		{
+			memset(recvBuff, '0',sizeof(recvBuff));
+			memcpy_s(recvBuff,sizeof(pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields),
+					pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields,
+					pstMBusRequesPacket->m_stMbusTxData.m_u16Length);
+			pu8Frame = recvBuff;
+		}
+		if(a_iSockFd < 0)
+		{
+			consumeFrame(pu8Frame, pstMBusRequesPacket->m_stMbusTxData.m_u16Length);
+		}
+		else if(send(a_iSockFd, pu8Frame, pstMBusRequesPacket->m_stMbusTxData.m_u16Length,
+				MSG_NOSIGNAL) < 0)
+		{
+			perror("send failed");
+			break;
+		}
+	}
+	return (getNowSec() - dStart) * 1e9 / a_lCount;
+} // End of runBench
+
+int main(int argc, char **argv)
+{
+	static const uint16_t au16Lengths[] = {BENCH_SHORT_ADU, BENCH_LONG_ADU};
+	long lCount = (argc > 1) ? atol(argv[1]) : 2000000;
+	stMbusPacketVariables_t *pstPool = calloc(MAX_REQUESTS, sizeof(stMbusPacketVariables_t));
+	pthread_t tidDrain;
+	int iSendFd = -1;
+	int iRecvFd = -1;
+	size_t i;
+	int iNode;
+	int iRep;
+
+	if(NULL == pstPool || lCount < 1 || false == openLoopback(&iSendFd, &iRecvFd))
+	{
+		printf("Usage: %s [requests]\n", argv[0]);
+		return 1;
+	}
+	setvbuf(stdout, NULL, _IOLBF, 0);
+	pthread_create(&tidDrain, NULL, drainThread, &iRecvFd);
+	for(i = 0; i < sizeof(au16Lengths) / sizeof(au16Lengths[0]); ++i)
+	{
+		double dCopy, dDirect, dCopySend, dDirectSend;
+
+		for(iNode = 0; iNode < MAX_REQUESTS; ++iNode)
+		{
+			memset(pstPool[iNode].m_stMbusTxData.m_au8DataFields, iNode, au16Lengths[i]);
+			pstPool[iNode].m_stMbusTxData.m_u16Length = au16Lengths[i];
+		}
+		// warm up connection and caches
+		runBench(pstPool, lCount / 10, true, iSendFd);
+		dCopy = dDirect = dCopySend = dDirectSend = 1e9;
+		// modes are alternated and best of repetitions is kept, so that
+		// scheduling noise of send() does not hide the difference
+		for(iRep = 0; iRep < BENCH_REPETITIONS; ++iRep)
+		{
+			dCopy = fmin(dCopy, runBench(pstPool, lCount, true, -1));
+			dDirect = fmin(dDirect, runBench(pstPool, lCount, false, -1));
+			dCopySend = fmin(dCopySend, runBench(pstPool, lCount / 4, true, iSendFd));
+			dDirectSend = fmin(dDirectSend, runBench(pstPool, lCount / 4, false, iSendFd));
+		}
+		printf("adu=%-3u no send: copy=%7.2f direct=%7.2f saved=%6.2f ns/req | "
+				"send: copy=%8.2f direct=%8.2f saved=%6.2f ns/req\n",
+				au16Lengths[i], dCopy, dDirect, dCopy - dDirect,
+				dCopySend, dDirectSend, dCopySend - dDirectSend);
+	}
+	shutdown(iSendFd, SHUT_WR);
+	pthread_join(tidDrain, NULL);
+	close(iSendFd);
+	close(iRecvFd);
+	free(pstPool);
+	return 0;
+}
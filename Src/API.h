@@ -261,6 +261,106 @@ typedef struct DevConfig
 	long 			m_lResponseTimeout;   // response timeout
 }stDevConfig_t;
 
+/**
+ @enum eReqPoolPolicy
+ @brief
+    This enumerator defines how request pool grows and shrinks
+*/
+typedef enum
+{
+	eReqPoolFixed,			// complete pool is committed at init and never changes
+	eReqPoolGrow,			// pool grows in chunks up to maximum size on demand
+	eReqPoolGrowAndTrim		// pool grows on demand and is trimmed to initial size when idle
+}eReqPoolPolicy;
+
+/**
+ @enum eReqAdmissionMode
+ @brief
+    This enumerator defines what a request API does when no request node is available.
+    Blocking modes must not be used to send requests from a response callback, since
+    nodes are freed only after the callback returns.
+*/
+typedef enum
+{
+	eReqAdmitFailFast,		// return STS_MBUS_STACK_ERROR_MAX_REQ_SENT immediately
+	eReqAdmitBlock,			// wait until a request node is freed
+	eReqAdmitTimedWait		// wait up to admission timeout for a request node
+}eReqAdmissionMode;
+
+/**
+ @enum eReactorAssignPolicy
+ @brief
+    This enum defines how devices are assigned to event loops in TCP mode. Event loop
+    threads send requests of their devices on non-blocking sockets, receive and match
+    responses and expire timed out requests; no thread is created per device.
+    Device is assigned when its context is created.
+*/
+typedef enum
+{
+	eReactorLeastLoaded,	// event loop serving fewest devices
+	eReactorHash			// event loop found from hash of IP address and port
+}eReactorAssignPolicy;
+
+/**
+ @struct StackInitConfig
+ @brief
+    This structure defines parameters used while initializing the stack.
+    Zero value of a size selects its default.
+*/
+typedef struct StackInitConfig
+{
+	uint32_t 		m_u32ReqPoolInitSize;	// request nodes committed at init
+	uint32_t 		m_u32ReqPoolMaxSize;	// maximum requests in flight
+	uint32_t 		m_u32ReqPoolChunkSize;	// request nodes committed in one growth step
+	eReqPoolPolicy 	m_eReqPoolPolicy;		// growth policy of request pool
+	eReqAdmissionMode m_eAdmissionMode;		// behaviour when request pool or context quota is used up
+	long 			m_lAdmissionTimeout;	// maximum wait in ms for eReqAdmitTimedWait
+	uint32_t 		m_u32RespDispatchers;	// threads decoding responses and calling back ModbusApp
+	uint32_t 		m_u32Reactors;			// event loop threads of TCP mode
+	eReactorAssignPolicy m_eReactorAssign;	// assignment of devices to event loops
+	bool 			m_bReactorCpuAffinity;	// pin each event loop thread to a CPU
+}stStackInitConfig_t;
+
+/**
+ @struct MbusStackStats
+ @brief
+    This structure defines live occupancy of request pool and queues of stack.
+    Counts are sampled without stopping the stack, so they are approximate
+    while requests are in progress.
+*/
+typedef struct MbusStackStats
+{
+	uint32_t m_u32PoolMaxSize;				// maximum request nodes
+	uint32_t m_u32PoolCommitted;			// request nodes with memory committed
+	uint32_t m_u32PoolInUse;				// request nodes held by requests
+	// request nodes by transaction state
+	uint32_t m_u32ReqRcvdFromApp;			// queued, not yet sent
+	uint32_t m_u32ReqProcessError;			// failed before send
+	uint32_t m_u32ReqSentOnNetwork;			// sent, waiting for response
+	uint32_t m_u32RespRcvdFromNetwork;		// response received, not yet sent to app
+	uint32_t m_u32RespTimedOut;				// timed out, not yet sent to app
+	uint32_t m_u32RespError;				// failed, not yet sent to app
+	uint32_t m_u32RespSentToApp;			// callback in progress
+	uint32_t m_u32Reserved;					// being allocated
+	uint32_t m_u32Idle;						// free
+	uint32_t m_u32RespQueueDepth;			// responses waiting for callback
+	uint32_t m_u32TimeoutTracked;			// requests in timeout tracker
+	uint32_t m_u32CtxCount;					// contexts created
+	uint64_t m_u64StaleResp;				// responses dropped as stale
+}stMbusStackStats_t;
+
+/**
+ @struct MbusCtxStats
+ @brief
+    This structure defines live occupancy of one context
+*/
+typedef struct MbusCtxStats
+{
+	int32_t m_i32Ctx;						// context
+	uint32_t m_u32QueueDepth;				// requests waiting in context queue
+	uint32_t m_u32InFlight;					// request nodes held by context
+}stMbusCtxStats_t;
+
 typedef struct TimeStamps
 {
 	struct timespec tsReqRcvd;          // Timestamp for Request recieved
@@ -269,8 +369,8 @@ typedef struct TimeStamps
 	struct timespec tsRespSent;         // Timestamp for request sent
 }stTimeStamps;
 
-// Modbus master stack initialization function
-MODBUS_STACK_EXPORT t_Status AppMbusMaster_StackInit();
+// Modbus master stack initialization function, pstConfig can be NULL for default configuration
+MODBUS_STACK_EXPORT t_Status AppMbusMaster_StackInit(stStackInitConfig_t *pstConfig);
 
 // Modbus master stack de-initialization function
 MODBUS_STACK_EXPORT void AppMbusMaster_StackDeInit(void);
@@ -281,6 +381,11 @@ MODBUS_STACK_EXPORT t_Status AppMbusMaster_SetStackConfigParam(stDevConfig_t *ps
 // Modbus master stack configuration function
 MODBUS_STACK_EXPORT stDevConfig_t* AppMbusMaster_GetStackConfigParam();
 
+// Modbus master stack occupancy statistics, pstCtxStats can be NULL
+MODBUS_STACK_EXPORT t_Status AppMbusMaster_GetStackStats(stMbusStackStats_t *pstStats,
+		stMbusCtxStats_t *pstCtxStats,
+		uint32_t u32MaxCtx);
+
 // Read coil API
 MODBUS_STACK_EXPORT t_Status Modbus_Read_Coils(uint16_t u16StartCoil,
 											  uint16_t u16NumOfcoils,
@@ -399,6 +504,34 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Device_Identification(uint8_t u8MEIType
 		int32_t i32Ctx,
 		void* pFunCallBack);
 
+/**
+ @struct MbusBatchReq
+ @brief
+    This structure defines one request submitted with Modbus_Submit_Batch().
+    Supported function codes are READ_COIL_STATUS, READ_INPUT_STATUS, READ_HOLDING_REG,
+    READ_INPUT_REG, WRITE_SINGLE_COIL, WRITE_SINGLE_REG, WRITE_MULTIPLE_COILS and
+    WRITE_MULTIPLE_REG.
+*/
+typedef struct MbusBatchReq
+{
+	uint8_t 	m_u8FunctionCode;	// Modbus function code of request
+	uint16_t 	m_u16StartAddr;		// start coil or register
+	uint16_t 	m_u16Quantity;		// number of coils or registers; value to write for single writes
+	uint8_t 	*m_pu8Data;			// values to write for multiple writes, not used otherwise
+	uint16_t 	m_u16TransacID;		// ID of the request given back in callback
+	uint8_t 	m_u8UnitId;			// Modbus slave device ID
+	long 		m_lPriority;		// priority of request, lower the number higher the priority
+	int32_t 	m_i32Ctx;			// TCP/RTU context
+	void* 		m_pFunCallBack;		// callback for response of request
+	long 		m_lRespTimeout;		// response timeout in ms (TCP), 0 selects timeout of context
+	t_Status 	m_eStatus;			// [out] status of submission of this request
+}stMbusBatchReq_t;
+
+// Submit multiple requests in one call
+MODBUS_STACK_EXPORT t_Status Modbus_Submit_Batch(stMbusBatchReq_t *pstReqs,
+		uint32_t u32Count,
+		uint32_t *pu32Submitted);
+
 // struct for Modbus_AppllicationCallbackHandler
 typedef struct _stMbusAppCallbackParams
 {
@@ -449,6 +582,8 @@ typedef struct CtxInfo
 #else
 	uint8_t *pu8SerIpAddr;      // TCPIP- IP Address
 	uint16_t u16Port;			// TCPIP - port name
+	long	m_lRespTimeout;     // response timeout of the device in ms, 0 selects stack response timeout
+	uint16_t m_u16MaxInFlight;	// maximum requests in flight on the device, 0 for no limit
 #endif
 }stCtxInfo;
 
@@ -135,34 +135,35 @@ int checkforblockingread(int fd, long a_lRespTimeout);
  ===============================================================================
  */
 
-// Function declarations for callback functions from ModbusApp
-void (*ModbusMaster_ApplicationCallback)(stMbusAppCallbackParams_t *pstMbusAppCallbackParams,
+// Types of callback functions from ModbusApp. Callbacks are taken from each request,
+// in local variables, since responses can be dispatched by several threads at once
+typedef void (*ModbusMaster_ApplicationCallback_t)(stMbusAppCallbackParams_t *pstMbusAppCallbackParams,
 																	uint16_t u16TransactionID);
 
 // Functions that are used in Modbus TCP communication mode
 #ifdef MODBUS_STACK_TCPIP_ENABLED
-void (*ReadFileRecord_CallbackFunction)(uint8_t, uint8_t*,uint16_t, uint16_t,uint8_t,
+typedef void (*ReadFileRecord_CallbackFunction_t)(uint8_t, uint8_t*,uint16_t, uint16_t,uint8_t,
 		stException_t *,
 		stMbusRdFileRecdResp_t*);
 
-void (*WriteFileRecord_CallbackFunction)(uint8_t, uint8_t*, uint16_t, uint16_t,uint8_t,
+typedef void (*WriteFileRecord_CallbackFunction_t)(uint8_t, uint8_t*, uint16_t, uint16_t,uint8_t,
 		stException_t*,
 		stMbusWrFileRecdResp_t*);
 
-void (*ReadDeviceIdentification_CallbackFunction)(uint8_t, uint8_t*, uint16_t, uint16_t,uint8_t,
+typedef void (*ReadDeviceIdentification_CallbackFunction_t)(uint8_t, uint8_t*, uint16_t, uint16_t,uint8_t,
 		stException_t*,
 		stRdDevIdResp_t*);
 #else
 //Functions that are used in Modbus RTU communication mode
-void (*ReadFileRecord_CallbackFunction)(uint8_t, uint8_t*, uint16_t,uint8_t,
+typedef void (*ReadFileRecord_CallbackFunction_t)(uint8_t, uint8_t*, uint16_t,uint8_t,
 		stException_t *,
 		stMbusRdFileRecdResp_t*);
 
-void (*WriteFileRecord_CallbackFunction)(uint8_t, uint8_t*, uint16_t,uint8_t,
+typedef void (*WriteFileRecord_CallbackFunction_t)(uint8_t, uint8_t*, uint16_t,uint8_t,
 		stException_t*,
 		stMbusWrFileRecdResp_t*);
 
-void (*ReadDeviceIdentification_CallbackFunction)(uint8_t, uint8_t*, uint16_t,uint8_t,
+typedef void (*ReadDeviceIdentification_CallbackFunction_t)(uint8_t, uint8_t*, uint16_t,uint8_t,
 		stException_t*,
 		stRdDevIdResp_t*);
 #endif
@@ -278,6 +279,7 @@ int sleep_micros(long lMicroseconds)
 void ApplicationCallBackHandler(stMbusPacketVariables_t *pstMBusRequesPacket,t_Status eMbusStackErr)
 {
 	stException_t  stException = {0};
+	ModbusMaster_ApplicationCallback_t ModbusMaster_ApplicationCallback = NULL;
 
 	if(NULL == pstMBusRequesPacket)
 		return;
@@ -330,7 +332,7 @@ void ApplicationCallBackHandler(stMbusPacketVariables_t *pstMBusRequesPacket,t_S
 
 			stMbusAppCallbackParams.m_u16TransactionID = pstMBusRequesPacket->m_u16AppTxID;
 #ifdef MODBUS_STACK_TCPIP_ENABLED
-			stMbusAppCallbackParams.m_u8UnitID = pstMBusRequesPacket->m_u8UnitID;
+			stMbusAppCallbackParams.m_u8UnitID = REQ_HOT_META(pstMBusRequesPacket)->m_u8UnitID;
 
 			memcpy_s((void*)&stMbusAppCallbackParams.m_u8IpAddr,
 					(rsize_t) sizeof(stMbusAppCallbackParams.m_u8IpAddr),
@@ -356,7 +358,7 @@ void ApplicationCallBackHandler(stMbusPacketVariables_t *pstMBusRequesPacket,t_S
 			stMbusAppCallbackParams.m_u16Quantity = pstMBusRequesPacket->m_u16Quantity;
 			stMbusAppCallbackParams.m_objTimeStamps = pstMBusRequesPacket->m_objTimeStamps;
 			// send to the master application
-			ModbusMaster_ApplicationCallback(&stMbusAppCallbackParams, pstMBusRequesPacket->m_u16TransactionID);
+			ModbusMaster_ApplicationCallback(&stMbusAppCallbackParams, REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID);
 		}
 		break;
 
@@ -369,23 +371,23 @@ void ApplicationCallBackHandler(stMbusPacketVariables_t *pstMBusRequesPacket,t_S
 		pstMbusRdFileRecdResp =
 				pstMBusRequesPacket->m_stMbusRxData.m_pvAdditionalData;
 
-		ReadFileRecord_CallbackFunction = pstMBusRequesPacket->pFunc;
+		ReadFileRecord_CallbackFunction_t ReadFileRecord_CallbackFunction = pstMBusRequesPacket->pFunc;
 #ifdef MODBUS_STACK_TCPIP_ENABLED
 
 		if(NULL != ReadFileRecord_CallbackFunction)
-			ReadFileRecord_CallbackFunction(pstMBusRequesPacket->m_u8UnitID,
+			ReadFileRecord_CallbackFunction(REQ_HOT_META(pstMBusRequesPacket)->m_u8UnitID,
 					pstMBusRequesPacket->m_u8IpAddr,
 					pstMBusRequesPacket->u16Port,
-					pstMBusRequesPacket->m_u16TransactionID,
+					REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 					pstMBusRequesPacket->m_u8FunctionCode,
 					&stException,pstMbusRdFileRecdResp);
 
 
 #else
 		if(NULL != ReadFileRecord_CallbackFunction)
-			ReadFileRecord_CallbackFunction(pstMBusRequesPacket->m_u8UnitID,
+			ReadFileRecord_CallbackFunction(REQ_HOT_META(pstMBusRequesPacket)->m_u8UnitID,
 					&pstMBusRequesPacket->m_u8ReceivedDestination,
-					pstMBusRequesPacket->m_u16TransactionID,
+					REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 					pstMBusRequesPacket->m_u8FunctionCode,
 					&stException,pstMbusRdFileRecdResp);
 #endif
@@ -416,24 +418,24 @@ void ApplicationCallBackHandler(stMbusPacketVariables_t *pstMBusRequesPacket,t_S
 
 		pstMbusWrFileRecdResp = pstMBusRequesPacket->m_stMbusRxData.m_pvAdditionalData;
 
-		WriteFileRecord_CallbackFunction = pstMBusRequesPacket->pFunc;
+		WriteFileRecord_CallbackFunction_t WriteFileRecord_CallbackFunction = pstMBusRequesPacket->pFunc;
 
 #ifdef MODBUS_STACK_TCPIP_ENABLED
 		// callback function to application when write record is received
 		if(NULL != WriteFileRecord_CallbackFunction)
-			WriteFileRecord_CallbackFunction(pstMBusRequesPacket->m_u8UnitID,
+			WriteFileRecord_CallbackFunction(REQ_HOT_META(pstMBusRequesPacket)->m_u8UnitID,
 					pstMBusRequesPacket->m_u8IpAddr,
 					pstMBusRequesPacket->u16Port,
-					pstMBusRequesPacket->m_u16TransactionID,
+					REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 					pstMBusRequesPacket->m_u8FunctionCode,
 					&stException,pstMbusWrFileRecdResp);
 
 #else
 		if(NULL != WriteFileRecord_CallbackFunction)
 			// callback function to application when write record is received
-			WriteFileRecord_CallbackFunction(pstMBusRequesPacket->m_u8UnitID,
+			WriteFileRecord_CallbackFunction(REQ_HOT_META(pstMBusRequesPacket)->m_u8UnitID,
 					&pstMBusRequesPacket->m_u8ReceivedDestination,
-					pstMBusRequesPacket->m_u16TransactionID,
+					REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 					pstMBusRequesPacket->m_u8FunctionCode,
 					&stException,pstMbusWrFileRecdResp);
 
@@ -465,24 +467,24 @@ void ApplicationCallBackHandler(stMbusPacketVariables_t *pstMBusRequesPacket,t_S
 
 		pstMbusRdDevIdResp = pstMBusRequesPacket->m_stMbusRxData.m_pvAdditionalData;
 
-		ReadDeviceIdentification_CallbackFunction = pstMBusRequesPacket->pFunc;
+		ReadDeviceIdentification_CallbackFunction_t ReadDeviceIdentification_CallbackFunction = pstMBusRequesPacket->pFunc;
 
 #ifdef MODBUS_STACK_TCPIP_ENABLED
 		// callback function to application to read device identification
 		if(NULL != ReadDeviceIdentification_CallbackFunction)
-			ReadDeviceIdentification_CallbackFunction(pstMBusRequesPacket->m_u8UnitID,
+			ReadDeviceIdentification_CallbackFunction(REQ_HOT_META(pstMBusRequesPacket)->m_u8UnitID,
 					pstMBusRequesPacket->m_u8IpAddr,
 					pstMBusRequesPacket->u16Port,
-					pstMBusRequesPacket->m_u16TransactionID,
+					REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 					pstMBusRequesPacket->m_u8FunctionCode,
 					&stException,pstMbusRdDevIdResp);
 
 #else
 		// callback function to application to read device identification
 		if(NULL != ReadDeviceIdentification_CallbackFunction)
-			ReadDeviceIdentification_CallbackFunction(pstMBusRequesPacket->m_u8UnitID,
+			ReadDeviceIdentification_CallbackFunction(REQ_HOT_META(pstMBusRequesPacket)->m_u8UnitID,
 					&pstMBusRequesPacket->m_u8ReceivedDestination,
-					pstMBusRequesPacket->m_u16TransactionID,
+					REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 					pstMBusRequesPacket->m_u8FunctionCode,
 					&stException,pstMbusRdDevIdResp);
 #endif
@@ -926,8 +928,8 @@ t_Status DecodeRxPacket(uint8_t *ServerReplyBuff,stMbusPacketVariables_t *pstMBu
 	//timespec_get(&(pstMBusRequesPacket->m_objTimeStamps.tsRespRcvd), TIME_UTC);
 
 #ifdef MODBUS_STACK_TCPIP_ENABLED
-	if((pstMBusRequesPacket->m_u16TransactionID != u16TransactionID) ||
-			(pstMBusRequesPacket->m_u8UnitID != u8UnitID) ||
+	if((REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID != u16TransactionID) ||
+			(REQ_HOT_META(pstMBusRequesPacket)->m_u8UnitID != u8UnitID) ||
 			(pstMBusRequesPacket->m_u8FunctionCode != (u8FunctionCode & 0x7F)))
 #else
 		if((pstMBusRequesPacket->m_u8ReceivedDestination != u8UnitID)
@@ -1018,7 +1020,7 @@ t_Status Modbus_SendPacket(stMbusPacketVariables_t *pstMBusRequesPacket,
 		long a_lRespTimeout)
 {
 	t_Status u8ReturnType =  STS_MBUS_STACK_NO_ERROR;
-	uint8_t recvBuff[TCP_MODBUS_ADU_LENGTH];
+	MbusTXData_t *pstTxData = NULL;
 	volatile int bytes = 0;
 	uint16_t crc;
 	uint8_t ServerReplyBuff[TCP_MODBUS_ADU_LENGTH] = {0};
@@ -1037,22 +1039,27 @@ t_Status Modbus_SendPacket(stMbusPacketVariables_t *pstMBusRequesPacket,
 		return u8ReturnType;
 	}
 
-	memset(recvBuff, '0',sizeof(recvBuff));
-	memcpy_s(recvBuff,sizeof(pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields),
-			pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields,
-			pstMBusRequesPacket->m_stMbusTxData.m_u16Length);
+	// ADU is sent directly from request node. CRC is appended in place
+	// after the encoded frame; RTU frame including CRC is at most 256 bytes.
+	pstTxData = &pstMBusRequesPacket->m_stMbusTxData;
+	if((pstTxData->m_u16Length + 2) > TCP_MODBUS_ADU_LENGTH)
 	{
-		crc = crc16(recvBuff,pstMBusRequesPacket->m_stMbusTxData.m_u16Length);
+		u8ReturnType =  STS_MBUS_STACK_ERROR_SEND_FAILED;
+		pstMBusRequesPacket->m_u8CommandStatus = u8ReturnType;
+		return u8ReturnType;
+	}
+	{
+		crc = crc16(pstTxData->m_au8DataFields, pstTxData->m_u16Length);
 
-		recvBuff[pstMBusRequesPacket->m_stMbusTxData.m_u16Length++] = (crc & 0xFF00) >> 8;
-		recvBuff[pstMBusRequesPacket->m_stMbusTxData.m_u16Length++] = (crc & 0x00FF);
+		pstTxData->m_au8DataFields[pstTxData->m_u16Length++] = (crc & 0xFF00) >> 8;
+		pstTxData->m_au8DataFields[pstTxData->m_u16Length++] = (crc & 0x00FF);
 
 		tcflush(rtuConnectionData.m_fd, TCIOFLUSH);
 
 		// Multiple Slave issue: Adding Frame delay between two packets 
 		sleep_micros(a_lInterframeDelay + rtuConnectionData.m_interframeDelay);
 
-		bytes = write(rtuConnectionData.m_fd,recvBuff,(pstMBusRequesPacket->m_stMbusTxData.m_u16Length));
+		bytes = write(rtuConnectionData.m_fd, pstTxData->m_au8DataFields, pstTxData->m_u16Length);
 		if(bytes <= 0)
 		{
 			u8ReturnType =  STS_MBUS_STACK_ERROR_SEND_FAILED;
@@ -1152,7 +1159,7 @@ t_Status Modbus_SendPacket(stMbusPacketVariables_t *pstMBusRequesPacket,
 			memcpy_s(pstMBusRequesPacket->m_u8RawResp, sizeof(pstMBusRequesPacket->m_u8RawResp),
 					ServerReplyBuff, sizeof(ServerReplyBuff));
 
-			pstMBusRequesPacket->m_state = RESP_RCVD_FROM_NETWORK;
+			REQ_HOT_META(pstMBusRequesPacket)->m_state = RESP_RCVD_FROM_NETWORK;
 			addToRespQ(pstMBusRequesPacket);
 			//u8ReturnType = DecodeRxPacket(ServerReplyBuff,pstMBusRequesPacket);
 		}
@@ -1161,12 +1168,12 @@ t_Status Modbus_SendPacket(stMbusPacketVariables_t *pstMBusRequesPacket,
 			// If blocking result = 0, it means timeout has occurred
 			if (0 == iBlockingReadResult)
 			{
-				pstMBusRequesPacket->m_state = RESP_TIMEDOUT;
+				REQ_HOT_META(pstMBusRequesPacket)->m_state = RESP_TIMEDOUT;
 				u8ReturnType = STS_MBUS_STACK_ERROR_RECV_TIMEOUT;
 			}
 			else
 			{
-				pstMBusRequesPacket->m_state = RESP_ERROR;
+				REQ_HOT_META(pstMBusRequesPacket)->m_state = RESP_ERROR;
 				u8ReturnType = STS_MBUS_STACK_ERROR_RECV_FAILED;
 			}
 		}
@@ -1508,252 +1515,69 @@ void closeConnection(IP_Connect_t *a_pstIPConnect)
 		// Close socket
 		close(a_pstIPConnect->m_sockfd);
 		a_pstIPConnect->m_sockfd = 0;
-		a_pstIPConnect->m_retryCount = 0;
 		a_pstIPConnect->m_lastConnectStatus = SOCK_CONNECT_FAILED;
 		a_pstIPConnect->m_bIsAddedToEPoll = false;
-		a_pstIPConnect->m_iRcvConRef = -1;
-	}
-}
-
-/**
- * @fn void Mark_Sock_Fail(IP_Connect_t *a_pstIPConnect)
- *
- * @brief This function sets the specified socket's failure state. The function removes the
- * socket descriptor entry from the epoll file descriptors (which was registered for
- * notification of events on it). The function then closes the socket connection and
- * resets the socket structure.
- *
- * @param a_pstIPConnect [in] IP_Connect_t* pointer to struct of socket to mark as fail
- *
- * @return 				 [out] none
- *
- */
-void Mark_Sock_Fail(IP_Connect_t *a_pstIPConnect)
-{
-	if(NULL != a_pstIPConnect)
-	{
-		removeEPollRef(a_pstIPConnect->m_iRcvConRef);
-		closeConnection(a_pstIPConnect);
 	}
 }
 
 /**
- * @fn uint8_t Modbus_SendPacket(stMbusPacketVariables_t *pstMBusRequesPacket, IP_Connect_t *a_pstIPConnect)
+ * @fn t_Status Modbus_StartConnect(IP_Connect_t *a_pstIPConnect)
  *
- * @brief This function sends request to Modbus slave device using TCP communication mode. It then fills
- * up the transaction data. It checks if socket already exists. If socket exists, it sends
- * the request on the socket to Modbus slave device.
- * If the socket does not exist, function creates a socket, tries to connect with the socket and
- * then sends the request on it.
- * Upon successfully sending the request to Modbus slave device, function captures the current
- * time as time stamp when request was sent on the Modbus slave device and adds it to the request structure.
- * Then it adds this request in request manager's list for further watch.
+ * @brief This function creates a non-blocking socket and starts connecting with Modbus
+ * slave device. It does not wait for connect to complete; socket becomes writable when
+ * it does. Socket is not registered with epoll.
  *
- * @param pstMBusRequesPacket 	[in] stMbusPacketVariables_t * pointer to structure containing
- * 								   	 request for Modbus slave device
- * @param a_pstIPConnect 		[in] IP_Connect_t* pointer to structure of socket descriptor to
- * 									 connect with Modbus slave device on which to send this request
+ * @param a_pstIPConnect [in] IP_Connect_t* pointer to structure with address of Modbus
+ * 									 slave device; socket descriptor and connect status are set
  *
- * @return uint8_t 			[out] 0 in case of success;
- * 								  MBUS_STACK_ERROR_SEND_FAILED if function fails to send the request
- * 								  to Modbus slave device
- * 								  MBUS_STACK_ERROR_SOCKET_FAILED if function fails to create a new socket
- * 								  to communicate with the Modbus slave device
- *								  MBUS_STACK_ERROR_CONNECT_FAILED in case if function fails to connect
- *								  with from socket descriptor
- *								  MBUS_STACK_ERROR_FAILED_Q_SENT_REQ if function fails to add sent request
- *								  in request manager's list
+ * @return t_Status [out] STS_MBUS_STACK_NO_ERROR if connect is in progress or done;
+ * 						  STS_MBUS_STACK_ERROR_SOCKET_FAILED if function fails to create a socket
+ * 						  STS_MBUS_STACK_ERROR_CONNECT_FAILED if connect fails
  *
  */
-t_Status Modbus_SendPacket(stMbusPacketVariables_t *pstMBusRequesPacket, IP_Connect_t *a_pstIPConnect)
+t_Status Modbus_StartConnect(IP_Connect_t *a_pstIPConnect)
 {
-	//local variables
 	int32_t sockfd = 0;
-	t_Status u8ReturnType =  STS_MBUS_STACK_NO_ERROR;
-	uint8_t recvBuff[260];
-	long arg;
-	int res = 0;
+	int iEnable = 1;
 
-	if(NULL == pstMBusRequesPacket || NULL == a_pstIPConnect)
+	if(NULL == a_pstIPConnect)
 	{
-		u8ReturnType =  STS_MBUS_STACK_ERROR_SEND_FAILED;
-		return u8ReturnType;
+		return STS_MBUS_STACK_ERROR_SOCKET_FAILED;
 	}
+	a_pstIPConnect->m_lastConnectStatus = SOCK_NOT_CONNECTED;
+	a_pstIPConnect->m_bIsAddedToEPoll = false;
 
-	memset(recvBuff, '0',sizeof(recvBuff));
-	memcpy_s(recvBuff,sizeof(pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields),
-			pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields,
-			pstMBusRequesPacket->m_stMbusTxData.m_u16Length);
-
-	// There are following cases to be handled:
-	// 1. Socket is not created. Here socket = 0
-	// 2. Socket is created and connection is in progress. Here connectionstatus = EINPROGRESS
-	// 3. Connection is established
-
-	do
+	if((sockfd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0)) < 0)
 	{
-		// Case 1: Socket is not created
-		if(0 == a_pstIPConnect->m_sockfd)
-		{
-			a_pstIPConnect->m_lastConnectStatus = SOCK_NOT_CONNECTED;
-			a_pstIPConnect->m_bIsAddedToEPoll = false;
-			a_pstIPConnect->m_retryCount = 0;
-			if((sockfd = socket(AF_INET, SOCK_STREAM, 0)) < 0)
-			{
-				u8ReturnType =  STS_MBUS_STACK_ERROR_SOCKET_FAILED;
-				printf("Socket creation failed !! error ::%d\n", errno);
-				break;
-			}
-
-			a_pstIPConnect->m_sockfd = sockfd;
-			{
-				int iEnable = 1;
-				if (setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &iEnable, sizeof(int)) < 0)
-				{
-					printf("setsockopt(TCP_NODELAY) failed ::%d\n", errno);
-				}
-
-				if (setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &iEnable, sizeof(int)) < 0)
-				{
-					printf("setsockopt(SO_REUSEADDR) failed ::%d\n", errno);
-				}
-			}
-		}
-		sockfd = a_pstIPConnect->m_sockfd;
-		if((SOCK_NOT_CONNECTED == a_pstIPConnect->m_lastConnectStatus) &&
-				(0 != a_pstIPConnect->m_sockfd))
-		{
-			a_pstIPConnect->m_retryCount = 0;
-
-			arg = fcntl(sockfd, F_GETFL, NULL);
-			arg |= O_NONBLOCK;
-			fcntl(sockfd, F_SETFL, arg);
-
-			res = connect(sockfd, (struct sockaddr *)&a_pstIPConnect->m_servAddr, sizeof(a_pstIPConnect->m_servAddr));
-
-			if (res < 0)
-			{
-				if (errno == EINPROGRESS)
-				{
-					a_pstIPConnect->m_lastConnectStatus = SOCK_CONNECT_INPROGRESS;
-					printf("\nConnection with Modbus Server is in progress ...\n");
-				}
-				else
-				{
-					u8ReturnType =  STS_MBUS_STACK_ERROR_CONNECT_FAILED;
-					// closing socket on error.
-					Mark_Sock_Fail(a_pstIPConnect);
-					printf("Connection with Modbus slave failed, so closing socket descriptor %d\n", sockfd);
-					break;
-				}
-			}
-			else if(res == 0)
-			{
-				a_pstIPConnect->m_lastConnectStatus = SOCK_CONNECT_SUCCESS;
-				printf("Modbus slave connection established on socket %d\n", sockfd);
-				//socket has been created and connected successfully, add it to epoll fd
-
-				int res = send(sockfd, recvBuff, (pstMBusRequesPacket->m_stMbusTxData.m_u16Length), MSG_NOSIGNAL);
-
-				if(res < 0)
-				//in order to avoid application stop whenever SIGPIPE gets generated,used send function with MSG_NOSIGNAL argument
-				{
-					printf("1. Closing socket %d as error occurred while sending data\n", sockfd);
-					u8ReturnType =  STS_MBUS_STACK_ERROR_SEND_FAILED;
-					Mark_Sock_Fail(a_pstIPConnect);
-					break;
-				}
-			}
-		}
-		if((SOCK_CONNECT_INPROGRESS == a_pstIPConnect->m_lastConnectStatus) &&
-				(0 != a_pstIPConnect->m_sockfd))
-		{
-
-			a_pstIPConnect->m_retryCount++;
-			if(a_pstIPConnect->m_retryCount > MAX_RETRY_COUNT)
-			{
-				printf("Connect status INPROGRESS. Max retries done %d\n", a_pstIPConnect->m_sockfd);
-				Mark_Sock_Fail(a_pstIPConnect);
-				//bReturnVal = false;
-				u8ReturnType =  STS_MBUS_STACK_ERROR_CONNECT_FAILED;
-				break;
-			}
-			struct timeval tv;
-			fd_set myset;
-			tv.tv_sec = 0;
-			tv.tv_usec = g_stModbusDevConfig.m_lResponseTimeout;
-			FD_ZERO(&myset);
-			FD_SET(sockfd, &myset);
-			int r1 = select(sockfd+1, NULL, &myset, NULL, &tv);
-			if (r1 > 0)
-			{
-				socklen_t lon = sizeof(int);
-				int valopt;
-				getsockopt(sockfd, SOL_SOCKET, SO_ERROR, (void*)(&valopt), &lon);
-				if (valopt)
-				{
-					printf("getsockopt failed : %d", valopt);
-					u8ReturnType =  STS_MBUS_STACK_ERROR_CONNECT_FAILED;
-					Mark_Sock_Fail(a_pstIPConnect);
-					break;
-				}
-				else
-				{
-					printf("getsockopt passed\n");
-				}
-			}
-			else if(r1 <= 0)
-			{
-				printf("select failed : %d", errno);
-				u8ReturnType =  STS_MBUS_STACK_ERROR_CONNECT_FAILED;
-				Mark_Sock_Fail(a_pstIPConnect);
-				break;
-			}
-		}
-
-		if((false == a_pstIPConnect->m_bIsAddedToEPoll) && (0 != a_pstIPConnect->m_sockfd)
-				&& (-1 != a_pstIPConnect->m_sockfd))
-		{
-			if(0 > addtoEPollList(a_pstIPConnect))
-			{
-				u8ReturnType =  STS_MBUS_STACK_ERROR_SOCKET_LISTEN_FAILED;
-				Mark_Sock_Fail(a_pstIPConnect);
-				break;
-			}
-			printf("Added to listen \n");
-			a_pstIPConnect->m_bIsAddedToEPoll = true;
-		}
-
-		// forcefully sleep for 50ms to complete previous send request
-		// This is to match the speed between master and slave
-		//usleep(g_lInterframeDelay);
-		sleep_micros(g_stModbusDevConfig.m_lInterframedelay);
+		printf("Socket creation failed !! error ::%d\n", errno);
+		return STS_MBUS_STACK_ERROR_SOCKET_FAILED;
+	}
+	a_pstIPConnect->m_sockfd = sockfd;
 
-		int res = send(sockfd, recvBuff, (pstMBusRequesPacket->m_stMbusTxData.m_u16Length), MSG_NOSIGNAL);
+	if (setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &iEnable, sizeof(int)) < 0)
+	{
+		printf("setsockopt(TCP_NODELAY) failed ::%d\n", errno);
+	}
+	if (setsockopt(sockfd, SOL_SOCKET, SO_REUSEADDR, &iEnable, sizeof(int)) < 0)
+	{
+		printf("setsockopt(SO_REUSEADDR) failed ::%d\n", errno);
+	}
 
-		// in order to avoid application stop whenever SIGPIPE gets generated,used send function with MSG_NOSIGNAL argument
-		if(res < 0)
-		{
-			printf("Error %d occurred while sending request on %d closing the socket\n", errno, sockfd);
-			u8ReturnType =  STS_MBUS_STACK_ERROR_SEND_FAILED;
-			Mark_Sock_Fail(a_pstIPConnect);
-			break;
-		}
+	if(0 == connect(sockfd, (struct sockaddr *)&a_pstIPConnect->m_servAddr, sizeof(a_pstIPConnect->m_servAddr)))
+	{
 		a_pstIPConnect->m_lastConnectStatus = SOCK_CONNECT_SUCCESS;
-
-		// Init req sent timestamp
-		timespec_get(&(pstMBusRequesPacket->m_objTimeStamps.tsReqSent), TIME_UTC);
-		if(0 != addReqToList(pstMBusRequesPacket))
-		{
-			printf("Unable to add request for timeout tracking. marking it as failed.\n");
-			u8ReturnType =  STS_MBUS_STACK_ERROR_FAILED_Q_SENT_REQ;
-			break;
-		}
-
-	} while(0);
-
-	pstMBusRequesPacket->m_u8CommandStatus = u8ReturnType;
-
-	return u8ReturnType;
-}
+		printf("Modbus slave connection established on socket %d\n", sockfd);
+	}
+	else if(EINPROGRESS == errno)
+	{
+		a_pstIPConnect->m_lastConnectStatus = SOCK_CONNECT_INPROGRESS;
+	}
+	else
+	{
+		printf("Connection with Modbus slave failed, so closing socket descriptor %d\n", sockfd);
+		closeConnection(a_pstIPConnect);
+		return STS_MBUS_STACK_ERROR_CONNECT_FAILED;
+	}
+	return STS_MBUS_STACK_NO_ERROR;
+} // End of Modbus_StartConnect
 #endif
@@ -134,7 +134,146 @@ MODBUS_STACK_EXPORT stDevConfig_t* AppMbusMaster_GetStackConfigParam()
 } // AppMbusMaster_GetStackConfigParam
 
 /**
- * @fn MODBUS_STACK_EXPORT uint8_t AppMbusMaster_StackInit()
+ * @fn MODBUS_STACK_EXPORT t_Status AppMbusMaster_GetStackStats(stMbusStackStats_t *pstStats,
+ * 		stMbusCtxStats_t *pstCtxStats, uint32_t u32MaxCtx)
+ *
+ * @brief Exported function to get live occupancy of request pool, context queues,
+ * response queue and timeout tracker. Function does not block request processing
+ * and can be called periodically to monitor the stack.
+ *
+ * @param pstStats 		[out] stMbusStackStats_t* stack statistics
+ * @param pstCtxStats 	[out] stMbusCtxStats_t* array to fill per context statistics, can be NULL
+ * @param u32MaxCtx 	[in] uint32_t number of entries in pstCtxStats. Statistics of at most
+ * 							 u32MaxCtx contexts are filled; m_u32CtxCount of pstStats gives
+ * 							 number of contexts created.
+ *
+ * @return t_Status [out] STS_MBUS_STACK_NO_ERROR if statistics are filled;
+ * 						  STS_MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER if pstStats is NULL
+ */
+MODBUS_STACK_EXPORT t_Status AppMbusMaster_GetStackStats(stMbusStackStats_t *pstStats,
+		stMbusCtxStats_t *pstCtxStats,
+		uint32_t u32MaxCtx)
+{
+	stLiveSerSessionList_t *pstLivSerSesslist = NULL;
+	int32_t i32QueueCount = 0;
+
+	if(NULL == pstStats)
+	{
+		return STS_MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER;
+	}
+	memset(pstStats, 0, sizeof(stMbusStackStats_t));
+
+	getReqManagerStats(pstStats);
+
+	if(NULL == LivSerSesslist_Mutex || 0 != Osal_Wait_Mutex(LivSerSesslist_Mutex))
+	{
+		// stack is not initialized or fail to lock mutex, no contexts to report
+		return STS_MBUS_STACK_NO_ERROR;
+	}
+	for(pstLivSerSesslist = pstSesCtlThdLstHead; NULL != pstLivSerSesslist;
+			pstLivSerSesslist = pstLivSerSesslist->m_pNextElm)
+	{
+		if((NULL != pstCtxStats) && (pstStats->m_u32CtxCount < u32MaxCtx))
+		{
+			stMbusCtxStats_t *pstCtx = &pstCtxStats[pstStats->m_u32CtxCount];
+			pstCtx->m_i32Ctx = pstLivSerSesslist->MsgQId;
+			i32QueueCount = OSAL_Get_Message_Count(pstLivSerSesslist->MsgQId);
+			pstCtx->m_u32QueueDepth = (i32QueueCount > 0) ? (uint32_t)i32QueueCount : 0;
+			pstCtx->m_u32InFlight = getReqCtxInFlight(pstLivSerSesslist->MsgQId);
+		}
+		pstStats->m_u32CtxCount++;
+	}
+	Osal_Release_Mutex (LivSerSesslist_Mutex);
+
+	return STS_MBUS_STACK_NO_ERROR;
+} // End of AppMbusMaster_GetStackStats
+
+/**
+ * @fn static t_Status validateStackInitConfig(stStackInitConfig_t *a_pstConfig,
+ * 												stStackInitConfig_t *a_pstValidConfig)
+ *
+ * @brief This function validates stack init configuration received from ModbusApp and
+ * fills default values for parameters which are not provided.
+ *
+ * @param a_pstConfig 		[in] stStackInitConfig_t* configuration from ModbusApp, can be NULL
+ * @param a_pstValidConfig 	[out] stStackInitConfig_t* validated configuration
+ *
+ * @return t_Status [out] STS_MBUS_STACK_NO_ERROR if configuration is valid;
+ * 						  STS_MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER otherwise
+ */
+static t_Status validateStackInitConfig(stStackInitConfig_t *a_pstConfig,
+		stStackInitConfig_t *a_pstValidConfig)
+{
+	a_pstValidConfig->m_u32ReqPoolInitSize = DEFAULT_REQ_POOL_INIT_SIZE;
+	a_pstValidConfig->m_u32ReqPoolMaxSize = MAX_REQUESTS;
+	a_pstValidConfig->m_u32ReqPoolChunkSize = DEFAULT_REQ_POOL_CHUNK_SIZE;
+	a_pstValidConfig->m_eReqPoolPolicy = eReqPoolGrow;
+	a_pstValidConfig->m_eAdmissionMode = eReqAdmitFailFast;
+	a_pstValidConfig->m_lAdmissionTimeout = 0;
+	a_pstValidConfig->m_u32RespDispatchers = DEFAULT_RESP_DISPATCHERS;
+	a_pstValidConfig->m_u32Reactors = DEFAULT_REACTORS;
+	a_pstValidConfig->m_eReactorAssign = eReactorLeastLoaded;
+	a_pstValidConfig->m_bReactorCpuAffinity = false;
+
+	if(NULL != a_pstConfig)
+	{
+		if(a_pstConfig->m_u32ReqPoolMaxSize > MAX_REQ_POOL_SIZE ||
+				a_pstConfig->m_u32RespDispatchers > MAX_RESP_DISPATCHERS ||
+				a_pstConfig->m_u32Reactors > MAX_REACTORS ||
+				a_pstConfig->m_eReactorAssign > eReactorHash ||
+				a_pstConfig->m_eReqPoolPolicy > eReqPoolGrowAndTrim ||
+				a_pstConfig->m_eAdmissionMode > eReqAdmitTimedWait ||
+				(eReqAdmitTimedWait == a_pstConfig->m_eAdmissionMode &&
+						a_pstConfig->m_lAdmissionTimeout <= 0))
+		{
+			return STS_MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER;
+		}
+		if(0 != a_pstConfig->m_u32ReqPoolMaxSize)
+		{
+			a_pstValidConfig->m_u32ReqPoolMaxSize = a_pstConfig->m_u32ReqPoolMaxSize;
+		}
+		if(0 != a_pstConfig->m_u32ReqPoolInitSize)
+		{
+			a_pstValidConfig->m_u32ReqPoolInitSize = a_pstConfig->m_u32ReqPoolInitSize;
+		}
+		if(0 != a_pstConfig->m_u32ReqPoolChunkSize)
+		{
+			a_pstValidConfig->m_u32ReqPoolChunkSize = a_pstConfig->m_u32ReqPoolChunkSize;
+		}
+		a_pstValidConfig->m_eReqPoolPolicy = a_pstConfig->m_eReqPoolPolicy;
+		a_pstValidConfig->m_eAdmissionMode = a_pstConfig->m_eAdmissionMode;
+		a_pstValidConfig->m_lAdmissionTimeout = a_pstConfig->m_lAdmissionTimeout;
+		if(0 != a_pstConfig->m_u32RespDispatchers)
+		{
+			a_pstValidConfig->m_u32RespDispatchers = a_pstConfig->m_u32RespDispatchers;
+		}
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+		if(0 != a_pstConfig->m_u32Reactors)
+		{
+			a_pstValidConfig->m_u32Reactors = a_pstConfig->m_u32Reactors;
+		}
+		a_pstValidConfig->m_eReactorAssign = a_pstConfig->m_eReactorAssign;
+		a_pstValidConfig->m_bReactorCpuAffinity = a_pstConfig->m_bReactorCpuAffinity;
+#endif
+	}
+	if(a_pstValidConfig->m_u32ReqPoolInitSize > a_pstValidConfig->m_u32ReqPoolMaxSize)
+	{
+		if(NULL != a_pstConfig && 0 != a_pstConfig->m_u32ReqPoolInitSize)
+		{
+			return STS_MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER;
+		}
+		// default initial size is larger than requested maximum size
+		a_pstValidConfig->m_u32ReqPoolInitSize = a_pstValidConfig->m_u32ReqPoolMaxSize;
+	}
+	if(eReqPoolFixed == a_pstValidConfig->m_eReqPoolPolicy)
+	{
+		a_pstValidConfig->m_u32ReqPoolInitSize = a_pstValidConfig->m_u32ReqPoolMaxSize;
+	}
+	return STS_MBUS_STACK_NO_ERROR;
+} // End of validateStackInitConfig
+
+/**
+ * @fn MODBUS_STACK_EXPORT t_Status AppMbusMaster_StackInit(stStackInitConfig_t *pstConfig)
  *
  * @brief  Exported function to initiate modbus master stack. If TCP mode is getting used
  * for communication with Modbus device, it initializes TCP request list
@@ -142,21 +281,42 @@ MODBUS_STACK_EXPORT stDevConfig_t* AppMbusMaster_GetStackConfigParam()
  * keep track of all the incoming requests from ModbusApp and initializes Linux message queue
  * to store all the requests send to the Modbus device. If all of this succeeds,
  * function then starts a session control thread.
+ * Request pool is sized as per pstConfig. Memory of request pool is committed in chunks
+ * as more requests are in flight. Admission mode in pstConfig selects whether request APIs
+ * fail or wait when no request node is available. Responses are decoded and sent to
+ * ModbusApp by a pool of dispatcher threads; responses of one context are always handled
+ * by the same thread, in order. In TCP mode, devices are served by a fixed number of event
+ * loop threads given in pstConfig; no thread is created per device.
  *
- * @param none
+ * @param pstConfig [in] stStackInitConfig_t* request pool size, growth policy, admission mode,
+ * 						 number of response dispatchers and event loops;
+ * 						 NULL to use default configuration
  *
  * @return uint8_t [out] MBUS_STACK_INIT_FAILED or MBUS_STACK_ERROR_THREAD_CREATE in case of error,
+ * 						 MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER in case of invalid configuration,
  * 						 MBUS_STACK_NO_ERROR in case of success
  *
  */
-MODBUS_STACK_EXPORT t_Status AppMbusMaster_StackInit()
+MODBUS_STACK_EXPORT t_Status AppMbusMaster_StackInit(stStackInitConfig_t *pstConfig)
 {
 	//Local variable
 	t_Status eStatus = STS_OK;
+	stStackInitConfig_t stConfig = { 0 };
 	g_bThreadExit = false;
 
+	eStatus = validateStackInitConfig(pstConfig, &stConfig);
+	if(STS_MBUS_STACK_NO_ERROR != eStatus)
+	{
+		return eStatus;
+	}
+	// Initialize request manager and data structure before any thread can use it
+	if(!initReqManager(&stConfig))
+	{
+		return STS_MBUS_STACK_INIT_FAILED;
+	}
+
 	// if initRespStructs is -1 then MBUS_STACK_INIT_FAILED (stack error code)
-	if(-1 == initRespStructs())
+	if(-1 == initRespStructs(&stConfig))
 	{
 		printf("failed to init initTCPRespStructs\n");
 		eStatus = STS_MBUS_STACK_INIT_FAILED;
@@ -167,17 +327,33 @@ MODBUS_STACK_EXPORT t_Status AppMbusMaster_StackInit()
 	{
 		eStatus = STS_MBUS_STACK_ERROR_MUTEX_CREATE;
 	}
-	// Initialize request manager and data structure
-	if(!initReqManager())
-	{
-		eStatus = STS_MBUS_STACK_INIT_FAILED;
-	}
 
-	if(STS_MBUS_STACK_NO_ERROR == eStatus)
+	if(STS_MBUS_STACK_NO_ERROR != eStatus)
 	{
-		// set the stack enable status as true
-		g_bIsStackEnable = true;
+		// stop threads started so far before request pool they use is released
+		g_bThreadExit = true;
+		deinitRespStructs();
+		if(NULL != LivSerSesslist_Mutex)
+		{
+			Osal_Close_Mutex(LivSerSesslist_Mutex);
+			LivSerSesslist_Mutex = NULL;
+		}
+		deinitReqManager();
+		return eStatus;
 	}
+
+	printf("Request pool: initial size %u, maximum size %u, chunk size %u, policy %d\n",
+			stConfig.m_u32ReqPoolInitSize, stConfig.m_u32ReqPoolMaxSize,
+			stConfig.m_u32ReqPoolChunkSize, stConfig.m_eReqPoolPolicy);
+	printf("Request admission mode %d, timeout %ld ms\n",
+			stConfig.m_eAdmissionMode, stConfig.m_lAdmissionTimeout);
+	printf("Response dispatchers %u\n", stConfig.m_u32RespDispatchers);
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+	printf("Event loops %u\n", stConfig.m_u32Reactors);
+#endif
+
+	// set the stack enable status as true
+	g_bIsStackEnable = true;
 	return eStatus;
 } // AppMbusMaster_StackInit
 
@@ -237,6 +413,11 @@ MODBUS_STACK_EXPORT void AppMbusMaster_StackDeInit(void)
 		//Delete message queue by message ID
 		if(pstTempLivSerSesslist->MsgQId)
 		{
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+			// detach device from event loop before its queue and doorbell go away
+			removeReactorSession(pstTempLivSerSesslist->m_pstReactorSession);
+			pstTempLivSerSesslist->m_pstReactorSession = NULL;
+#endif
 			//Delete the message queue for the valid message ID
 			OSAL_Delete_Message_Queue(pstTempLivSerSesslist->MsgQId);
 		}
@@ -254,6 +435,7 @@ MODBUS_STACK_EXPORT void AppMbusMaster_StackDeInit(void)
 	}
 
 	deinitRespStructs();
+	deinitReqManager();
 
 	//update re-entrancy flag
 	bDeInitStackFlag = false;
@@ -291,9 +473,19 @@ MODBUS_STACK_EXPORT void removeCtx(int msgQId)
 		if(pstTempLivSerSesslist->MsgQId == msgQId)
 		{
 			//Terminate the thread
-			Osal_Thread_Terminate(pstTempLivSerSesslist->m_ThreadId);
+			if(pstTempLivSerSesslist->m_ThreadId)
+			{
+				Osal_Thread_Terminate(pstTempLivSerSesslist->m_ThreadId);
+			}
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+			// detach device from event loop before its queue and doorbell go away
+			removeReactorSession(pstTempLivSerSesslist->m_pstReactorSession);
+			pstTempLivSerSesslist->m_pstReactorSession = NULL;
+#endif
 			//Delete the message queue ID
 			OSAL_Delete_Message_Queue(pstTempLivSerSesslist->MsgQId);
+			//Give back guaranteed share of request nodes
+			unregisterReqCtx(pstTempLivSerSesslist->MsgQId);
 			//Free allocate memory
 			OSAL_Free(pstTempLivSerSesslist);
 		}
@@ -468,10 +660,10 @@ uint8_t CreateHeaderForModbusRequest(uint16_t u16StartAddr,
 			stEndianess.stByteOrder.u8SecondByte;
 	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] =
 			stEndianess.stByteOrder.u8FirstByte;
-	pstMBusRequesPacket->m_u16TransactionID = stEndianess.u16word;
+	REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID = stEndianess.u16word;
 #else
 	// Transaction ID
-	pstMBusRequesPacket->m_u16TransactionID = u16TransacID;
+	REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID = u16TransacID;
 #endif
 
 #ifdef MODBUS_STACK_TCPIP_ENABLED
@@ -497,7 +689,7 @@ uint8_t CreateHeaderForModbusRequest(uint16_t u16StartAddr,
 
 	// Unit Id
 	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] =  u8UnitId;
-	pstMBusRequesPacket->m_u8UnitID = u8UnitId;
+	REQ_HOT_META(pstMBusRequesPacket)->m_u8UnitID = u8UnitId;
 
 	// Function Code
 	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] = u8FunctionCode;
@@ -554,10 +746,10 @@ uint8_t CreateHeaderForDevIdentificationModbusRequest(uint8_t u8UnitId,
 	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] =
 			stEndianess.stByteOrder.u8FirstByte;
 	// Transaction ID
-	pstMBusRequesPacket->m_u16TransactionID = stEndianess.u16word;
+	REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID = stEndianess.u16word;
 #else
 	// Transaction ID
-	pstMBusRequesPacket->m_u16TransactionID = u16TransacID;
+	REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID = u16TransacID;
 #endif
 
 #ifdef MODBUS_STACK_TCPIP_ENABLED
@@ -579,7 +771,7 @@ uint8_t CreateHeaderForDevIdentificationModbusRequest(uint8_t u8UnitId,
 
 	//Unit Id
 	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] =  u8UnitId;
-	pstMBusRequesPacket->m_u8UnitID = u8UnitId;
+	REQ_HOT_META(pstMBusRequesPacket)->m_u8UnitID = u8UnitId;
 
 	//Function Code
 	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] = u8FunctionCode;
@@ -668,7 +860,8 @@ t_Status InputParameterVerification(uint16_t u16StartCoilOrReg, uint16_t u16Numb
  * @return uint8_t		[out] MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER in case of error in parameters
  * 									  received from ModbusApp
  * 							  MBUS_STACK_ERROR_MAX_REQ_SENT in case if Modbus stack has already sent maximum
- * 							  		  number of requests than can be added in the request manager's list
+ * 							  		  number of requests than can be added in the request manager's list,
+ * 							  		  or message queue of context is full
  * 							  MBUS_STACK_ERROR_PACKET_LENGTH_EXCEEDED if request is longer than standard Modbus request
  * 							  		  length
  * 							  MBUS_STACK_ERROR_QUEUE_SEND in case if function fails to copy this message in
@@ -703,7 +896,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Coils(uint16_t u16StartCoil,
 		return u8ReturnType;
 	}
 	// create request for read coils initiated from app
-	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd);
+	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd, i32Ctx);
 
 	if(NULL == pstMBusRequesPacket)
 	{
@@ -718,7 +911,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Coils(uint16_t u16StartCoil,
 	u16PacketIndex = CreateHeaderForModbusRequest(	u16StartCoil,
 													u8UnitId,
 													u16HeaderLength,
-													pstMBusRequesPacket->m_ulMyId,
+													REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 													u8FunctionCode,
 													pstMBusRequesPacket);
 
@@ -745,9 +938,9 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Coils(uint16_t u16StartCoil,
 	stPostThreadMsg.MsgType = lPriority;
 
 	// Post the request into message queue
-	if(!OSAL_Post_Message(&stPostThreadMsg))
+	u8ReturnType = postNewRequest(&stPostThreadMsg);
+	if(STS_MBUS_STACK_NO_ERROR != u8ReturnType)
 	{
-		u8ReturnType = STS_MBUS_STACK_ERROR_QUEUE_SEND;
 		freeReqNode(pstMBusRequesPacket);
 	}
 
@@ -788,7 +981,8 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Coils(uint16_t u16StartCoil,
  * @return uint8_t		[out] MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER in case of error in parameters
  * 									  received from ModbusApp
  * 							  MBUS_STACK_ERROR_MAX_REQ_SENT in case if Modbus stack has already sent maximum
- * 							  		  number of requests than can be added in the request manager's list
+ * 							  		  number of requests than can be added in the request manager's list,
+ * 							  		  or message queue of context is full
  * 							  MBUS_STACK_ERROR_PACKET_LENGTH_EXCEEDED if request is longer than standard Modbus request
  * 							  		  length
  * 							  MBUS_STACK_ERROR_QUEUE_SEND in case if function fails to copy this message in
@@ -823,7 +1017,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Discrete_Inputs(uint16_t u16StartDI,
 		return u8ReturnType;
 	}
 
-	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd);
+	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd, i32Ctx);
 	if(NULL == pstMBusRequesPacket)
 	{
 		return STS_MBUS_STACK_ERROR_MAX_REQ_SENT;
@@ -837,7 +1031,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Discrete_Inputs(uint16_t u16StartDI,
 	u16PacketIndex = CreateHeaderForModbusRequest(	u16StartDI,
 													u8UnitId,
 													u16HeaderLength,
-													pstMBusRequesPacket->m_ulMyId,
+													REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 													u8FunctionCode,
 													pstMBusRequesPacket);
 
@@ -872,9 +1066,9 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Discrete_Inputs(uint16_t u16StartDI,
 	stPostThreadMsg.MsgType = lPriority;
 
 	// Post the request into message queue
-	if(!OSAL_Post_Message(&stPostThreadMsg))
+	u8ReturnType = postNewRequest(&stPostThreadMsg);
+	if(STS_MBUS_STACK_NO_ERROR != u8ReturnType)
 	{
-		u8ReturnType = STS_MBUS_STACK_ERROR_QUEUE_SEND;
 		freeReqNode(pstMBusRequesPacket);
 	}
 
@@ -915,7 +1109,8 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Discrete_Inputs(uint16_t u16StartDI,
   * @return uint8_t		[out] MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER in case of error in parameters
  * 									  received from ModbusApp
  * 							  MBUS_STACK_ERROR_MAX_REQ_SENT in case if Modbus stack has already sent maximum
- * 							  		  number of requests than can be added in the request manager's list
+ * 							  		  number of requests than can be added in the request manager's list,
+ * 							  		  or message queue of context is full
  * 							  MBUS_STACK_ERROR_PACKET_LENGTH_EXCEEDED if request is longer than standard
  * 							  Modbus request length
  * 							  MBUS_STACK_ERROR_QUEUE_SEND in case if function fails to copy this message in
@@ -949,7 +1144,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Holding_Registers(uint16_t u16StartReg,
 		return u8ReturnType;
 	}
 
-	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd);
+	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd, i32Ctx);
 
 	if(NULL == pstMBusRequesPacket)
 	{
@@ -963,7 +1158,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Holding_Registers(uint16_t u16StartReg,
 	u16PacketIndex = CreateHeaderForModbusRequest(u16StartReg,
 													u8UnitId,
 													u16HeaderLength,
-													pstMBusRequesPacket->m_ulMyId,
+													REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 													u8FunctionCode,
 													pstMBusRequesPacket);
 
@@ -996,9 +1191,9 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Holding_Registers(uint16_t u16StartReg,
 	stPostThreadMsg.wParam = NULL;
 	stPostThreadMsg.MsgType = lPriority;
 
-	if(!OSAL_Post_Message(&stPostThreadMsg))
+	u8ReturnType = postNewRequest(&stPostThreadMsg);
+	if(STS_MBUS_STACK_NO_ERROR != u8ReturnType)
 	{
-		u8ReturnType = STS_MBUS_STACK_ERROR_QUEUE_SEND;
 		freeReqNode(pstMBusRequesPacket);
 	}
 
@@ -1038,7 +1233,8 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Holding_Registers(uint16_t u16StartReg,
  * @return uint8_t		[out] MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER in case of error in parameters
  * 									  received from ModbusApp
  * 							  MBUS_STACK_ERROR_MAX_REQ_SENT in case if Modbus stack has already sent maximum
- * 							  		  number of requests than can be added in the request manager's list
+ * 							  		  number of requests than can be added in the request manager's list,
+ * 							  		  or message queue of context is full
  * 							  MBUS_STACK_ERROR_PACKET_LENGTH_EXCEEDED if request is longer than standard
  * 							  Modbus request length
  * 							  MBUS_STACK_ERROR_QUEUE_SEND in case if function fails to copy this message in
@@ -1072,7 +1268,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Input_Registers(uint16_t u16StartReg,
 	{
 		return u8ReturnType;
 	}
-	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd);
+	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd, i32Ctx);
 
 	if(NULL == pstMBusRequesPacket)
 	{
@@ -1088,7 +1284,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Input_Registers(uint16_t u16StartReg,
 	u16PacketIndex = CreateHeaderForModbusRequest(	u16StartReg,
 													u8UnitId,
 													u16HeaderLength,
-													pstMBusRequesPacket->m_ulMyId,
+													REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 													u8FunctionCode,
 													pstMBusRequesPacket);
 
@@ -1123,9 +1319,9 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Input_Registers(uint16_t u16StartReg,
 	stPostThreadMsg.MsgType = lPriority;
 
 	// Post the request into message queue
-	if(!OSAL_Post_Message(&stPostThreadMsg))
+	u8ReturnType = postNewRequest(&stPostThreadMsg);
+	if(STS_MBUS_STACK_NO_ERROR != u8ReturnType)
 	{
-		u8ReturnType = STS_MBUS_STACK_ERROR_QUEUE_SEND;
 		freeReqNode(pstMBusRequesPacket);
 	}
 
@@ -1165,7 +1361,8 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Input_Registers(uint16_t u16StartReg,
  * @return uint8_t		[out] MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER in case of error in parameters
  * 									  received from ModbusApp
  * 							  MBUS_STACK_ERROR_MAX_REQ_SENT in case if Modbus stack has already sent maximum
- * 							  		  number of requests than can be added in the request manager's list
+ * 							  		  number of requests than can be added in the request manager's list,
+ * 							  		  or message queue of context is full
  * 							  MBUS_STACK_ERROR_PACKET_LENGTH_EXCEEDED if request is longer than standard
  * 							  Modbus request length
  * 							  MBUS_STACK_ERROR_QUEUE_SEND in case if function fails to copy this message in
@@ -1199,7 +1396,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Single_Coil(uint16_t u16StartCoil,
 		return u8ReturnType;
 	}
 
-	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd);
+	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd, i32Ctx);
 
 	if(NULL == pstMBusRequesPacket)
 	{
@@ -1213,7 +1410,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Single_Coil(uint16_t u16StartCoil,
 	u16PacketIndex = CreateHeaderForModbusRequest(	u16StartCoil,
 													u8UnitId,
 													u16HeaderLength,
-													pstMBusRequesPacket->m_ulMyId,
+													REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 													u8FunctionCode,
 													pstMBusRequesPacket);
 
@@ -1244,9 +1441,9 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Single_Coil(uint16_t u16StartCoil,
 	stPostThreadMsg.wParam = NULL;
 	stPostThreadMsg.MsgType = lPriority;
 
-	if(!OSAL_Post_Message(&stPostThreadMsg))
+	u8ReturnType = postNewRequest(&stPostThreadMsg);
+	if(STS_MBUS_STACK_NO_ERROR != u8ReturnType)
 	{
-		u8ReturnType = STS_MBUS_STACK_ERROR_QUEUE_SEND;
 		freeReqNode(pstMBusRequesPacket);
 	}
 
@@ -1286,7 +1483,8 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Single_Coil(uint16_t u16StartCoil,
  * @return uint8_t		[out] MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER in case of error in parameters
  * 									  received from ModbusApp
  * 							  MBUS_STACK_ERROR_MAX_REQ_SENT in case if Modbus stack has already sent maximum
- * 							  		  number of requests than can be added in the request manager's list
+ * 							  		  number of requests than can be added in the request manager's list,
+ * 							  		  or message queue of context is full
  * 							  MBUS_STACK_ERROR_PACKET_LENGTH_EXCEEDED if request is longer than standard
  * 							  Modbus request length
  * 							  MBUS_STACK_ERROR_QUEUE_SEND in case if function fails to copy this message in
@@ -1319,7 +1517,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Single_Register(uint16_t u16StartReg,
 	{
 		return u8ReturnType;
 	}
-	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd);
+	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd, i32Ctx);
 
 	if(NULL == pstMBusRequesPacket)
 	{
@@ -1334,7 +1532,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Single_Register(uint16_t u16StartReg,
 	u16PacketIndex = CreateHeaderForModbusRequest(	u16StartReg,
 													u8UnitId,
 													u16HeaderLength,
-													pstMBusRequesPacket->m_ulMyId,
+													REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 													u8FunctionCode,
 													pstMBusRequesPacket);
 
@@ -1364,9 +1562,9 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Single_Register(uint16_t u16StartReg,
 	stPostThreadMsg.wParam = NULL;
 	stPostThreadMsg.MsgType = lPriority;
 
-	if(!OSAL_Post_Message(&stPostThreadMsg))
+	u8ReturnType = postNewRequest(&stPostThreadMsg);
+	if(STS_MBUS_STACK_NO_ERROR != u8ReturnType)
 	{
-		u8ReturnType = STS_MBUS_STACK_ERROR_QUEUE_SEND;
 		//free(pstMBusRequesPacket);
 		freeReqNode(pstMBusRequesPacket);
 	}
@@ -1410,7 +1608,8 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Single_Register(uint16_t u16StartReg,
  * @return uint8_t		[out] MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER in case of error in parameters
  * 									  received from ModbusApp
  * 							  MBUS_STACK_ERROR_MAX_REQ_SENT in case if Modbus stack has already sent maximum
- * 							  		  number of requests than can be added in the request manager's list
+ * 							  		  number of requests than can be added in the request manager's list,
+ * 							  		  or message queue of context is full
  * 							  MBUS_STACK_ERROR_PACKET_LENGTH_EXCEEDED if request is longer than standard
  * 							  Modbus request length
  * 							  MBUS_STACK_ERROR_QUEUE_SEND in case if function fails to copy this message in
@@ -1446,7 +1645,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Multiple_Coils(uint16_t u16Startcoil,
 	{
 		return u8ReturnType;
 	}
-	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd);
+	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd, i32Ctx);
 
 	if(NULL == pstMBusRequesPacket)
 	{
@@ -1459,7 +1658,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Multiple_Coils(uint16_t u16Startcoil,
 	u16PacketIndex = CreateHeaderForModbusRequest(	u16Startcoil,
 													u8UnitId,
 													u16HeaderLength,
-													pstMBusRequesPacket->m_ulMyId,
+													REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 													u8FunctionCode,
 													pstMBusRequesPacket);
 
@@ -1504,9 +1703,9 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Multiple_Coils(uint16_t u16Startcoil,
 	stPostThreadMsg.wParam = NULL;
 	stPostThreadMsg.MsgType = lPriority;
 
-	if(!OSAL_Post_Message(&stPostThreadMsg))
+	u8ReturnType = postNewRequest(&stPostThreadMsg);
+	if(STS_MBUS_STACK_NO_ERROR != u8ReturnType)
 	{
-		u8ReturnType = STS_MBUS_STACK_ERROR_QUEUE_SEND;
 		freeReqNode(pstMBusRequesPacket);
 	}
 
@@ -1549,7 +1748,8 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Multiple_Coils(uint16_t u16Startcoil,
  * @return uint8_t		[out] MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER in case of error in parameters
  * 									  received from ModbusApp
  * 							  MBUS_STACK_ERROR_MAX_REQ_SENT in case if Modbus stack has already sent maximum
- * 							  		  number of requests than can be added in the request manager's list
+ * 							  		  number of requests than can be added in the request manager's list,
+ * 							  		  or message queue of context is full
  * 							  MBUS_STACK_ERROR_PACKET_LENGTH_EXCEEDED if request is longer than standard
  * 							  		  Modbus request length
  * 							  MBUS_STACK_ERROR_QUEUE_SEND in case if function fails to copy this message in
@@ -1585,7 +1785,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Multiple_Register(uint16_t u16StartReg
 	{
 		return u8ReturnType;
 	}
-	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd);
+	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd, i32Ctx);
 
 	if(NULL == pstMBusRequesPacket)
 	{
@@ -1598,7 +1798,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Multiple_Register(uint16_t u16StartReg
 	u16PacketIndex = CreateHeaderForModbusRequest(	u16StartReg,
 													u8UnitId,
 													u16HeaderLength,
-													pstMBusRequesPacket->m_ulMyId,
+													REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 													u8FunctionCode,
 													pstMBusRequesPacket);
 
@@ -1650,9 +1850,9 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Multiple_Register(uint16_t u16StartReg
 	stPostThreadMsg.wParam = NULL;
 	stPostThreadMsg.MsgType = lPriority;
 
-	if(!OSAL_Post_Message(&stPostThreadMsg))
+	u8ReturnType = postNewRequest(&stPostThreadMsg);
+	if(STS_MBUS_STACK_NO_ERROR != u8ReturnType)
 	{
-		u8ReturnType = STS_MBUS_STACK_ERROR_QUEUE_SEND;
 		freeReqNode(pstMBusRequesPacket);
 	}
 
@@ -1694,7 +1894,8 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_Multiple_Register(uint16_t u16StartReg
  * @return uint8_t		[out] MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER in case of error in parameters
  * 									  received from ModbusApp
  * 							  MBUS_STACK_ERROR_MAX_REQ_SENT in case if Modbus stack has already sent maximum
- * 							  		  number of requests than can be added in the request manager's list
+ * 							  		  number of requests than can be added in the request manager's list,
+ * 							  		  or message queue of context is full
  * 							  MBUS_STACK_ERROR_PACKET_LENGTH_EXCEEDED if request is longer than standard
  * 							  		  Modbus request length
  * 							  MBUS_STACK_ERROR_QUEUE_SEND in case if function fails to copy this message in
@@ -1734,7 +1935,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_File_Record(uint8_t u8byteCount,
 		return u8ReturnType;
 	}
 
-	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd);
+	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd, i32Ctx);
 
 	if(NULL == pstMBusRequesPacket)
 	{
@@ -1745,15 +1946,15 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_File_Record(uint8_t u8byteCount,
 
 #ifdef MODBUS_STACK_TCPIP_ENABLED
 	// Transaction ID
-	stEndianess.u16word = pstMBusRequesPacket->m_ulMyId;
+	stEndianess.u16word = REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID;
 
 	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] =
 			stEndianess.stByteOrder.u8SecondByte;
 	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] =
 			stEndianess.stByteOrder.u8FirstByte;
-	pstMBusRequesPacket->m_u16TransactionID = stEndianess.u16word;
+	REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID = stEndianess.u16word;
 #else
-	pstMBusRequesPacket->m_u16TransactionID = u16TransacID;
+	REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID = u16TransacID;
 #endif
 
 #ifdef MODBUS_STACK_TCPIP_ENABLED
@@ -1774,7 +1975,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_File_Record(uint8_t u8byteCount,
 
 	// Unit Id
 	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] =  u8UnitId;
-	pstMBusRequesPacket->m_u8UnitID = u8UnitId;
+	REQ_HOT_META(pstMBusRequesPacket)->m_u8UnitID = u8UnitId;
 
 	// Function Code
 	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] = u8FunCode;
@@ -1833,9 +2034,9 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_File_Record(uint8_t u8byteCount,
 	stPostThreadMsg.wParam = NULL;
 	stPostThreadMsg.MsgType = lPriority;
 
-	if(!OSAL_Post_Message(&stPostThreadMsg))
+	u8ReturnType = postNewRequest(&stPostThreadMsg);
+	if(STS_MBUS_STACK_NO_ERROR != u8ReturnType)
 	{
-		u8ReturnType = STS_MBUS_STACK_ERROR_QUEUE_SEND;
 		freeReqNode(pstMBusRequesPacket);
 	}
 
@@ -1878,7 +2079,8 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_File_Record(uint8_t u8byteCount,
  * @return uint8_t		[out] MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER in case of error in parameters
  * 									  received from ModbusApp
  * 							  MBUS_STACK_ERROR_MAX_REQ_SENT in case if Modbus stack has already sent maximum
- * 							  		  number of requests than can be added in the request manager's list
+ * 							  		  number of requests than can be added in the request manager's list,
+ * 							  		  or message queue of context is full
  * 							  MBUS_STACK_ERROR_PACKET_LENGTH_EXCEEDED if request is longer than standard
  * 							  		  Modbus request length
  * 							  MBUS_STACK_ERROR_QUEUE_SEND in case if function fails to copy this message in
@@ -1918,7 +2120,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_File_Record(uint8_t u8ReqDataLen,
 		return u8ReturnType;
 	}
 
-	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd);
+	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd, i32Ctx);
 
 	if(NULL == pstMBusRequesPacket)
 	{
@@ -1929,16 +2131,16 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_File_Record(uint8_t u8ReqDataLen,
 
 #ifdef MODBUS_STACK_TCPIP_ENABLED
 	// Transaction ID
-	stEndianess.u16word = pstMBusRequesPacket->m_ulMyId;
+	stEndianess.u16word = REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID;
 
 	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] =
 			stEndianess.stByteOrder.u8SecondByte;
 	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] =
 			stEndianess.stByteOrder.u8FirstByte;
-	pstMBusRequesPacket->m_u16TransactionID = stEndianess.u16word;
+	REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID = stEndianess.u16word;
 #else
 	// Transaction ID
-	pstMBusRequesPacket->m_u16TransactionID = u16TransacID;
+	REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID = u16TransacID;
 #endif
 
 #ifdef MODBUS_STACK_TCPIP_ENABLED
@@ -1958,7 +2160,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_File_Record(uint8_t u8ReqDataLen,
 #endif
 	// Unit Id
 	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] =  u8UnitId;
-	pstMBusRequesPacket->m_u8UnitID = u8UnitId;
+	REQ_HOT_META(pstMBusRequesPacket)->m_u8UnitID = u8UnitId;
 
 	// Function Code
 	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] = u8FunCode;
@@ -2027,9 +2229,9 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_File_Record(uint8_t u8ReqDataLen,
 	stPostThreadMsg.wParam = NULL;
 	stPostThreadMsg.MsgType = lPriority;
 
-	if(!OSAL_Post_Message(&stPostThreadMsg))
+	u8ReturnType = postNewRequest(&stPostThreadMsg);
+	if(STS_MBUS_STACK_NO_ERROR != u8ReturnType)
 	{
-		u8ReturnType = STS_MBUS_STACK_ERROR_QUEUE_SEND;
 		freeReqNode(pstMBusRequesPacket);
 	}
 
@@ -2079,7 +2281,8 @@ MODBUS_STACK_EXPORT t_Status Modbus_Write_File_Record(uint8_t u8ReqDataLen,
  * @return uint8_t		[out] MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER in case of error in parameters
  * 									  received from ModbusApp
  * 							  MBUS_STACK_ERROR_MAX_REQ_SENT in case if Modbus stack has already sent maximum
- * 							  		  number of requests than can be added in the request manager's list
+ * 							  		  number of requests than can be added in the request manager's list,
+ * 							  		  or message queue of context is full
  * 							  MBUS_STACK_ERROR_PACKET_LENGTH_EXCEEDED if request is longer than standard
  * 							  		  Modbus request length
  * 							  MBUS_STACK_ERROR_QUEUE_SEND in case if function fails to copy this message in
@@ -2122,7 +2325,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Write_Registers(uint16_t u16ReadRegAddr
 	{
 			return u8ReturnType;
 	}
-	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd);
+	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd, i32Ctx);
 
 	if(NULL == pstMBusRequesPacket)
 	{
@@ -2137,7 +2340,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Write_Registers(uint16_t u16ReadRegAddr
 		u16PacketIndex = CreateHeaderForModbusRequest(u16ReadRegAddress,
 														u8UnitId,
 														u16HeaderLength,
-														pstMBusRequesPacket->m_ulMyId,
+														REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 														u8FunCode,
 														pstMBusRequesPacket);
 
@@ -2224,9 +2427,9 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Write_Registers(uint16_t u16ReadRegAddr
 	stPostThreadMsg.wParam = NULL;
 	stPostThreadMsg.MsgType = lPriority;
 
-	if(!OSAL_Post_Message(&stPostThreadMsg))
+	u8ReturnType = postNewRequest(&stPostThreadMsg);
+	if(STS_MBUS_STACK_NO_ERROR != u8ReturnType)
 	{
-		u8ReturnType = STS_MBUS_STACK_ERROR_QUEUE_SEND;
 		freeReqNode(pstMBusRequesPacket);
 	}
 
@@ -2271,7 +2474,8 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Write_Registers(uint16_t u16ReadRegAddr
  * @return uint8_t		[out] MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER in case of error in parameters
  * 									  received from ModbusApp
  * 							  MBUS_STACK_ERROR_MAX_REQ_SENT in case if Modbus stack has already sent maximum
- * 							  		  number of requests than can be added in the request manager's list
+ * 							  		  number of requests than can be added in the request manager's list,
+ * 							  		  or message queue of context is full
  * 							  MBUS_STACK_ERROR_PACKET_LENGTH_EXCEEDED if request is longer than standard
  * 							  		  Modbus request length
  * 							  MBUS_STACK_ERROR_QUEUE_SEND in case if function fails to copy this message in
@@ -2325,7 +2529,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Device_Identification(uint8_t u8MEIType
 		return STS_MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER;
 	}
 
-	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd);
+	pstMBusRequesPacket = emplaceNewRequest(tsReqRcvd, i32Ctx);
 
 	if(NULL == pstMBusRequesPacket)
 	{
@@ -2340,7 +2544,7 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Device_Identification(uint8_t u8MEIType
 #endif
 	u16PacketIndex = CreateHeaderForDevIdentificationModbusRequest(u8UnitId,
 														u16HeaderLength,
-														pstMBusRequesPacket->m_ulMyId,
+														REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
 														u8FunCode,
 														pstMBusRequesPacket);
 
@@ -2373,15 +2577,335 @@ MODBUS_STACK_EXPORT t_Status Modbus_Read_Device_Identification(uint8_t u8MEIType
 	stPostThreadMsg.wParam = NULL;
 	stPostThreadMsg.MsgType = lPriority;
 
-	if(!OSAL_Post_Message(&stPostThreadMsg))
+	u8ReturnType = postNewRequest(&stPostThreadMsg);
+	if(STS_MBUS_STACK_NO_ERROR != u8ReturnType)
 	{
-		u8ReturnType = STS_MBUS_STACK_ERROR_QUEUE_SEND;
 		freeReqNode(pstMBusRequesPacket);
 	}
 
 	return u8ReturnType;
 } // End of Modbus_Read_Device_Identification
 
+/**
+ @struct stBatchQueueMsg_t
+ @brief
+    This structure holds chain of batch requests posted in one queue message
+*/
+typedef struct
+{
+	int32_t m_i32Ctx;							// context of requests
+	long m_lPriority;							// priority of requests
+	stMbusPacketVariables_t *m_pstFirst;		// first request of chain
+	stMbusPacketVariables_t *m_pstLast;			// last request of chain
+}stBatchQueueMsg_t;
+
+/**
+ * @fn static uint8_t getBatchReqByteCount(const stMbusBatchReq_t *a_pstReq)
+ *
+ * @brief This function gets byte count of data field of a batch request.
+ *
+ * @param a_pstReq [in] const stMbusBatchReq_t* request of batch
+ *
+ * @return uint8_t [out] byte count of values to write; 0 for requests without byte count
+ */
+static uint8_t getBatchReqByteCount(const stMbusBatchReq_t *a_pstReq)
+{
+	if(WRITE_MULTIPLE_COILS == a_pstReq->m_u8FunctionCode)
+	{
+		return (0 != (a_pstReq->m_u16Quantity%8))?((a_pstReq->m_u16Quantity/8)+1):
+				(a_pstReq->m_u16Quantity/8);
+	}
+	if(WRITE_MULTIPLE_REG == a_pstReq->m_u8FunctionCode)
+	{
+		return ((a_pstReq->m_u16Quantity * 2) > 246)?246:(a_pstReq->m_u16Quantity * 2);
+	}
+	return 0;
+} // End of getBatchReqByteCount
+
+/**
+ * @fn static t_Status verifyBatchReq(const stMbusBatchReq_t *a_pstReq)
+ *
+ * @brief This function validates a request of batch in the same way as the API
+ * of its function code does.
+ *
+ * @param a_pstReq [in] const stMbusBatchReq_t* request of batch
+ *
+ * @return t_Status [out] STS_MBUS_STACK_NO_ERROR if request is valid;
+ * 						  STS_MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER otherwise
+ */
+static t_Status verifyBatchReq(const stMbusBatchReq_t *a_pstReq)
+{
+	switch(a_pstReq->m_u8FunctionCode)
+	{
+		case READ_COIL_STATUS:
+		case READ_INPUT_STATUS:
+		case READ_HOLDING_REG:
+		case READ_INPUT_REG:
+		case WRITE_SINGLE_COIL:
+		case WRITE_SINGLE_REG:
+			break;
+		case WRITE_MULTIPLE_COILS:
+		case WRITE_MULTIPLE_REG:
+			if(NULL == a_pstReq->m_pu8Data)
+			{
+				return STS_MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER;
+			}
+			break;
+		default:
+			// function code is not supported in batch
+			return STS_MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER;
+	}
+	if(a_pstReq->m_lRespTimeout < 0 || a_pstReq->m_lRespTimeout > MAX_RESP_TIMEOUT_MS)
+	{
+		return STS_MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER;
+	}
+	return InputParameterVerification(a_pstReq->m_u16StartAddr, a_pstReq->m_u16Quantity,
+			a_pstReq->m_u8UnitId, a_pstReq->m_pFunCallBack, a_pstReq->m_u8FunctionCode,
+			getBatchReqByteCount(a_pstReq));
+} // End of verifyBatchReq
+
+/**
+ * @fn static t_Status encodeBatchReq(const stMbusBatchReq_t *a_pstReq,
+ * 		stMbusPacketVariables_t *pstMBusRequesPacket)
+ *
+ * @brief This function creates Modbus request of a batch request in its request node.
+ * Request is encoded in the same format as the API of its function code does.
+ *
+ * @param a_pstReq 				[in] const stMbusBatchReq_t* validated request of batch
+ * @param pstMBusRequesPacket 	[in] stMbusPacketVariables_t* request node emplaced for request
+ *
+ * @return t_Status [out] STS_MBUS_STACK_NO_ERROR if request is encoded;
+ * 						  STS_MBUS_STACK_ERROR_PACKET_LENGTH_EXCEEDED if request is too long
+ */
+static t_Status encodeBatchReq(const stMbusBatchReq_t *a_pstReq,
+		stMbusPacketVariables_t *pstMBusRequesPacket)
+{
+	uint16_t u16PacketIndex = 0;
+	uint16_t u16HeaderLength = 0;
+	uint8_t u8ByteCount = getBatchReqByteCount(a_pstReq);
+	uint16_t u16Count = 0;
+	stEndianess_t stEndianess = { 0 };
+
+	pstMBusRequesPacket->m_u16AppTxID = a_pstReq->m_u16TransacID;
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+	u16HeaderLength = (0 != u8ByteCount) ? (7 + u8ByteCount) : 6;
+#endif
+	u16PacketIndex = CreateHeaderForModbusRequest(	a_pstReq->m_u16StartAddr,
+													a_pstReq->m_u8UnitId,
+													u16HeaderLength,
+													REQ_HOT_META(pstMBusRequesPacket)->m_u16TransactionID,
+													a_pstReq->m_u8FunctionCode,
+													pstMBusRequesPacket);
+
+	// quantity, or value for single writes
+	stEndianess.u16word = a_pstReq->m_u16Quantity;
+	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] =
+			stEndianess.stByteOrder.u8SecondByte;
+	pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] =
+			stEndianess.stByteOrder.u8FirstByte;
+
+	if(WRITE_MULTIPLE_COILS == a_pstReq->m_u8FunctionCode)
+	{
+		pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] = u8ByteCount;
+		if((u16PacketIndex + u8ByteCount) >= TCP_MODBUS_ADU_LENGTH)
+		{
+			return STS_MBUS_STACK_ERROR_PACKET_LENGTH_EXCEEDED;
+		}
+		memcpy_s(&pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex],
+				TCP_MODBUS_ADU_LENGTH - u16PacketIndex, a_pstReq->m_pu8Data, u8ByteCount);
+		u16PacketIndex += u8ByteCount;
+	}
+	else if(WRITE_MULTIPLE_REG == a_pstReq->m_u8FunctionCode)
+	{
+		const uint16_t *pu16OutputVal = (const uint16_t *)a_pstReq->m_pu8Data;
+		pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] = u8ByteCount;
+		if((u16PacketIndex + (a_pstReq->m_u16Quantity * 2)) >= TCP_MODBUS_ADU_LENGTH)
+		{
+			return STS_MBUS_STACK_ERROR_PACKET_LENGTH_EXCEEDED;
+		}
+		for(u16Count = 0; u16Count < a_pstReq->m_u16Quantity; u16Count++)
+		{
+			stEndianess.u16word = pu16OutputVal[u16Count];
+			pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] =
+					stEndianess.stByteOrder.u8SecondByte;
+			pstMBusRequesPacket->m_stMbusTxData.m_au8DataFields[u16PacketIndex++] =
+					stEndianess.stByteOrder.u8FirstByte;
+		}
+	}
+
+	pstMBusRequesPacket->m_stMbusTxData.m_u16Length = (u16PacketIndex);
+	pstMBusRequesPacket->pFunc = a_pstReq->m_pFunCallBack;
+#ifndef MODBUS_STACK_TCPIP_ENABLED
+	pstMBusRequesPacket->m_u8ReceivedDestination = a_pstReq->m_u8UnitId;
+#endif
+	pstMBusRequesPacket->m_u16StartAdd = a_pstReq->m_u16StartAddr;
+	pstMBusRequesPacket->m_u16Quantity = a_pstReq->m_u16Quantity;
+	pstMBusRequesPacket->m_lPriority = a_pstReq->m_lPriority;
+	pstMBusRequesPacket->m_pstBatchNext = NULL;
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+	// request timeout overrides timeout of context
+	if(a_pstReq->m_lRespTimeout > 0)
+	{
+		pstMBusRequesPacket->m_u32RespTimeoutMs = (uint32_t)a_pstReq->m_lRespTimeout;
+	}
+#endif
+
+	return STS_MBUS_STACK_NO_ERROR;
+} // End of encodeBatchReq
+
+/**
+ * @fn MODBUS_STACK_EXPORT t_Status Modbus_Submit_Batch(stMbusBatchReq_t *pstReqs,
+ * 		uint32_t u32Count, uint32_t *pu32Submitted)
+ *
+ * @brief Exported API to submit multiple requests, for any supported function codes and
+ * contexts, in one call.
+ *
+ * Function captures the current time as receive time of all requests and validates every
+ * request. Request nodes for all valid requests are then taken from request manager in one
+ * pass and each request is encoded in its node. Requests with same context and priority are
+ * chained and posted in the message queue of the context as a single message, so that a
+ * thousand requests to a device cost one message queue operation instead of a thousand.
+ *
+ * Status of every request is given in its m_eStatus. A request which fails does not stop
+ * submission of other requests. Requests of a batch do not wait for admission; a request for
+ * which no request node is available, or whose context queue is full, fails with
+ * STS_MBUS_STACK_ERROR_MAX_REQ_SENT.
+ *
+ * @param pstReqs 		[in,out] stMbusBatchReq_t* array of requests to submit
+ * @param u32Count 		[in] uint32_t number of requests in pstReqs
+ * @param pu32Submitted [out] uint32_t* number of requests submitted successfully, can be NULL
+ *
+ * @return t_Status		[out] MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER if pstReqs is NULL or
+ * 								  u32Count is 0 or more than maximum request pool size
+ * 							  MBUS_STACK_ERROR_MALLOC_FAILED if memory to process batch can
+ * 							  	  not be allocated
+ *							  MBUS_STACK_NO_ERROR if batch is processed; status of each request
+ *							  	  is in its m_eStatus
+ *
+ */
+MODBUS_STACK_EXPORT t_Status Modbus_Submit_Batch(stMbusBatchReq_t *pstReqs,
+		uint32_t u32Count,
+		uint32_t *pu32Submitted)
+{
+	stMbusPacketVariables_t **ppstNodes = NULL;
+	stBatchQueueMsg_t *pstMsgs = NULL;
+	uint32_t u32MsgCount = 0;
+	uint32_t u32Index = 0;
+	uint32_t u32Msg = 0;
+	uint32_t u32Submitted = 0;
+	t_Status eStatus = STS_MBUS_STACK_NO_ERROR;
+	Post_Thread_Msg_t stPostThreadMsg = { 0 };
+	struct timespec tsReqRcvd = (struct timespec){0};
+
+	// Init req rcvd timestamp
+	timespec_get(&tsReqRcvd, TIME_UTC);
+
+	if(NULL != pu32Submitted)
+	{
+		*pu32Submitted = 0;
+	}
+	if(NULL == pstReqs || 0 == u32Count || u32Count > MAX_REQ_POOL_SIZE)
+	{
+		return STS_MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER;
+	}
+
+	ppstNodes = OSAL_Malloc(u32Count * sizeof(stMbusPacketVariables_t *));
+	pstMsgs = OSAL_Malloc(u32Count * sizeof(stBatchQueueMsg_t));
+	if(NULL == ppstNodes || NULL == pstMsgs)
+	{
+		OSAL_Free(ppstNodes);
+		OSAL_Free(pstMsgs);
+		return STS_MBUS_STACK_ERROR_MALLOC_FAILED;
+	}
+
+	for(u32Index = 0; u32Index < u32Count; u32Index++)
+	{
+		pstReqs[u32Index].m_eStatus = verifyBatchReq(&pstReqs[u32Index]);
+	}
+
+	// take request nodes for whole batch
+	emplaceNewRequestBatch(tsReqRcvd, pstReqs, u32Count, ppstNodes);
+
+	// encode requests and chain them per context and priority
+	for(u32Index = 0; u32Index < u32Count; u32Index++)
+	{
+		stMbusPacketVariables_t *pstMBusRequesPacket = ppstNodes[u32Index];
+		if(NULL == pstMBusRequesPacket)
+		{
+			continue;
+		}
+		pstReqs[u32Index].m_eStatus = encodeBatchReq(&pstReqs[u32Index], pstMBusRequesPacket);
+		if(STS_MBUS_STACK_NO_ERROR != pstReqs[u32Index].m_eStatus)
+		{
+			freeReqNode(pstMBusRequesPacket);
+			ppstNodes[u32Index] = NULL;
+			continue;
+		}
+		for(u32Msg = 0; u32Msg < u32MsgCount; u32Msg++)
+		{
+			if(pstMsgs[u32Msg].m_i32Ctx == pstReqs[u32Index].m_i32Ctx &&
+					pstMsgs[u32Msg].m_lPriority == pstReqs[u32Index].m_lPriority)
+			{
+				break;
+			}
+		}
+		if(u32Msg == u32MsgCount)
+		{
+			pstMsgs[u32Msg].m_i32Ctx = pstReqs[u32Index].m_i32Ctx;
+			pstMsgs[u32Msg].m_lPriority = pstReqs[u32Index].m_lPriority;
+			pstMsgs[u32Msg].m_pstFirst = pstMBusRequesPacket;
+			u32MsgCount++;
+		}
+		else
+		{
+			pstMsgs[u32Msg].m_pstLast->m_pstBatchNext = pstMBusRequesPacket;
+		}
+		pstMsgs[u32Msg].m_pstLast = pstMBusRequesPacket;
+	}
+
+	// Post each chain into message queue of its context
+	for(u32Msg = 0; u32Msg < u32MsgCount; u32Msg++)
+	{
+		stPostThreadMsg.idThread = pstMsgs[u32Msg].m_i32Ctx;
+		stPostThreadMsg.lParam = pstMsgs[u32Msg].m_pstFirst;
+		stPostThreadMsg.wParam = NULL;
+		stPostThreadMsg.MsgType = pstMsgs[u32Msg].m_lPriority;
+		eStatus = postNewRequest(&stPostThreadMsg);
+		if(STS_MBUS_STACK_NO_ERROR == eStatus)
+		{
+			continue;
+		}
+		// chain is not posted, fail all its requests
+		for(u32Index = 0; u32Index < u32Count; u32Index++)
+		{
+			if(NULL != ppstNodes[u32Index] &&
+					pstReqs[u32Index].m_i32Ctx == pstMsgs[u32Msg].m_i32Ctx &&
+					pstReqs[u32Index].m_lPriority == pstMsgs[u32Msg].m_lPriority)
+			{
+				pstReqs[u32Index].m_eStatus = eStatus;
+				freeReqNode(ppstNodes[u32Index]);
+				ppstNodes[u32Index] = NULL;
+			}
+		}
+	}
+
+	for(u32Index = 0; u32Index < u32Count; u32Index++)
+	{
+		if(STS_MBUS_STACK_NO_ERROR == pstReqs[u32Index].m_eStatus)
+		{
+			u32Submitted++;
+		}
+	}
+	if(NULL != pu32Submitted)
+	{
+		*pu32Submitted = u32Submitted;
+	}
+	OSAL_Free(ppstNodes);
+	OSAL_Free(pstMsgs);
+
+	return STS_MBUS_STACK_NO_ERROR;
+} // End of Modbus_Submit_Batch
+
 #ifndef MODBUS_STACK_TCPIP_ENABLED
 /**
  * @fn bool validateBaudRate(uint32_t nBaudRate)
@@ -2428,8 +2952,10 @@ bool validateBaudRate(uint32_t nBaudRate)
 MODBUS_STACK_EXPORT t_Status getCtx(int32_t *pCtx, stCtxInfo *pCtxInfo)
 {
 	t_Status retError = STS_MBUS_STACK_NO_ERROR;
+#ifndef MODBUS_STACK_TCPIP_ENABLED
 	thread_Create_t stThreadParam = { 0 };
 	Thread_H threadId;
+#endif
 	stLiveSerSessionList_t *pstLivSerSesslist = NULL;
 	uint8_t u8NewDevEntryFalg = 0;
 
@@ -2437,6 +2963,12 @@ MODBUS_STACK_EXPORT t_Status getCtx(int32_t *pCtx, stCtxInfo *pCtxInfo)
 	{
 		return STS_MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER;
 	}
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+	if(pCtxInfo->m_lRespTimeout < 0 || pCtxInfo->m_lRespTimeout > MAX_RESP_TIMEOUT_MS)
+	{
+		return STS_MBUS_STACK_ERROR_INVALID_INPUT_PARAMETER;
+	}
+#endif
 
 #ifndef MODBUS_STACK_TCPIP_ENABLED
 	int nPortNameLen = strnlen_s((const char*)pCtxInfo->m_u8PortName, MODBUS_DATA_LENGTH);
@@ -2555,19 +3087,50 @@ MODBUS_STACK_EXPORT t_Status getCtx(int32_t *pCtx, stCtxInfo *pCtxInfo)
 			pstLivSerSesslist->m_lInterframeDelay = (pCtxInfo->m_lInterframeDelay) * 1000; // convert to usec
 			pstLivSerSesslist->m_lrespTimeout = (pCtxInfo->m_lRespTimeout) * 1000; // convert to usec
 #endif
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+			// event loop takes requests from queue when its eventfd doorbell rings.
+			// Queue is sized to what device may have in flight, which keeps memory
+			// of a site with many devices small.
+			pstLivSerSesslist->MsgQId = OSAL_Init_Event_Message_Queue(
+					(pCtxInfo->m_u16MaxInFlight > CTX_MSG_QUEUE_SIZE) ?
+							pCtxInfo->m_u16MaxInFlight : CTX_MSG_QUEUE_SIZE);
+#else
 			pstLivSerSesslist->MsgQId = OSAL_Init_Message_Queue();	// generating message Queue id
+#endif
 			if(-1 == pstLivSerSesslist->MsgQId)
 			{
 				retError = STS_MBUS_STACK_ERROR_QUEUE_CREATE;
 			}
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+			else
+			{
+				// give guaranteed share of request nodes, window and response timeout to this
+				// context before event loop serves it, so that no request misses them
+				registerReqCtx(pstLivSerSesslist->MsgQId, (uint32_t)pCtxInfo->m_lRespTimeout,
+						pCtxInfo->m_u16MaxInFlight);
+				// no thread per device, device is served by event loop
+				pstLivSerSesslist->m_ThreadId = 0;
+				pstLivSerSesslist->m_pstReactorSession = addReactorSession(pstLivSerSesslist->MsgQId,
+						pCtxInfo->pu8SerIpAddr, pCtxInfo->u16Port, (uint32_t)pCtxInfo->m_lRespTimeout);
+				if(NULL == pstLivSerSesslist->m_pstReactorSession)
+				{
+					retError = STS_MBUS_STACK_ERROR_QUEUE_CREATE;
+					unregisterReqCtx(pstLivSerSesslist->MsgQId);
+					OSAL_Delete_Message_Queue(pstLivSerSesslist->MsgQId);
+				}
+				else
+				{
+					retError = STS_MBUS_STACK_NO_ERROR;
+					*pCtx = pstLivSerSesslist->MsgQId;
+				}
+			}
+#else
 			else
 			{
+				// give guaranteed share of request nodes to this context before it is served
+				registerReqCtx(pstLivSerSesslist->MsgQId, (uint32_t)pCtxInfo->m_lRespTimeout, 0);
 				stThreadParam.dwStackSize = 0;
-#ifdef MODBUS_STACK_TCPIP_ENABLED
-				stThreadParam.lpStartAddress = ServerSessTcpAndCbThread;
-#else
 				stThreadParam.lpStartAddress = SessionControlThread;
-#endif
 				stThreadParam.lpParameter = (void*)pstLivSerSesslist;
 				stThreadParam.lpThreadId = &SessionControl_ThreadId;
 
@@ -2575,6 +3138,7 @@ MODBUS_STACK_EXPORT t_Status getCtx(int32_t *pCtx, stCtxInfo *pCtxInfo)
 				if(0 == threadId)
 				{
 					retError = STS_MBUS_STACK_ERROR_THREAD_CREATE;
+					unregisterReqCtx(pstLivSerSesslist->MsgQId);
 					OSAL_Delete_Message_Queue(pstLivSerSesslist->MsgQId);
 				}
 				else
@@ -2583,6 +3147,7 @@ MODBUS_STACK_EXPORT t_Status getCtx(int32_t *pCtx, stCtxInfo *pCtxInfo)
 					*pCtx = pstLivSerSesslist->MsgQId;
 				}
 			}
+#endif
 		}
 	} while(0);
 	
@@ -2610,9 +3175,15 @@ MODBUS_STACK_EXPORT t_Status getCtx(int32_t *pCtx, stCtxInfo *pCtxInfo)
 /**
  * @fn MODBUS_STACK_EXPORT eStackErrorCode getTCPCtx(int *tcpCtx, stCtxInfo *pCtxInfo)
  *
- * @brief This function gets called from ModbusApp to get the TCP Context for TCP Communication
+ * @brief This function gets called from ModbusApp to get the TCP Context for TCP Communication.
+ * Response timeout given while creating a context applies to all requests of the device,
+ * unless a request of Modbus_Submit_Batch() gives its own timeout. If maximum requests in
+ * flight is given, requests beyond it wait in context queue till a response or timeout
+ * completes an earlier request of the device.
  *
- * @param pCtxInfo 			[in] uint8_t* Ip address for TCP communication and port number
+ * @param pCtxInfo 			[in] uint8_t* Ip address for TCP communication, port number,
+ * 							response timeout in ms (0 selects response timeout of stack) and
+ * 							maximum requests in flight (0 for no limit)
  * @param tcpCtx 			[out] int* TCP Context based on ip-address and port which will be used for communication
  * @return eStackErrorCode	[out] MODBUS_STACK_EXPORT in case of error in parameters
  * 									  received from ModbusApp
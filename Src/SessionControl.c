@@ -32,6 +32,12 @@
 #include <sys/types.h>
 #include <stdatomic.h>
 #include <sys/epoll.h> // for epoll_create1(), epoll_ctl(), struct epoll_event
+#include <sys/mman.h>
+#include <sys/timerfd.h>
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+#include <poll.h>
+#include <sys/eventfd.h>
+#endif
 #include <time.h>
 #include "SessionControl.h"
 
@@ -68,34 +74,27 @@ struct stResProcessData g_stRespProcess;
 //if Modbus stack communicates with Modbus slave device using TCP mode
 #ifdef MODBUS_STACK_TCPIP_ENABLED
 
-//array of structures containing socket descriptors the have been registered with epoll
-//and data to be read from
-stTcpRecvData_t m_clientAccepted[MAX_DEVICE_PER_SITE] = {{0}};
-
-//initialization of epoll descriptors
-int m_epollFd = 0;
+//event loops serving TCP devices
+static stReactor_t g_astReactor[MAX_REACTORS];
 
-//pointer to structure holding events for registered socket descriptors
-struct epoll_event *m_events = NULL;
+//number of event loops running
+static uint32_t g_u32ReactorCount = 0;
 
-//handle of thread receiving data from socket descriptors continuously using epoll mechanism
-Thread_H EpollRecv_ThreadId = 0;
-
-//handle of mutex to synchronize epoll data
-Mutex_H EPollMutex;
+//policy to assign devices to event loops
+static eReactorAssignPolicy g_eReactorAssign = eReactorLeastLoaded;
 
 //structure to tract timeout requests
 struct stTimeOutTracker g_oTimeOutTracker = {0};
-#endif
 
-//structure to hold data for message queue
-struct stIntDataForQ
-{
-	//message type, must be > 0
-	long m_lType;
-	//message ID
-	unsigned short m_iID;
-};
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+//io_uring operations used by connection handling shared with epoll event loops
+static struct io_uring_sqe* getUringSqe(stReactor_t *a_pstReactor, stReactorSession_t *a_pstSession,
+		eUringOp a_eOp);
+static void armUringRecv(stReactorSession_t *a_pstSession);
+static void armUringSend(stReactorSession_t *a_pstSession);
+static void cancelUringOps(stReactorSession_t *a_pstSession);
+#endif
+#endif
 
 /*
  ===============================================================================
@@ -103,53 +102,141 @@ struct stIntDataForQ
  ===============================================================================
  */
 
+// Helpers to pack/unpack head of the request free-list
+#define REQ_FREE_LIST_INDEX(u64Head) ((uint32_t)((u64Head) & 0xFFFFFFFFu))
+#define REQ_FREE_LIST_TAG(u64Head) ((uint32_t)((u64Head) >> 32))
+#define REQ_FREE_LIST_HEAD(u32Tag, u32Index) ((((uint64_t)(u32Tag)) << 32) | (uint32_t)(u32Index))
+
 /**
- * @fn long getAvailableReqNode(void)
+ * @fn static long popReqNodeFromFreeList(void)
  *
- * @brief This function looks for an available node in request array.
- * It reserves the available node for using this node.
+ * @brief This function pops an available node from the free-list of request array.
+ * The free-list is lock-free. Head carries a tag which is incremented on every update,
+ * so that a pop racing with pop/push of the same node fails the compare-exchange.
  *
  * @param none
- * @return long [out] non-zero node index in long format;
- * 					   -1 in case of error
+ * @return long [out] node index in long format;
+ * 					   -1 if free-list is empty
  *
  */
-long getAvailableReqNode(void)
+static long popReqNodeFromFreeList(void)
 {
-	// default value for last index
-	static long lastIndex = -1;
-	//default value
-	long index = -1;
+	uint64_t u64Head = atomic_load(&g_objReqManager.m_u64FreeListHead);
+	uint64_t u64NewHead = 0;
+	uint32_t u32Index = REQ_FREE_LIST_END;
 
-	// addressed review comment
-	if(0 != Osal_Wait_Mutex(g_objReqManager.m_mutexReqArray))
+	do
 	{
-		// fail to lock mutex
-		return -1;
+		u32Index = REQ_FREE_LIST_INDEX(u64Head);
+		if(REQ_FREE_LIST_END == u32Index)
+		{
+			// No idle node available
+			return -1;
+		}
+		// Next link may be stale if node is popped by other thread meanwhile.
+		// In that case tag of head is changed and compare-exchange fails.
+		u64NewHead = REQ_FREE_LIST_HEAD(REQ_FREE_LIST_TAG(u64Head) + 1,
+				atomic_load_explicit(&g_objReqManager.m_pstReqHot[u32Index].m_u32NextFree,
+						memory_order_relaxed));
+	} while(false == atomic_compare_exchange_weak(&g_objReqManager.m_u64FreeListHead,
+			&u64Head, u64NewHead));
+
+	return (long)u32Index;
+} // End of popReqNodeFromFreeList
+
+/**
+ * @fn static uint32_t popReqNodesFromFreeList(uint32_t a_u32Count, uint32_t *a_pu32First)
+ *
+ * @brief This function pops up to a_u32Count available nodes from the free-list with a
+ * single compare-exchange. Popped nodes stay linked with each other through m_u32NextFree,
+ * link of the last popped node is not valid.
+ * A walk over nodes which are popped by other thread meanwhile is discarded, since tag of
+ * head is changed in that case and compare-exchange fails.
+ *
+ * @param a_u32Count 	[in] uint32_t maximum number of nodes to pop
+ * @param a_pu32First 	[out] uint32_t* index of first popped node
+ * @return uint32_t [out] number of nodes popped;
+ * 						  0 if free-list is empty
+ *
+ */
+static uint32_t popReqNodesFromFreeList(uint32_t a_u32Count, uint32_t *a_pu32First)
+{
+	uint64_t u64Head = atomic_load(&g_objReqManager.m_u64FreeListHead);
+	uint64_t u64NewHead = 0;
+	uint32_t u32Last = REQ_FREE_LIST_END;
+	uint32_t u32Next = REQ_FREE_LIST_END;
+	uint32_t u32Popped = 0;
+
+	if(0 == a_u32Count)
+	{
+		return 0;
 	}
-	//look for the valid node received in request manager array until index reaches maximum value in array
-	for (long iLoop = 0; iLoop < MAX_REQUESTS; iLoop++)
+	do
 	{
-		//Increment the last index until max request hold by the request manager array
-		++lastIndex;
-		if(MAX_REQUESTS == lastIndex)
+		u32Last = REQ_FREE_LIST_INDEX(u64Head);
+		if(REQ_FREE_LIST_END == u32Last)
 		{
-			lastIndex = 0;
+			// No idle node available
+			return 0;
 		}
-		eTransactionState expected = IdleState;
-		//create a pointer assign to the data of last index of array
-		stMbusPacketVariables_t* ptr = &g_objReqManager.m_objReqArray[lastIndex];
-		if(true ==
-			atomic_compare_exchange_strong(&ptr->m_state, &expected, RESERVED))
+		u32Popped = 1;
+		u32Next = atomic_load_explicit(&g_objReqManager.m_pstReqHot[u32Last].m_u32NextFree,
+				memory_order_relaxed);
+		while((u32Popped < a_u32Count) && (u32Next < g_objReqManager.m_u32Mapped))
 		{
-			//If the expected state matches with the state of data in array then return the index
-			index = lastIndex;
-			break;
+			u32Last = u32Next;
+			u32Popped++;
+			u32Next = atomic_load_explicit(&g_objReqManager.m_pstReqHot[u32Last].m_u32NextFree,
+					memory_order_relaxed);
 		}
-	}
-	Osal_Release_Mutex(g_objReqManager.m_mutexReqArray);
-	return index;
-} //End of getAvailableReqNode
+		u64NewHead = REQ_FREE_LIST_HEAD(REQ_FREE_LIST_TAG(u64Head) + 1, u32Next);
+	} while(false == atomic_compare_exchange_weak(&g_objReqManager.m_u64FreeListHead,
+			&u64Head, u64NewHead));
+
+	*a_pu32First = REQ_FREE_LIST_INDEX(u64Head);
+	return u32Popped;
+} // End of popReqNodesFromFreeList
+
+/**
+ * @fn static void pushReqNodesToFreeList(uint32_t a_u32First, uint32_t a_u32Last)
+ *
+ * @brief This function pushes a chain of idle request nodes on the free-list of request array.
+ * Nodes from first to last must already be linked with each other.
+ *
+ * @param a_u32First [in] uint32_t index of first node of the chain
+ * @param a_u32Last  [in] uint32_t index of last node of the chain
+ *
+ * @return none
+ *
+ */
+static void pushReqNodesToFreeList(uint32_t a_u32First, uint32_t a_u32Last)
+{
+	uint64_t u64Head = atomic_load(&g_objReqManager.m_u64FreeListHead);
+	uint64_t u64NewHead = 0;
+
+	do
+	{
+		atomic_store_explicit(&g_objReqManager.m_pstReqHot[a_u32Last].m_u32NextFree,
+				REQ_FREE_LIST_INDEX(u64Head), memory_order_relaxed);
+		u64NewHead = REQ_FREE_LIST_HEAD(REQ_FREE_LIST_TAG(u64Head) + 1, a_u32First);
+	} while(false == atomic_compare_exchange_weak(&g_objReqManager.m_u64FreeListHead,
+			&u64Head, u64NewHead));
+} // End of pushReqNodesToFreeList
+
+/**
+ * @fn static void putReqNodeToFreeList(stMbusPacketVariables_t* a_pObjReqNode)
+ *
+ * @brief This function pushes an idle request node on the free-list of request array.
+ *
+ * @param a_pObjReqNode [in] stMbusPacketVariables_t* pointer to node to add in free-list
+ *
+ * @return none
+ *
+ */
+static void putReqNodeToFreeList(stMbusPacketVariables_t* a_pObjReqNode)
+{
+	pushReqNodesToFreeList(a_pObjReqNode->m_ulMyId, a_pObjReqNode->m_ulMyId);
+} // End of putReqNodeToFreeList
 
 /**
  * @fn void resetReqNode(stMbusPacketVariables_t* a_pObjReqNode)
@@ -165,19 +252,20 @@ void resetReqNode(stMbusPacketVariables_t* a_pObjReqNode)
 {
 	if(NULL != a_pObjReqNode)
 	{
-#ifdef MODBUS_STACK_TCPIP_ENABLED
-		a_pObjReqNode->__next = NULL;
-		a_pObjReqNode->__prev = NULL;
-#endif
+		stReqHotMeta_t *pstHot = REQ_HOT_META(a_pObjReqNode);
+		pstHot->m_i32TimeoutNext = REQ_LINK_NONE;
+		pstHot->m_i32TimeoutPrev = REQ_LINK_NONE;
 		// Initialize timestamps to 0
 		a_pObjReqNode->m_objTimeStamps.tsReqRcvd = (struct timespec){0};
 		a_pObjReqNode->m_objTimeStamps.tsReqSent = (struct timespec){0};
 		a_pObjReqNode->m_objTimeStamps.tsRespRcvd = (struct timespec){0};
 		a_pObjReqNode->m_objTimeStamps.tsRespSent = (struct timespec){0};
-		a_pObjReqNode->m_iTimeOutIndex = -1;
+		pstHot->m_iTimeOutIndex = -1;
+		pstHot->m_i16CtxSlot = -1;
+		pstHot->m_bIsSharedSlot = false;
 
 		// Initialize state to idle state
-		a_pObjReqNode->m_state = IdleState;
+		pstHot->m_state = IdleState;
 	}
 	else
 	{
@@ -186,1513 +274,4330 @@ void resetReqNode(stMbusPacketVariables_t* a_pObjReqNode)
 } //End of resetReqNode
 
 /**
- * @fn bool initReqManager(void)
+ * @fn static size_t getReqPoolBytes(uint32_t a_u32Nodes, size_t a_szNode, bool a_bRoundUp)
  *
- * @brief This function initiates the request manager and data structures within it. The request
- * manager keeps track of requests send to Modbus slave and responses received for those requests.
+ * @brief This function converts number of request nodes to page aligned size in bytes.
  *
- * @param none
+ * @param a_u32Nodes [in] uint32_t number of request nodes
+ * @param a_szNode 	 [in] size_t size of one element of the array
+ * @param a_bRoundUp [in] bool true to round up to page size, false to round down
  *
- * @return bool [out] true if function succeeds in initializing the request manager;
- * 					   false if function fails to initialize the request manager;
+ * @return size_t [out] page aligned size in bytes
  *
  */
-bool initReqManager(void)
+static size_t getReqPoolBytes(uint32_t a_u32Nodes, size_t a_szNode, bool a_bRoundUp)
 {
-	//Initialize count to 0
-	unsigned int iCount = 0;
+	size_t szPage = (size_t)sysconf(_SC_PAGESIZE);
+	size_t szBytes = (size_t)a_u32Nodes * a_szNode;
 
-	// loop until all nodes initialize to default values
-	for (; iCount < MAX_REQUESTS; iCount++)
+	if(a_bRoundUp)
 	{
-		g_objReqManager.m_objReqArray[iCount].m_ulMyId = iCount;
-		// reset request node
-		resetReqNode(&(g_objReqManager.m_objReqArray[iCount]));
+		szBytes += szPage - 1;
 	}
-	// create mutex
-	g_objReqManager.m_mutexReqArray = Osal_Mutex();
-	if(NULL == g_objReqManager.m_mutexReqArray )
-	{
-		return false;
-	}
-	return true;
-} // End of initReqManager
+	return szBytes - (szBytes % szPage);
+} // End of getReqPoolBytes
 
 /**
- * @fn stMbusPacketVariables_t* emplaceNewRequest(const struct timespec tsReqRcvd)
+ * @fn static bool mapReqArrayRange(void *a_pvBase, size_t a_szNode, uint32_t a_u32From, uint32_t a_u32To)
  *
- * @brief This function sets data structure to process new request. It gets the available node
- * from the request manager's list and updates new request at the empty node.
+ * @brief This function makes part of reserved address space of an array accessible.
  *
- * @param tsReqRcvd [in] const struct timespec time-stamp when request was received
- * @return [out] stMbusPacketVariables_t* pointer to emplaced request
- * 				 NULL in case of error
+ * @param a_pvBase 	[in] void* start of reserved address space
+ * @param a_szNode 	[in] size_t size of one element of the array
+ * @param a_u32From [in] uint32_t first element to make accessible
+ * @param a_u32To 	[in] uint32_t element after the last one to make accessible
+ *
+ * @return bool [out] true if function succeeds;
+ * 					  false otherwise
  *
  */
-stMbusPacketVariables_t* emplaceNewRequest(const struct timespec tsReqRcvd)
+static bool mapReqArrayRange(void *a_pvBase, size_t a_szNode, uint32_t a_u32From, uint32_t a_u32To)
 {
-	stMbusPacketVariables_t* ptr = NULL;
-	// Get index of available request node in request array
-	long iCount = getAvailableReqNode();
-	if ((iCount >= 0) && (iCount < MAX_REQUESTS))
+	size_t szStart = getReqPoolBytes(a_u32From, a_szNode, false);
+	size_t szEnd = getReqPoolBytes(a_u32To, a_szNode, true);
+
+	return (0 == mprotect((uint8_t *)a_pvBase + szStart, szEnd - szStart, PROT_READ | PROT_WRITE));
+} // End of mapReqArrayRange
+
+/**
+ * @fn static void unmapReqArrayRange(void *a_pvBase, size_t a_szNode, uint32_t a_u32From, uint32_t a_u32To)
+ *
+ * @brief This function gives memory of part of an array back to the system. Address space
+ * stays accessible and reads as zero.
+ *
+ * @param a_pvBase 	[in] void* start of reserved address space
+ * @param a_szNode 	[in] size_t size of one element of the array
+ * @param a_u32From [in] uint32_t first element to release
+ * @param a_u32To 	[in] uint32_t element after the last one to release
+ *
+ * @return none
+ *
+ */
+static void unmapReqArrayRange(void *a_pvBase, size_t a_szNode, uint32_t a_u32From, uint32_t a_u32To)
+{
+	// pages shared with elements before a_u32From are kept
+	size_t szStart = getReqPoolBytes(a_u32From, a_szNode, true);
+	size_t szEnd = getReqPoolBytes(a_u32To, a_szNode, true);
+
+	if(szEnd > szStart)
 	{
-		eTransactionState expected = RESERVED;
-		ptr = &g_objReqManager.m_objReqArray[iCount];
-		if(true ==
-				atomic_compare_exchange_strong(&ptr->m_state, &expected, REQ_RCVD_FROM_APP))
-		{
-#ifdef MODBUS_STACK_TCPIP_ENABLED
-			ptr->__next = NULL;
-			ptr->__prev = NULL;
-#endif
-			ptr->m_ulMyId = iCount;
+		madvise((uint8_t *)a_pvBase + szStart, szEnd - szStart, MADV_DONTNEED);
+	}
+} // End of unmapReqArrayRange
 
-			// copy the req recvd timestamp
-			memcpy_s(&(ptr->m_objTimeStamps.tsReqRcvd), sizeof(struct timespec),
-					&tsReqRcvd, sizeof(struct timespec));
+/**
+ * @fn static bool commitReqNodes(uint32_t a_u32Count)
+ *
+ * @brief This function commits next chunk of request nodes and puts them on the free-list.
+ * Caller must hold pool mutex or be the only user of request manager.
+ *
+ * @param a_u32Count [in] uint32_t number of request nodes to commit
+ *
+ * @return bool [out] true if nodes are committed;
+ * 					  false if maximum size is reached or memory cannot be committed
+ *
+ */
+static bool commitReqNodes(uint32_t a_u32Count)
+{
+	uint32_t u32First = atomic_load(&g_objReqManager.m_u32Committed);
+	uint32_t u32End = 0;
+	uint32_t u32Index = 0;
 
-			// Init other timestamps to 0
-			ptr->m_objTimeStamps.tsReqSent = (struct timespec){0};
-			ptr->m_objTimeStamps.tsRespRcvd = (struct timespec){0};
-			ptr->m_objTimeStamps.tsRespSent = (struct timespec){0};
+	if(u32First >= g_objReqManager.m_u32MaxSize || 0 == a_u32Count)
+	{
+		return false;
+	}
+	u32End = u32First + a_u32Count;
+	if(u32End > g_objReqManager.m_u32MaxSize)
+	{
+		u32End = g_objReqManager.m_u32MaxSize;
+	}
 
-			ptr->m_iTimeOutIndex = -1;
+	// make new part of reserved address space accessible
+	if(u32End > g_objReqManager.m_u32Mapped)
+	{
+		if(false == mapReqArrayRange(g_objReqManager.m_pstReqArray, sizeof(stMbusPacketVariables_t),
+				g_objReqManager.m_u32Mapped, u32End) ||
+				false == mapReqArrayRange(g_objReqManager.m_pstReqHot, sizeof(stReqHotMeta_t),
+						g_objReqManager.m_u32Mapped, u32End))
+		{
+			perror("Failed to commit memory for request pool");
+			return false;
 		}
+		g_objReqManager.m_u32Mapped = u32End;
 	}
-	return ptr;
-} // End of emplaceNewRequest
+
+	// initialize nodes and link them with each other
+	for (u32Index = u32First; u32Index < u32End; u32Index++)
+	{
+		g_objReqManager.m_pstReqArray[u32Index].m_ulMyId = u32Index;
+		resetReqNode(&(g_objReqManager.m_pstReqArray[u32Index]));
+		atomic_store(&g_objReqManager.m_pstReqHot[u32Index].m_u32NextFree, u32Index + 1);
+	}
+	// nodes are valid for lookup by transaction id before they are available on free-list
+	atomic_store(&g_objReqManager.m_u32Committed, u32End);
+	pushReqNodesToFreeList(u32First, u32End - 1);
+	clock_gettime(CLOCK_MONOTONIC, &g_objReqManager.m_tsLastGrow);
+	return true;
+} // End of commitReqNodes
 
 /**
- * @fn void freeReqNode(stMbusPacketVariables_t* a_pobjReq)
+ * @fn static bool growReqPool(void)
  *
- * @brief This function frees a request node and resets it for use by next requests. This function
- * also releases the request from tracking for timeout.
+ * @brief This function grows the request pool by one chunk when free-list is empty.
  *
- * @param a_pobjReq [in] stMbusPacketVariables_t* request node to mark as free
+ * @param none
  *
- * @return none
+ * @return bool [out] true if free-list may have idle nodes now;
+ * 					  false if pool cannot grow
  *
  */
-void freeReqNode(stMbusPacketVariables_t* a_pobjReq)
+static bool growReqPool(void)
 {
-	// 1. remove the node from timeout tracker in case of TCP
-	// 2. reset the request node elements
-	// 3. mark the index as available
-#ifdef MODBUS_STACK_TCPIP_ENABLED
-	releaseFromTracker(a_pobjReq);
-#endif
-	// reset the structure
-	resetReqNode(a_pobjReq);
-}  //End of freeReqNode
+	bool bRet = false;
+
+	if(eReqPoolFixed == g_objReqManager.m_ePolicy ||
+			atomic_load(&g_objReqManager.m_u32Committed) >= g_objReqManager.m_u32MaxSize)
+	{
+		return false;
+	}
+	if(0 != Osal_Wait_Mutex(g_objReqManager.m_poolMutex))
+	{
+		return false;
+	}
+	// other thread may have grown the pool or freed nodes meanwhile
+	if(REQ_FREE_LIST_END !=
+			REQ_FREE_LIST_INDEX(atomic_load(&g_objReqManager.m_u64FreeListHead)))
+	{
+		bRet = true;
+	}
+	else
+	{
+		bRet = commitReqNodes(g_objReqManager.m_u32ChunkSize);
+	}
+	Osal_Release_Mutex(g_objReqManager.m_poolMutex);
+	return bRet;
+} // End of growReqPool
 
-#ifdef MODBUS_STACK_TCPIP_ENABLED
 /**
- * @fn int getClientIdFromList(int socketID)
+ * @fn static void trimReqPool(void)
  *
- * @brief This function gets client socket id from already established client's list
+ * @brief This function trims the request pool back to its initial size. Pool is trimmed only when
+ * no request is in use and pool has not grown recently. Memory of trimmed nodes is given back
+ * to the system; address space stays reserved and reads as zero.
  *
- * @param socketID [in] int socket id to retrieve from the list
+ * @param none
  *
- * @return int [out] client index from list if client socket id already exists in the list;
- * 					 -1 if client socket id is not in the list
+ * @return none
  *
  */
-int getClientIdFromList(int socketID)
+static void trimReqPool(void)
 {
-	int socketIndex = -1;
+	struct timespec tsNow = (struct timespec){0};
+	uint64_t u64Head = 0;
+	uint32_t u32Committed = 0;
+	uint32_t u32Index = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &tsNow);
+	if(tsNow.tv_sec - g_objReqManager.m_tsLastGrow.tv_sec < REQ_POOL_TRIM_DELAY_SEC)
+	{
+		return;
+	}
+	if(0 != Osal_Wait_Mutex(g_objReqManager.m_poolMutex))
+	{
+		return;
+	}
+	u32Committed = atomic_load(&g_objReqManager.m_u32Committed);
+	if(u32Committed <= g_objReqManager.m_u32InitSize)
+	{
+		Osal_Release_Mutex(g_objReqManager.m_poolMutex);
+		return;
+	}
 
-	for(int i = 0; i < MAX_DEVICE_PER_SITE; i++)
+	// Detach complete free-list so that no node can be taken while pool is trimmed.
+	// Requests count themselves in use before taking a node, so if nothing is in use
+	// after detaching, every node was on the detached list.
+	u64Head = atomic_load(&g_objReqManager.m_u64FreeListHead);
+	while(false == atomic_compare_exchange_weak(&g_objReqManager.m_u64FreeListHead, &u64Head,
+			REQ_FREE_LIST_HEAD(REQ_FREE_LIST_TAG(u64Head) + 1, REQ_FREE_LIST_END)));
+	if(0 != atomic_load(&g_objReqManager.m_iInUse) ||
+			REQ_FREE_LIST_END == REQ_FREE_LIST_INDEX(u64Head))
 	{
-		if(NULL != m_clientAccepted[i].m_pstConRef)
+		// pool is in use again, give detached nodes back
+		if(REQ_FREE_LIST_END != REQ_FREE_LIST_INDEX(u64Head))
 		{
-			if(m_clientAccepted[i].m_pstConRef->m_sockfd == socketID)
+			uint32_t u32Last = REQ_FREE_LIST_INDEX(u64Head);
+			while(REQ_FREE_LIST_END != atomic_load(&g_objReqManager.m_pstReqHot[u32Last].m_u32NextFree))
 			{
-				return i;
+				u32Last = atomic_load(&g_objReqManager.m_pstReqHot[u32Last].m_u32NextFree);
 			}
+			pushReqNodesToFreeList(REQ_FREE_LIST_INDEX(u64Head), u32Last);
 		}
+		Osal_Release_Mutex(g_objReqManager.m_poolMutex);
+		return;
 	}
 
-	return socketIndex;
-} // resetEPollClientDataStruct
+	// nodes beyond initial size are not valid for lookup by transaction id anymore
+	atomic_store(&g_objReqManager.m_u32Committed, g_objReqManager.m_u32InitSize);
+	unmapReqArrayRange(g_objReqManager.m_pstReqArray, sizeof(stMbusPacketVariables_t),
+			g_objReqManager.m_u32InitSize, u32Committed);
+	unmapReqArrayRange(g_objReqManager.m_pstReqHot, sizeof(stReqHotMeta_t),
+			g_objReqManager.m_u32InitSize, u32Committed);
+	// relink remaining nodes in index order
+	for (u32Index = 0; u32Index < g_objReqManager.m_u32InitSize; u32Index++)
+	{
+		atomic_store(&g_objReqManager.m_pstReqHot[u32Index].m_u32NextFree,
+				(u32Index + 1 < g_objReqManager.m_u32InitSize) ? (u32Index + 1) : REQ_FREE_LIST_END);
+	}
+	if(g_objReqManager.m_u32InitSize > 0)
+	{
+		pushReqNodesToFreeList(0, g_objReqManager.m_u32InitSize - 1);
+	}
+	Osal_Release_Mutex(g_objReqManager.m_poolMutex);
+} // End of trimReqPool
 
 /**
- * @fn void resetEPollClientDataStruct(stTcpRecvData_t* clientAccepted)
+ * @fn long getAvailableReqNode(void)
  *
- * @brief This function resets client structure after data is read from the socket.
+ * @brief This function takes an available node from the free-list of request array and
+ * reserves it for use. If free-list is empty, request pool is grown as per its policy.
+ * A node found on free-list which is not idle is owned by another request; it is dropped
+ * from free-list, never handed out, and next node is taken instead.
  *
- * @param clientAccepted [in] stTcpRecvData_t* pointer that holds socket's data received information
+ * @param none
+ * @return long [out] non-zero node index in long format;
+ * 					   -1 in case of error
  *
- * @return [out] none
  */
-void resetEPollClientDataStruct(stTcpRecvData_t* clientAccepted)
+long getAvailableReqNode(void)
 {
-	if(NULL != clientAccepted)
+	for(;;)
 	{
-	clientAccepted->m_bytesRead = 0;
-	clientAccepted->m_bytesToBeRead = 0;
-	clientAccepted->m_len = 0;
-	memset(&clientAccepted->m_readBuffer, 0,
-			sizeof(clientAccepted->m_readBuffer));
+		long lIndex = popReqNodeFromFreeList();
+
+		while(-1 == lIndex && true == growReqPool())
+		{
+			lIndex = popReqNodeFromFreeList();
+		}
+		if(-1 == lIndex)
+		{
+			return -1;
+		}
+
+		// Node is owned by this thread now. Reserve it.
+		eTransactionState expected = IdleState;
+		if(true == atomic_compare_exchange_strong(&g_objReqManager.m_pstReqHot[lIndex].m_state,
+				&expected, RESERVED))
+		{
+			return lIndex;
+		}
+		// owner of node gives it back to free-list when its request completes
+		printf("Error: request node %ld from free-list is not idle, node is dropped\n", lIndex);
 	}
-} // End of resetEPollClientDataStruct
+} //End of getAvailableReqNode
 
 /**
- * @fn bool initEPollData()
+ * @fn bool initReqManager(const stStackInitConfig_t *a_pstConfig)
+ *
+ * @brief This function initiates the request manager and data structures within it. The request
+ * manager keeps track of requests send to Modbus slave and responses received for those requests.
+ * Address space for maximum size of request pool is reserved, and initial size of pool
+ * (or complete pool for fixed policy) is committed.
  *
- * @brief This function initializes data structures needed for epoll operation for receiving TCP data,
- * then creates epoll descriptor and starts a thread to receive data from registered socket
- * descriptors using epoll mechanism.
+ * @param a_pstConfig [in] const stStackInitConfig_t* validated pool configuration
  *
- * @param None
+ * @return bool [out] true if function succeeds in initializing the request manager;
+ * 					   false if function fails to initialize the request manager;
  *
- * @return bool [out] true if function succeeds;
- * 					  false if function fails or in case of errors
  */
-bool initEPollData()
+bool initReqManager(const stStackInitConfig_t *a_pstConfig)
 {
-	//reset client structure after data is read from the socket
-	for(int i = 0; i < MAX_DEVICE_PER_SITE; i++)
+	//Initialize count to 0
+	unsigned int iCount = 0;
+
+	if(NULL == a_pstConfig)
 	{
-		resetEPollClientDataStruct(&m_clientAccepted[i]);
+		return false;
 	}
-
-	//init epoll
-	m_epollFd = epoll_create1(0);
-	if (m_epollFd == -1) {
-		perror("Failed to create epoll file descriptor :: \n");
+	deinitReqManager();
+
+	g_objReqManager.m_u32MaxSize = a_pstConfig->m_u32ReqPoolMaxSize;
+	g_objReqManager.m_u32InitSize = a_pstConfig->m_u32ReqPoolInitSize;
+	g_objReqManager.m_u32ChunkSize = a_pstConfig->m_u32ReqPoolChunkSize;
+	g_objReqManager.m_ePolicy = a_pstConfig->m_eReqPoolPolicy;
+	g_objReqManager.m_u32Mapped = 0;
+	atomic_store(&g_objReqManager.m_u32Committed, 0);
+	atomic_store(&g_objReqManager.m_iInUse, 0);
+	// free-list is empty till nodes are committed
+	atomic_store(&g_objReqManager.m_u64FreeListHead, REQ_FREE_LIST_HEAD(0, REQ_FREE_LIST_END));
+
+	// reserve address space only, memory is committed as pool grows
+	g_objReqManager.m_szReserved = getReqPoolBytes(g_objReqManager.m_u32MaxSize,
+			sizeof(stMbusPacketVariables_t), true);
+	g_objReqManager.m_pstReqArray = mmap(NULL, g_objReqManager.m_szReserved, PROT_NONE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if(MAP_FAILED == g_objReqManager.m_pstReqArray)
+	{
+		perror("Failed to reserve memory for request pool");
+		g_objReqManager.m_pstReqArray = NULL;
 		return false;
 	}
-
-	thread_Create_t stEpollRecvThreadParam = { 0 };
-	stEpollRecvThreadParam.dwStackSize = 0;
-	stEpollRecvThreadParam.lpStartAddress = EpollRecvThread;
-	stEpollRecvThreadParam.lpThreadId = &EpollRecv_ThreadId;
-
-	EpollRecv_ThreadId = Osal_Thread_Create(&stEpollRecvThreadParam);
-	if(-1 == EpollRecv_ThreadId)
+	g_objReqManager.m_szHotReserved = getReqPoolBytes(g_objReqManager.m_u32MaxSize,
+			sizeof(stReqHotMeta_t), true);
+	g_objReqManager.m_pstReqHot = mmap(NULL, g_objReqManager.m_szHotReserved, PROT_NONE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if(MAP_FAILED == g_objReqManager.m_pstReqHot)
 	{
+		perror("Failed to reserve memory for request pool");
+		g_objReqManager.m_pstReqHot = NULL;
+		deinitReqManager();
 		return false;
 	}
-	EPollMutex = Osal_Mutex();
-	if(NULL == EPollMutex)
+	g_objReqManager.m_poolMutex = Osal_Mutex();
+	if(NULL == g_objReqManager.m_poolMutex)
 	{
+		deinitReqManager();
 		return false;
 	}
+	if(false == commitReqNodes((eReqPoolFixed == g_objReqManager.m_ePolicy) ?
+			g_objReqManager.m_u32MaxSize : g_objReqManager.m_u32InitSize))
+	{
+		deinitReqManager();
+		return false;
+	}
+
+	// no context is registered yet
+	for (iCount = 0; iCount < MAX_REQ_CTX_SLOTS; iCount++)
+	{
+		atomic_store(&g_objReqManager.m_objCtxQuota[iCount].m_i32CtxId, REQ_CTX_SLOT_EMPTY);
+		atomic_store(&g_objReqManager.m_objCtxQuota[iCount].m_iInFlight, 0);
+		atomic_store(&g_objReqManager.m_objCtxQuota[iCount].m_iTotalInFlight, 0);
+	}
+	g_objReqManager.m_iGuaranteedTotal =
+			(int)((uint64_t)g_objReqManager.m_u32MaxSize * REQ_GUARANTEED_PERCENT / 100);
 
+	// transaction id keeps as few bits for node index as maximum pool size needs
+	g_objReqManager.m_u32TidIndexBits = 0;
+	while((1u << g_objReqManager.m_u32TidIndexBits) < g_objReqManager.m_u32MaxSize)
+	{
+		g_objReqManager.m_u32TidIndexBits++;
+	}
+	g_objReqManager.m_u32TidIndexMask = (1u << g_objReqManager.m_u32TidIndexBits) - 1;
+	atomic_store(&g_objReqManager.m_u64StaleResp, 0);
+	atomic_store(&g_objReqManager.m_iCtxCount, 0);
+	atomic_store(&g_objReqManager.m_iGuaranteedInUse, 0);
+	atomic_store(&g_objReqManager.m_iSharedInUse, 0);
+	g_objReqManager.m_eAdmissionMode = a_pstConfig->m_eAdmissionMode;
+	g_objReqManager.m_lAdmissionTimeout = a_pstConfig->m_lAdmissionTimeout;
+	atomic_store(&g_objReqManager.m_iAdmitWaiters, 0);
 	return true;
-} // End of initEPollData
+} // End of initReqManager
 
 /**
- * @fn void deinitEPollData(void)
+ * @fn void deinitReqManager(void)
+ *
+ * @brief This function releases memory and mutex of request pool.
  *
- * @brief This function de-initializes data structures related to epoll operation for receiving TCP data.
- * 			It resets all the socket descriptors registered for epoll.
+ * @param none
  *
- * @param None
+ * @return none
  *
- * @return None
  */
-void deinitEPollData(void)
+void deinitReqManager(void)
 {
-	Osal_Thread_Terminate(EpollRecv_ThreadId);
-	//reset client structure after data is read from the socket
-	for(int i = 0; i < MAX_DEVICE_PER_SITE; i++)
+	// requests waiting for admission find stack exiting and fail
+	atomic_fetch_add(&g_objReqManager.m_u32FreeSeq, 1);
+	Osal_Futex_Wake(&g_objReqManager.m_u32FreeSeq, INT32_MAX);
+	if(NULL != g_objReqManager.m_pstReqArray)
 	{
-		resetEPollClientDataStruct(&m_clientAccepted[i]);
-		m_clientAccepted[i].m_pstConRef = NULL;
+		munmap(g_objReqManager.m_pstReqArray, g_objReqManager.m_szReserved);
+		g_objReqManager.m_pstReqArray = NULL;
 	}
-
-	Osal_Close_Mutex(EPollMutex);
-} // End of deinitEPollData
+	if(NULL != g_objReqManager.m_pstReqHot)
+	{
+		munmap(g_objReqManager.m_pstReqHot, g_objReqManager.m_szHotReserved);
+		g_objReqManager.m_pstReqHot = NULL;
+	}
+	if(NULL != g_objReqManager.m_poolMutex)
+	{
+		Osal_Close_Mutex(g_objReqManager.m_poolMutex);
+		g_objReqManager.m_poolMutex = NULL;
+	}
+	g_objReqManager.m_szReserved = 0;
+	g_objReqManager.m_szHotReserved = 0;
+	g_objReqManager.m_u32Mapped = 0;
+	atomic_store(&g_objReqManager.m_u32Committed, 0);
+	atomic_store(&g_objReqManager.m_u64FreeListHead, REQ_FREE_LIST_HEAD(0, REQ_FREE_LIST_END));
+} // End of deinitReqManager
 
 /**
- * @fn void removeEPollRefNoLock(int a_iIndex)
+ * @fn static int getReqCtxSlot(int32_t a_i32Ctx)
+ *
+ * @brief This function finds slot of a context in context quota table.
  *
- * @brief This function removes a socket descriptor registered with with epoll and
- * resets associated data structures.
- * The calling function should have the lock for epoll data structure.
+ * @param a_i32Ctx [in] int32_t context id
  *
- * @param a_iIndex [in] int reference to epoll data structure
+ * @return int [out] index of slot in context quota table;
+ * 					 -1 if context is not registered
  *
- * @return None
  */
-void removeEPollRefNoLock(int a_iIndex)
+static int getReqCtxSlot(int32_t a_i32Ctx)
 {
-	if((a_iIndex >= 0) && (a_iIndex < MAX_DEVICE_PER_SITE))
+	uint32_t u32Index = ((uint32_t)a_i32Ctx * 2654435761u) & (MAX_REQ_CTX_SLOTS - 1);
+	int iProbe = 0;
+
+	for (; iProbe < MAX_REQ_CTX_SLOTS; iProbe++)
 	{
-		// Obtain lock
-		if(NULL != m_clientAccepted[a_iIndex].m_pstConRef)
+		int32_t i32SlotCtx = atomic_load(&g_objReqManager.m_objCtxQuota[u32Index].m_i32CtxId);
+		if(a_i32Ctx == i32SlotCtx)
 		{
-			// remove from epoll
-			struct epoll_event m_event;
-			m_event.events = EPOLLIN;
-			m_event.data.fd = m_clientAccepted[a_iIndex].m_pstConRef->m_sockfd;
-			if (epoll_ctl(m_epollFd, EPOLL_CTL_DEL, m_clientAccepted[a_iIndex].m_pstConRef->m_sockfd, &m_event))
-			{
-				perror("Failed to delete file descriptor from epoll:");
-			}
-			m_clientAccepted[a_iIndex].m_pstConRef = NULL;
+			return (int)u32Index;
+		}
+		if(REQ_CTX_SLOT_EMPTY == i32SlotCtx)
+		{
+			break;
 		}
-		resetEPollClientDataStruct(&m_clientAccepted[a_iIndex]);
-		m_clientAccepted[a_iIndex].m_pstConRef = NULL;
+		u32Index = (u32Index + 1) & (MAX_REQ_CTX_SLOTS - 1);
 	}
-} // End of removeEPollRefNoLock
+	return -1;
+} // End of getReqCtxSlot
 
 /**
- * @fn void removeEPollRef(int a_iIndex)
+ * @fn bool registerReqCtx(int32_t a_i32Ctx, uint32_t a_u32RespTimeoutMs, uint32_t a_u32MaxInFlight)
  *
- * @brief This function removes a socket descriptor from epoll descriptors and
- * resets associated data structures.
- * This function acquires lock for epoll data structure.
+ * @brief This function registers a context with request manager. Each registered context
+ * gets an even part of nodes kept aside for guaranteed shares, which cannot be used by
+ * other contexts; shares of all contexts shrink as more contexts are registered.
+ * Response timeout of the context is
+ * given to every request emplaced for it. In-flight window of the context limits requests
+ * which event loop sends to the device before they complete.
  *
- * @param a_iIndex [in] int Reference to epoll data structure
+ * @param a_i32Ctx [in] int32_t context id
+ * @param a_u32RespTimeoutMs [in] uint32_t response timeout of context in ms, 0 selects
+ * 							 response timeout of stack
+ * @param a_u32MaxInFlight [in] uint32_t maximum requests in flight on device, 0 for no limit
+ *
+ * @return bool [out] true if context is registered or is already registered;
+ * 					  false if context quota table is full
  *
- * @return None
  */
-void removeEPollRef(int a_iIndex)
+bool registerReqCtx(int32_t a_i32Ctx, uint32_t a_u32RespTimeoutMs, uint32_t a_u32MaxInFlight)
 {
-	if((a_iIndex >= 0) && (a_iIndex < MAX_DEVICE_PER_SITE))
+	uint32_t u32Index = ((uint32_t)a_i32Ctx * 2654435761u) & (MAX_REQ_CTX_SLOTS - 1);
+	int iProbe = 0;
+
+	if(a_i32Ctx < 0)
 	{
-		//Osal_Wait_Mutex(EPollMutex);
-		// addressed review comment
-		if(0 != Osal_Wait_Mutex(EPollMutex))
-		{
-			// fail to lock mutex
-			return;
-		}
-		removeEPollRefNoLock(a_iIndex);
-		// addressed review comment
-		if(0 != Osal_Release_Mutex (EPollMutex))
+		return false;
+	}
+	if(-1 != getReqCtxSlot(a_i32Ctx))
+	{
+		return true;
+	}
+	for (; iProbe < MAX_REQ_CTX_SLOTS; iProbe++)
+	{
+		stReqCtxQuota_t *pstQuota = &g_objReqManager.m_objCtxQuota[u32Index];
+		int32_t i32SlotCtx = atomic_load(&pstQuota->m_i32CtxId);
+		if((REQ_CTX_SLOT_EMPTY == i32SlotCtx || REQ_CTX_SLOT_REMOVED == i32SlotCtx) &&
+				atomic_compare_exchange_strong(&pstQuota->m_i32CtxId, &i32SlotCtx, a_i32Ctx))
 		{
-			// fail to unlock mutex
-			return;
+			atomic_store(&pstQuota->m_u32RespTimeoutMs, a_u32RespTimeoutMs);
+			// window usage is kept, requests of a previous context of slot still release it
+			atomic_store(&pstQuota->m_u32Window, a_u32MaxInFlight);
+			atomic_fetch_add(&g_objReqManager.m_iCtxCount, 1);
+			return true;
 		}
-		//printf("Removing ref %d\n", a_iIndex);
+		u32Index = (u32Index + 1) & (MAX_REQ_CTX_SLOTS - 1);
 	}
-} // End of removeEPollRef
+	printf("Error: context quota table is full, context %d uses shared area only\n", a_i32Ctx);
+	return false;
+} // End of registerReqCtx
 
 /**
- * @fn int addtoEPollList(IP_Connect_t *a_pstIPConnect)
+ * @fn void unregisterReqCtx(int32_t a_i32Ctx)
  *
- * @brief This function sets the socket's failure state. It checks if the referenced socket ID and
- * socket ID from the function argument are same or not. If they are different, it removes the
- * socket descriptor from the epoll and resets the structure for next use. If socket IDs are same
- * and getting used for different operation, close the connection. If there is no socket ID with
- * the reference given, reset the socket descriptor.
+ * @brief This function unregisters a context from request manager. Guaranteed share of
+ * the context is given back to other contexts.
  *
- * @param stIPConnect [in] IP_Connect_t* pointer to struct of type IP_Connect_t
+ * @param a_i32Ctx [in] int32_t context id
  *
- * @return [out] none
+ * @return none
  *
  */
-int addtoEPollList(IP_Connect_t *a_pstIPConnect)
+void unregisterReqCtx(int32_t a_i32Ctx)
 {
-	if(NULL != a_pstIPConnect)
+	int iSlot = getReqCtxSlot(a_i32Ctx);
+	int32_t i32SlotCtx = a_i32Ctx;
+
+	if(-1 != iSlot &&
+			atomic_compare_exchange_strong(&g_objReqManager.m_objCtxQuota[iSlot].m_i32CtxId,
+					&i32SlotCtx, REQ_CTX_SLOT_REMOVED))
 	{
-		int ret = -1;
-		// Osal_Wait_Mutex(EPollMutex);
-		// addressed review comment
-		if(0 != Osal_Wait_Mutex(EPollMutex))
-		{
-			// fail to lock mutex
-			return ret;
-		}
-		int index = -1;
-		for(int i = 0; i < MAX_DEVICE_PER_SITE; i++)
-		{
-			// Check if this connection ref is already in list
-			if(m_clientAccepted[i].m_pstConRef == a_pstIPConnect)
-			{
-				if(m_clientAccepted[i].m_pstConRef->m_sockfd == a_pstIPConnect->m_sockfd)
-				{
-					// Ref and socket are same. No action
-				}
-				else
-				{
-					// Sockets are not same. Remove earlier connection
-					removeEPollRefNoLock(i);
-				}
-				index = i;
-				break;
-			}
-			else if(m_clientAccepted[i].m_pstConRef == NULL)
-			{
-				// This is to find first empty node in array
-				if(-1 == index)
-				{
-					index = i;
-				}
-			}
-			else
-			{
-				// Node is not NULL
-				if(m_clientAccepted[i].m_pstConRef->m_sockfd == a_pstIPConnect->m_sockfd)
-				{
-					// Sockets are same but connection references are different.
-					// This should ideally not occur.
-					printf("Error: Socket for EPOLL-ADD is already used for some other connection");
-					removeEPollRefNoLock(i);
-					closeConnection(m_clientAccepted[i].m_pstConRef);
-					ret = -2;
-					break;
-				}
-			}
-		}
+		atomic_fetch_sub(&g_objReqManager.m_iCtxCount, 1);
+	}
+} // End of unregisterReqCtx
 
-		// This fd is not yet added to list
-		if (-1 != index)
-		{
-			resetEPollClientDataStruct(&m_clientAccepted[index]);
-			m_clientAccepted[index].m_pstConRef = NULL;
-			// add to epoll events
-			struct epoll_event m_event;
-			m_event.events = EPOLLIN;
-			m_event.data.fd = a_pstIPConnect->m_sockfd;
-			ret = 0;
-			if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, a_pstIPConnect->m_sockfd, &m_event))
+/**
+ * @fn uint32_t getReqCtxInFlight(int32_t a_i32Ctx)
+ *
+ * @brief This function gets number of request nodes held by a context,
+ * including nodes taken from shared overflow area.
+ *
+ * @param a_i32Ctx [in] int32_t context id
+ *
+ * @return uint32_t [out] request nodes in use by context;
+ * 						  0 if context is not registered
+ *
+ */
+uint32_t getReqCtxInFlight(int32_t a_i32Ctx)
+{
+	int iSlot = getReqCtxSlot(a_i32Ctx);
+	int iInFlight = 0;
+
+	if(-1 == iSlot)
+	{
+		return 0;
+	}
+	iInFlight = atomic_load(&g_objReqManager.m_objCtxQuota[iSlot].m_iTotalInFlight);
+	return (iInFlight > 0) ? (uint32_t)iInFlight : 0;
+} // End of getReqCtxInFlight
+
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+/**
+ * @fn static uint32_t getReqCtxWindowFree(int32_t a_i32Ctx)
+ *
+ * @brief This function gets number of requests which a context can still have in flight
+ * on its device, as limited by in-flight window of the context.
+ *
+ * @param a_i32Ctx [in] int32_t context id
+ *
+ * @return uint32_t [out] free slots of in-flight window;
+ * 						  UINT32_MAX if context has no window
+ *
+ */
+static uint32_t getReqCtxWindowFree(int32_t a_i32Ctx)
+{
+	int iSlot = getReqCtxSlot(a_i32Ctx);
+	uint32_t u32Window = 0;
+	uint32_t u32Used = 0;
+
+	if(-1 == iSlot)
+	{
+		return UINT32_MAX;
+	}
+	u32Window = atomic_load(&g_objReqManager.m_objCtxQuota[iSlot].m_u32Window);
+	if(0 == u32Window)
+	{
+		return UINT32_MAX;
+	}
+	u32Used = atomic_load(&g_objReqManager.m_objCtxQuota[iSlot].m_u32WindowUsed);
+	return (u32Used < u32Window) ? (u32Window - u32Used) : 0;
+} // End of getReqCtxWindowFree
+
+/**
+ * @fn static void chargeReqWindow(stMbusPacketVariables_t *a_pstReq)
+ *
+ * @brief This function takes a slot of in-flight window of its context for a request.
+ * Slot is given back by releaseReqWindow() when request completes.
+ *
+ * @param a_pstReq [in] stMbusPacketVariables_t* request
+ *
+ * @return none
+ *
+ */
+static void chargeReqWindow(stMbusPacketVariables_t *a_pstReq)
+{
+	stReqHotMeta_t *pstHot = REQ_HOT_META(a_pstReq);
+
+	if(pstHot->m_i16CtxSlot >= 0 && false == pstHot->m_bInWindow)
+	{
+		pstHot->m_bInWindow = true;
+		atomic_fetch_add(&g_objReqManager.m_objCtxQuota[pstHot->m_i16CtxSlot].m_u32WindowUsed, 1);
+	}
+} // End of chargeReqWindow
+#endif
+
+/**
+ * @fn static void releaseReqWindow(stMbusPacketVariables_t *a_pstReq)
+ *
+ * @brief This function gives back slot of in-flight window held by a request. If window
+ * of its context was full, consumer of context queue is woken up to take requests which
+ * wait in queue. Requests complete on any thread, timeouts on first event loop.
+ *
+ * @param a_pstReq [in] stMbusPacketVariables_t* completed request
+ *
+ * @return none
+ *
+ */
+static void releaseReqWindow(stMbusPacketVariables_t *a_pstReq)
+{
+	stReqHotMeta_t *pstHot = REQ_HOT_META(a_pstReq);
+	stReqCtxQuota_t *pstQuota = NULL;
+
+	if(false == pstHot->m_bInWindow)
+	{
+		return;
+	}
+	pstHot->m_bInWindow = false;
+	pstQuota = &g_objReqManager.m_objCtxQuota[pstHot->m_i16CtxSlot];
+	if(atomic_fetch_sub(&pstQuota->m_u32WindowUsed, 1) == atomic_load(&pstQuota->m_u32Window))
+	{
+		// queue id of a removed context is not valid, so only a live queue is rung
+		OSAL_Ring_Message_Queue(atomic_load(&pstQuota->m_i32CtxId));
+	}
+} // End of releaseReqWindow
+
+/**
+ * @fn void getReqManagerStats(stMbusStackStats_t *a_pstStats)
+ *
+ * @brief This function fills request pool, response queue and timeout tracker occupancy.
+ * Request nodes are counted by state from hot metadata array. No lock is taken, so
+ * counts are a snapshot of nodes changing state concurrently.
+ *
+ * @param a_pstStats [out] stMbusStackStats_t* statistics to fill
+ *
+ * @return [out] none
+ *
+ */
+void getReqManagerStats(stMbusStackStats_t *a_pstStats)
+{
+	uint32_t u32Committed = 0;
+	uint32_t u32Index = 0;
+	int32_t i32RespQCount = 0;
+	uint32_t u32Dispatcher = 0;
+
+	if(NULL == a_pstStats)
+	{
+		return;
+	}
+
+	a_pstStats->m_u32PoolMaxSize = g_objReqManager.m_u32MaxSize;
+	u32Committed = atomic_load(&g_objReqManager.m_u32Committed);
+	a_pstStats->m_u32PoolCommitted = u32Committed;
+	a_pstStats->m_u32PoolInUse = (uint32_t)atomic_load(&g_objReqManager.m_iInUse);
+
+	for(u32Index = 0; (NULL != g_objReqManager.m_pstReqHot) && (u32Index < u32Committed); u32Index++)
+	{
+		stReqHotMeta_t *pstHot = &g_objReqManager.m_pstReqHot[u32Index];
+		switch(atomic_load(&pstHot->m_state))
+		{
+			case REQ_RCVD_FROM_APP:
+				a_pstStats->m_u32ReqRcvdFromApp++;
+				break;
+			case REQ_PROCESS_ERROR:
+				a_pstStats->m_u32ReqProcessError++;
+				break;
+			case REQ_SENT_ON_NETWORK:
+				a_pstStats->m_u32ReqSentOnNetwork++;
+				break;
+			case RESP_RCVD_FROM_NETWORK:
+				a_pstStats->m_u32RespRcvdFromNetwork++;
+				break;
+			case RESP_TIMEDOUT:
+				a_pstStats->m_u32RespTimedOut++;
+				break;
+			case RESP_ERROR:
+				a_pstStats->m_u32RespError++;
+				break;
+			case RESP_SENT_TO_APP:
+				a_pstStats->m_u32RespSentToApp++;
+				break;
+			case RESERVED:
+				a_pstStats->m_u32Reserved++;
+				break;
+			case IdleState:
+			default:
+				a_pstStats->m_u32Idle++;
+				break;
+		}
+		if(pstHot->m_iTimeOutIndex >= 0)
+		{
+			a_pstStats->m_u32TimeoutTracked++;
+		}
+	}
+
+	a_pstStats->m_u32RespQueueDepth = 0;
+	for(u32Dispatcher = 0; u32Dispatcher < g_stRespProcess.m_u32DispatcherCount; u32Dispatcher++)
+	{
+		i32RespQCount = OSAL_Get_Message_Count(
+				g_stRespProcess.m_astDispatcher[u32Dispatcher].m_i32RespMsgQueId);
+		if(i32RespQCount > 0)
+		{
+			a_pstStats->m_u32RespQueueDepth += (uint32_t)i32RespQCount;
+		}
+	}
+	a_pstStats->m_u64StaleResp = atomic_load(&g_objReqManager.m_u64StaleResp);
+} // End of getReqManagerStats
+
+/**
+ * @fn static bool acquireReqQuota(int32_t a_i32Ctx, int *a_piSlot, bool *a_pbIsShared)
+ *
+ * @brief This function charges a new request to a context. Guaranteed share of the context
+ * is used first; once it is used up, request is charged to shared overflow area. Share of a
+ * context is taken only while nodes kept aside for guaranteed shares are not used up, since
+ * contexts may still hold more than their share after other contexts are registered.
+ *
+ * @param a_i32Ctx 		[in] int32_t context id
+ * @param a_piSlot 		[out] int* slot of context in quota table, -1 if context is not registered
+ * @param a_pbIsShared 	[out] bool* true if request is charged to shared overflow area
+ *
+ * @return bool [out] true if quota is available;
+ * 					  false if context has used its share and shared overflow area is full
+ *
+ */
+static bool acquireReqQuota(int32_t a_i32Ctx, int *a_piSlot, bool *a_pbIsShared)
+{
+	int iSlot = getReqCtxSlot(a_i32Ctx);
+	int iUsed = 0;
+	int iCtxCount = atomic_load(&g_objReqManager.m_iCtxCount);
+	int iShare = 0;
+	int iSharedSize = (int)g_objReqManager.m_u32MaxSize - g_objReqManager.m_iGuaranteedTotal;
+
+	*a_piSlot = iSlot;
+	*a_pbIsShared = false;
+	if(-1 != iSlot)
+	{
+		_Atomic int *piInFlight = &g_objReqManager.m_objCtxQuota[iSlot].m_iInFlight;
+		iShare = g_objReqManager.m_iGuaranteedTotal / ((iCtxCount > 0) ? iCtxCount : 1);
+		if(0 == iShare)
+		{
+			iShare = 1;
+		}
+		iUsed = atomic_load(piInFlight);
+		while(iUsed < iShare)
+		{
+			if(atomic_compare_exchange_weak(piInFlight, &iUsed, iUsed + 1))
+			{
+				// nodes kept aside may be held by contexts above their share
+				if(atomic_fetch_add(&g_objReqManager.m_iGuaranteedInUse, 1) < g_objReqManager.m_iGuaranteedTotal)
+				{
+					atomic_fetch_add(&g_objReqManager.m_objCtxQuota[iSlot].m_iTotalInFlight, 1);
+					return true;
+				}
+				atomic_fetch_sub(&g_objReqManager.m_iGuaranteedInUse, 1);
+				atomic_fetch_sub(piInFlight, 1);
+				break;
+			}
+		}
+	}
+
+	// guaranteed share is used up, try shared overflow area
+	iUsed = atomic_load(&g_objReqManager.m_iSharedInUse);
+	while(iUsed < iSharedSize)
+	{
+		if(atomic_compare_exchange_weak(&g_objReqManager.m_iSharedInUse, &iUsed, iUsed + 1))
+		{
+			*a_pbIsShared = true;
+			if(-1 != iSlot)
+			{
+				atomic_fetch_add(&g_objReqManager.m_objCtxQuota[iSlot].m_iTotalInFlight, 1);
+			}
+			return true;
+		}
+	}
+	return false;
+} // End of acquireReqQuota
+
+/**
+ * @fn static void releaseReqQuota(int a_iSlot, bool a_bIsShared)
+ *
+ * @brief This function gives back quota charged by acquireReqQuota().
+ *
+ * @param a_iSlot 		[in] int slot of context in quota table, -1 if none
+ * @param a_bIsShared 	[in] bool true if request was charged to shared overflow area
+ *
+ * @return none
+ *
+ */
+static void releaseReqQuota(int a_iSlot, bool a_bIsShared)
+{
+	if(a_bIsShared)
+	{
+		atomic_fetch_sub(&g_objReqManager.m_iSharedInUse, 1);
+	}
+	else if(a_iSlot >= 0 && a_iSlot < MAX_REQ_CTX_SLOTS)
+	{
+		atomic_fetch_sub(&g_objReqManager.m_objCtxQuota[a_iSlot].m_iInFlight, 1);
+		atomic_fetch_sub(&g_objReqManager.m_iGuaranteedInUse, 1);
+	}
+	if(a_iSlot >= 0 && a_iSlot < MAX_REQ_CTX_SLOTS)
+	{
+		atomic_fetch_sub(&g_objReqManager.m_objCtxQuota[a_iSlot].m_iTotalInFlight, 1);
+	}
+} // End of releaseReqQuota
+
+/**
+ * @fn static stMbusPacketVariables_t* initNewRequest(long a_lIndex, const struct timespec tsReqRcvd,
+ * 		int a_iCtxSlot, bool a_bIsShared)
+ *
+ * @brief This function prepares a node taken from free-list for a new request. It gives next
+ * transaction id to the node and records quota charged for the request.
+ *
+ * @param a_lIndex 		[in] long index of node taken from free-list
+ * @param tsReqRcvd 	[in] const struct timespec time-stamp when request was received
+ * @param a_iCtxSlot 	[in] int slot of context in quota table
+ * @param a_bIsShared 	[in] bool true if request is charged to shared overflow area
+ * @return [out] stMbusPacketVariables_t* pointer to new request
+ * 				 NULL if node is not in reserved state
+ *
+ */
+static stMbusPacketVariables_t* initNewRequest(long a_lIndex, const struct timespec tsReqRcvd,
+		int a_iCtxSlot, bool a_bIsShared)
+{
+	stMbusPacketVariables_t* ptr = NULL;
+	eTransactionState expected = RESERVED;
+	stReqHotMeta_t *pstHot = &g_objReqManager.m_pstReqHot[a_lIndex];
+
+	if(false ==
+			atomic_compare_exchange_strong(&pstHot->m_state, &expected, REQ_RCVD_FROM_APP))
+	{
+		return NULL;
+	}
+	ptr = &g_objReqManager.m_pstReqArray[a_lIndex];
+	ptr->m_pstBatchNext = NULL;
+	pstHot->m_i32TimeoutNext = REQ_LINK_NONE;
+	pstHot->m_i32TimeoutPrev = REQ_LINK_NONE;
+	ptr->m_ulMyId = a_lIndex;
+	pstHot->m_i16CtxSlot = (int16_t)a_iCtxSlot;
+	pstHot->m_bIsSharedSlot = a_bIsShared;
+	pstHot->m_bInWindow = false;
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+	// request gets response timeout of its context
+	ptr->m_u32RespTimeoutMs = (a_iCtxSlot >= 0) ?
+			atomic_load(&g_objReqManager.m_objCtxQuota[a_iCtxSlot].m_u32RespTimeoutMs) : 0;
+	// connection is set when request is sent
+	ptr->m_pstConn = NULL;
+#endif
+	// next generation of the node; upper bits which do not fit in 16 bits are dropped
+	pstHot->m_u16TransactionID = (uint16_t)(
+			((((uint32_t)pstHot->m_u16TransactionID >> g_objReqManager.m_u32TidIndexBits) + 1)
+					<< g_objReqManager.m_u32TidIndexBits) | (uint32_t)a_lIndex);
+
+	// copy the req recvd timestamp
+	memcpy_s(&(ptr->m_objTimeStamps.tsReqRcvd), sizeof(struct timespec),
+			&tsReqRcvd, sizeof(struct timespec));
+
+	// Init other timestamps to 0
+	ptr->m_objTimeStamps.tsReqSent = (struct timespec){0};
+	ptr->m_objTimeStamps.tsRespRcvd = (struct timespec){0};
+	ptr->m_objTimeStamps.tsRespSent = (struct timespec){0};
+
+	pstHot->m_iTimeOutIndex = -1;
+	return ptr;
+} // End of initNewRequest
+
+/**
+ * @fn static void putBackReqNode(uint32_t a_u32Index)
+ *
+ * @brief This function gives back a node reserved by this thread which could not be set
+ * up for a request. Node is made idle again and is not counted in use any more. Node
+ * which is not in reserved state is owned by someone else and is left untouched.
+ *
+ * @param a_u32Index [in] uint32_t index of node
+ * @return none
+ *
+ */
+static void putBackReqNode(uint32_t a_u32Index)
+{
+	eTransactionState expected = RESERVED;
+
+	if(true == atomic_compare_exchange_strong(&g_objReqManager.m_pstReqHot[a_u32Index].m_state,
+			&expected, IdleState))
+	{
+		pushReqNodesToFreeList(a_u32Index, a_u32Index);
+	}
+	atomic_fetch_sub(&g_objReqManager.m_iInUse, 1);
+} // End of putBackReqNode
+
+/**
+ * @fn static stMbusPacketVariables_t* tryEmplaceNewRequest(const struct timespec tsReqRcvd,
+ * 		int32_t a_i32Ctx)
+ *
+ * @brief This function sets data structure to process new request. It charges the request
+ * to quota of the context, gets the available node from the request manager's list and
+ * updates new request at the empty node.
+ *
+ * @param tsReqRcvd [in] const struct timespec time-stamp when request was received
+ * @param a_i32Ctx 	[in] int32_t context on which request is to be sent
+ * @return [out] stMbusPacketVariables_t* pointer to emplaced request
+ * 				 NULL in case of error or if quota of context is used up
+ *
+ */
+static stMbusPacketVariables_t* tryEmplaceNewRequest(const struct timespec tsReqRcvd, int32_t a_i32Ctx)
+{
+	stMbusPacketVariables_t* ptr = NULL;
+	int iCtxSlot = -1;
+	bool bIsShared = false;
+
+	if(false == acquireReqQuota(a_i32Ctx, &iCtxSlot, &bIsShared))
+	{
+		return NULL;
+	}
+	// Count node in use before taking it, so that pool is not trimmed meanwhile
+	atomic_fetch_add(&g_objReqManager.m_iInUse, 1);
+	// Get index of available request node in request array
+	long iCount = getAvailableReqNode();
+	if(-1 == iCount)
+	{
+		atomic_fetch_sub(&g_objReqManager.m_iInUse, 1);
+	}
+	if ((iCount >= 0) && (iCount < (long)g_objReqManager.m_u32MaxSize))
+	{
+		ptr = initNewRequest(iCount, tsReqRcvd, iCtxSlot, bIsShared);
+		if(NULL == ptr)
+		{
+			putBackReqNode((uint32_t)iCount);
+		}
+	}
+	if(NULL == ptr)
+	{
+		releaseReqQuota(iCtxSlot, bIsShared);
+	}
+	return ptr;
+} // End of tryEmplaceNewRequest
+
+/**
+ * @fn stMbusPacketVariables_t* emplaceNewRequest(const struct timespec tsReqRcvd, int32_t a_i32Ctx)
+ *
+ * @brief This function sets data structure to process new request. If no request node can be
+ * taken because pool or quota of the context is used up, function fails immediately or waits
+ * for a node to be freed as per admission mode of the stack. A waiting caller sleeps until
+ * freeReqNode() wakes it, no CPU is used meanwhile.
+ *
+ * @param tsReqRcvd [in] const struct timespec time-stamp when request was received
+ * @param a_i32Ctx 	[in] int32_t context on which request is to be sent
+ * @return [out] stMbusPacketVariables_t* pointer to emplaced request
+ * 				 NULL in case of error, or if no node is available within admission timeout
+ *
+ */
+stMbusPacketVariables_t* emplaceNewRequest(const struct timespec tsReqRcvd, int32_t a_i32Ctx)
+{
+	stMbusPacketVariables_t* ptr = NULL;
+	struct timespec tsDeadline = {0};
+	struct timespec tsNow = {0};
+	struct timespec tsWait = {0};
+	uint32_t u32Seq = 0;
+
+	ptr = tryEmplaceNewRequest(tsReqRcvd, a_i32Ctx);
+	if((NULL != ptr) || (eReqAdmitFailFast == g_objReqManager.m_eAdmissionMode))
+	{
+		return ptr;
+	}
+
+	if(eReqAdmitTimedWait == g_objReqManager.m_eAdmissionMode)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &tsDeadline);
+		tsDeadline.tv_sec += g_objReqManager.m_lAdmissionTimeout / 1000;
+		tsDeadline.tv_nsec += (g_objReqManager.m_lAdmissionTimeout % 1000) * 1000000L;
+		if(tsDeadline.tv_nsec >= 1000000000L)
+		{
+			tsDeadline.tv_sec++;
+			tsDeadline.tv_nsec -= 1000000000L;
+		}
+	}
+
+	atomic_fetch_add(&g_objReqManager.m_iAdmitWaiters, 1);
+	while(false == g_bThreadExit)
+	{
+		// sequence is read before retrying, so a node freed after the retry
+		// changes it and wait below returns immediately
+		u32Seq = atomic_load(&g_objReqManager.m_u32FreeSeq);
+		ptr = tryEmplaceNewRequest(tsReqRcvd, a_i32Ctx);
+		if(NULL != ptr)
+		{
+			break;
+		}
+		if(eReqAdmitTimedWait == g_objReqManager.m_eAdmissionMode)
+		{
+			clock_gettime(CLOCK_MONOTONIC, &tsNow);
+			tsWait.tv_sec = tsDeadline.tv_sec - tsNow.tv_sec;
+			tsWait.tv_nsec = tsDeadline.tv_nsec - tsNow.tv_nsec;
+			if(tsWait.tv_nsec < 0)
+			{
+				tsWait.tv_sec--;
+				tsWait.tv_nsec += 1000000000L;
+			}
+			if(tsWait.tv_sec < 0)
+			{
+				// admission timeout
+				break;
+			}
+			Osal_Futex_Wait(&g_objReqManager.m_u32FreeSeq, u32Seq, &tsWait);
+		}
+		else
+		{
+			Osal_Futex_Wait(&g_objReqManager.m_u32FreeSeq, u32Seq, NULL);
+		}
+	}
+	atomic_fetch_sub(&g_objReqManager.m_iAdmitWaiters, 1);
+	return ptr;
+} // End of emplaceNewRequest
+
+/**
+ * @fn uint32_t emplaceNewRequestBatch(const struct timespec tsReqRcvd, stMbusBatchReq_t *a_pstReqs,
+ * 		uint32_t a_u32Count, stMbusPacketVariables_t **a_ppstNodes)
+ *
+ * @brief This function sets data structures to process a batch of new requests. Nodes for
+ * the whole batch are taken from free-list in one pass; each request is charged to quota of
+ * its own context. Requests of the batch do not wait for admission: a request for which no
+ * node is available fails with STS_MBUS_STACK_ERROR_MAX_REQ_SENT.
+ *
+ * @param tsReqRcvd 	[in] const struct timespec time-stamp when batch was received
+ * @param a_pstReqs 	[in,out] stMbusBatchReq_t* requests of the batch. Requests with status other
+ * 							 than STS_MBUS_STACK_NO_ERROR are skipped; status of requests
+ * 							 without node is updated.
+ * @param a_u32Count 	[in] uint32_t number of requests in batch
+ * @param a_ppstNodes 	[out] stMbusPacketVariables_t** node emplaced for each request, NULL if none
+ * @return uint32_t [out] number of requests emplaced
+ *
+ */
+uint32_t emplaceNewRequestBatch(const struct timespec tsReqRcvd, stMbusBatchReq_t *a_pstReqs,
+		uint32_t a_u32Count, stMbusPacketVariables_t **a_ppstNodes)
+{
+	uint32_t u32Index = 0;
+	uint32_t u32Emplaced = 0;
+	uint32_t u32Chain = REQ_FREE_LIST_END;
+	uint32_t u32ChainLen = 0;
+	uint32_t u32Node = 0;
+	int iCtxSlot = -1;
+	bool bIsShared = false;
+
+	// Keep pool from being trimmed while nodes popped for the batch are not yet given back
+	atomic_fetch_add(&g_objReqManager.m_iInUse, 1);
+	for(u32Index = 0; u32Index < a_u32Count; u32Index++)
+	{
+		a_ppstNodes[u32Index] = NULL;
+		if(STS_MBUS_STACK_NO_ERROR != a_pstReqs[u32Index].m_eStatus)
+		{
+			continue;
+		}
+		if(false == acquireReqQuota(a_pstReqs[u32Index].m_i32Ctx, &iCtxSlot, &bIsShared))
+		{
+			a_pstReqs[u32Index].m_eStatus = STS_MBUS_STACK_ERROR_MAX_REQ_SENT;
+			continue;
+		}
+		// Count node in use before taking it, so that pool is not trimmed meanwhile
+		atomic_fetch_add(&g_objReqManager.m_iInUse, 1);
+		u32Node = REQ_FREE_LIST_END;
+		while(REQ_FREE_LIST_END == u32Node)
+		{
+			if(0 == u32ChainLen)
+			{
+				// take nodes for rest of the batch at once
+				u32ChainLen = popReqNodesFromFreeList(a_u32Count - u32Index, &u32Chain);
+				while(0 == u32ChainLen && true == growReqPool())
+				{
+					u32ChainLen = popReqNodesFromFreeList(a_u32Count - u32Index, &u32Chain);
+				}
+				if(0 == u32ChainLen)
+				{
+					break;
+				}
+			}
+			u32Node = u32Chain;
+			u32Chain = atomic_load_explicit(&g_objReqManager.m_pstReqHot[u32Node].m_u32NextFree,
+					memory_order_relaxed);
+			u32ChainLen--;
+
+			// Node is owned by this thread now. Reserve it.
+			eTransactionState expected = IdleState;
+			if(false == atomic_compare_exchange_strong(&g_objReqManager.m_pstReqHot[u32Node].m_state,
+					&expected, RESERVED))
+			{
+				// node belongs to another request, it is neither used nor given back
+				printf("Error: request node %u from free-list is not idle, node is dropped\n", u32Node);
+				u32Node = REQ_FREE_LIST_END;
+			}
+		}
+		if(REQ_FREE_LIST_END == u32Node)
+		{
+			atomic_fetch_sub(&g_objReqManager.m_iInUse, 1);
+			releaseReqQuota(iCtxSlot, bIsShared);
+			a_pstReqs[u32Index].m_eStatus = STS_MBUS_STACK_ERROR_MAX_REQ_SENT;
+			continue;
+		}
+		a_ppstNodes[u32Index] = initNewRequest(u32Node, tsReqRcvd, iCtxSlot, bIsShared);
+		if(NULL == a_ppstNodes[u32Index])
+		{
+			putBackReqNode(u32Node);
+			releaseReqQuota(iCtxSlot, bIsShared);
+			a_pstReqs[u32Index].m_eStatus = STS_MBUS_STACK_ERROR_MAX_REQ_SENT;
+			continue;
+		}
+		u32Emplaced++;
+	}
+
+	// give back nodes taken for requests which have failed
+	if(u32ChainLen > 0)
+	{
+		uint32_t u32Last = u32Chain;
+		while(--u32ChainLen > 0)
+		{
+			u32Last = atomic_load_explicit(&g_objReqManager.m_pstReqHot[u32Last].m_u32NextFree,
+					memory_order_relaxed);
+		}
+		pushReqNodesToFreeList(u32Chain, u32Last);
+	}
+	if(1 == atomic_fetch_sub(&g_objReqManager.m_iInUse, 1) &&
+			eReqPoolGrowAndTrim == g_objReqManager.m_ePolicy)
+	{
+		trimReqPool();
+	}
+	return u32Emplaced;
+} // End of emplaceNewRequestBatch
+
+/**
+ * @fn t_Status postNewRequest(Post_Thread_Msg_t *a_pstMsg)
+ *
+ * @brief This function posts new request to message queue of its context. If queue
+ * is full, function fails immediately or waits for free space as per admission mode
+ * of the stack, so a caller in fail-fast mode is never blocked. A full queue is
+ * reported like a used up request pool, so that caller retries later.
+ *
+ * @param a_pstMsg [in] Post_Thread_Msg_t* message holding request
+ * @return [out] t_Status STS_MBUS_STACK_NO_ERROR if request is posted;
+ * 						  STS_MBUS_STACK_ERROR_MAX_REQ_SENT if queue is full within admission timeout;
+ * 						  STS_MBUS_STACK_ERROR_QUEUE_SEND if queue is not valid
+ *
+ */
+t_Status postNewRequest(Post_Thread_Msg_t *a_pstMsg)
+{
+	long lTimeoutMs = -1;
+
+	if(eReqAdmitFailFast == g_objReqManager.m_eAdmissionMode)
+	{
+		lTimeoutMs = 0;
+	}
+	else if(eReqAdmitTimedWait == g_objReqManager.m_eAdmissionMode)
+	{
+		lTimeoutMs = g_objReqManager.m_lAdmissionTimeout;
+	}
+	if(OSAL_Post_Message_Timed(a_pstMsg, lTimeoutMs))
+	{
+		return STS_MBUS_STACK_NO_ERROR;
+	}
+	return (EAGAIN == errno) ? STS_MBUS_STACK_ERROR_MAX_REQ_SENT : STS_MBUS_STACK_ERROR_QUEUE_SEND;
+} // End of postNewRequest
+
+/**
+ * @fn void freeReqNode(stMbusPacketVariables_t* a_pobjReq)
+ *
+ * @brief This function frees a request node and resets it for use by next requests. This function
+ * also releases the request from tracking for timeout and puts the node back on the free-list.
+ *
+ * @param a_pobjReq [in] stMbusPacketVariables_t* request node to mark as free
+ *
+ * @return none
+ *
+ */
+void freeReqNode(stMbusPacketVariables_t* a_pobjReq)
+{
+	// 1. remove the node from timeout tracker in case of TCP
+	// 2. reset the request node elements
+	// 3. mark the index as available
+	if(NULL == a_pobjReq)
+	{
+		return;
+	}
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+	releaseFromTracker(a_pobjReq);
+#endif
+	stReqHotMeta_t *pstHot = REQ_HOT_META(a_pobjReq);
+	// A node is pushed on free-list only once
+	if(IdleState == atomic_exchange(&pstHot->m_state, IdleState))
+	{
+		printf("Error: request node %u is already free\n", a_pobjReq->m_ulMyId);
+		return;
+	}
+	int iCtxSlot = pstHot->m_i16CtxSlot;
+	bool bIsShared = pstHot->m_bIsSharedSlot;
+	// reset the structure
+	resetReqNode(a_pobjReq);
+	putReqNodeToFreeList(a_pobjReq);
+	// quota is given back after node is available, so that a request admitted
+	// by quota always finds a node on free-list
+	releaseReqQuota(iCtxSlot, bIsShared);
+	// Wake requests waiting for admission. All are woken since freed node may
+	// be usable only by a waiter of the same context.
+	if(0 < atomic_load(&g_objReqManager.m_iAdmitWaiters))
+	{
+		atomic_fetch_add(&g_objReqManager.m_u32FreeSeq, 1);
+		Osal_Futex_Wake(&g_objReqManager.m_u32FreeSeq, INT32_MAX);
+	}
+	// last request in use is complete, pool can be trimmed
+	if(1 == atomic_fetch_sub(&g_objReqManager.m_iInUse, 1) &&
+			eReqPoolGrowAndTrim == g_objReqManager.m_ePolicy)
+	{
+		trimReqPool();
+	}
+}  //End of freeReqNode
+
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+/**
+ * @fn static void copyFromRecvBuf(const stTcpRecvData_t *a_pstConn, uint8_t *a_pu8Dest, uint32_t a_u32Len)
+ *
+ * @brief This function copies bytes from head of receive buffer of a connection.
+ * Bytes are copied in two parts if they wrap around end of the buffer.
+ * Head of buffer is not moved.
+ *
+ * @param a_pstConn [in] const stTcpRecvData_t* connection
+ * @param a_pu8Dest [out] uint8_t* destination, at least a_u32Len bytes
+ * @param a_u32Len 	[in] uint32_t number of bytes to copy, not more than bytes in buffer
+ *
+ * @return [out] none
+ */
+static void copyFromRecvBuf(const stTcpRecvData_t *a_pstConn, uint8_t *a_pu8Dest, uint32_t a_u32Len)
+{
+	uint32_t u32Off = a_pstConn->m_u32Head & (TCP_RECV_BUFFER_SIZE - 1);
+	uint32_t u32First = TCP_RECV_BUFFER_SIZE - u32Off;
+
+	if(u32First > a_u32Len)
+	{
+		u32First = a_u32Len;
+	}
+	memcpy_s(a_pu8Dest, a_u32Len, &a_pstConn->m_au8Buf[u32Off], u32First);
+	if(u32First < a_u32Len)
+	{
+		memcpy_s(a_pu8Dest + u32First, a_u32Len - u32First, a_pstConn->m_au8Buf, a_u32Len - u32First);
+	}
+} // End of copyFromRecvBuf
+
+/**
+ * @fn void resetEPollClientDataStruct(stTcpRecvData_t* clientAccepted)
+ *
+ * @brief This function resets receive buffer of a connection when it is closed.
+ * If header of a partially received frame is in buffer, request it belongs to is
+ * completed with receive error since rest of the response will not arrive.
+ *
+ * @param clientAccepted [in] stTcpRecvData_t* pointer that holds socket's data received information
+ *
+ * @return [out] none
+ */
+void resetEPollClientDataStruct(stTcpRecvData_t* clientAccepted)
+{
+	if(NULL != clientAccepted)
+	{
+		if((clientAccepted->m_u32Tail - clientAccepted->m_u32Head) >= MBAP_HEADER_LENGTH)
+		{
+			uint8_t au8Header[MBAP_HEADER_LENGTH];
+			stMbusPacketVariables_t *pstReq = NULL;
+
+			copyFromRecvBuf(clientAccepted, au8Header, MBAP_HEADER_LENGTH);
+			pstReq = matchRespHeader(clientAccepted, au8Header);
+			if(NULL != pstReq)
+			{
+				pstReq->m_u8ProcessReturn = STS_MBUS_STACK_ERROR_RECV_FAILED;
+				timespec_get(&(pstReq->m_objTimeStamps.tsRespRcvd), TIME_UTC);
+				REQ_HOT_META(pstReq)->m_state = RESP_ERROR;
+				addToRespQ(pstReq);
+			}
+		}
+		clientAccepted->m_u32Head = 0;
+		clientAccepted->m_u32Tail = 0;
+	}
+} // End of resetEPollClientDataStruct
+
+/**
+ *
+ * @fn struct timespec getEpochTime()
+ *
+ * @brief This function gets the current epoch time
+ *
+ * @param none
+ *
+ * @return struct timespec [out] epoch time struct
+ */
+struct timespec getEpochTime()
+{
+
+	struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+
+    return ts;
+} // End of getEpochTime
+
+/**
+ * @fn static bool parseTcpFrames(stTcpRecvData_t *a_pstConn)
+ *
+ * @brief This function extracts all complete MBAP frames from receive buffer of a
+ * connection. Every frame is matched with its request and copied in response buffer of
+ * that request; a frame which does not belong to any request in flight is dropped.
+ * A partial frame is kept in buffer until rest of it is received.
+ *
+ * @param a_pstConn [in] stTcpRecvData_t* connection
+ *
+ * @return bool [out] true if frames are parsed;
+ * 					  false if a header is not a valid MBAP header and framing is lost
+ */
+static bool parseTcpFrames(stTcpRecvData_t *a_pstConn)
+{
+	uint8_t au8Header[MBAP_HEADER_LENGTH];
+	uint32_t u32FrameLen = 0;
+	uint16_t u16Len = 0;
+	stMbusPacketVariables_t *pstReq = NULL;
+
+	while((a_pstConn->m_u32Tail - a_pstConn->m_u32Head) >= MBAP_HEADER_LENGTH)
+	{
+		// TCP IP message format
+		// 2 bytes = TxID, 2 bytes = Protocol ID, 2 bytes = length, 1 byte = unit id
+		copyFromRecvBuf(a_pstConn, au8Header, MBAP_HEADER_LENGTH);
+
+		// Length counts unit id and PDU. PDU has at least function code and one byte,
+		// complete frame must fit in response buffer.
+		u16Len = (au8Header[4] << 8) | au8Header[5];
+		// Protocol ID is always 0 for Modbus
+		if(0 != au8Header[2] || 0 != au8Header[3] ||
+				u16Len < 2 || u16Len > (MODBUS_DATA_LENGTH - MODBUS_HEADER_LENGTH))
+		{
+			printf("Invalid MBAP header received, length %d\n", u16Len);
+			return false;
+		}
+		u32FrameLen = MODBUS_HEADER_LENGTH + u16Len;
+		if((a_pstConn->m_u32Tail - a_pstConn->m_u32Head) < u32FrameLen)
+		{
+			// rest of frame is received later
+			break;
+		}
+
+		pstReq = matchRespHeader(a_pstConn, au8Header);
+		if(NULL != pstReq)
+		{
+			copyFromRecvBuf(a_pstConn, pstReq->m_u8RawResp, u32FrameLen);
+			addToHandleRespQ(pstReq);
+		}
+		a_pstConn->m_u32Head += u32FrameLen;
+	}
+
+	if(a_pstConn->m_u32Head == a_pstConn->m_u32Tail)
+	{
+		// buffer is empty, next receive starts at beginning of buffer
+		a_pstConn->m_u32Head = 0;
+		a_pstConn->m_u32Tail = 0;
+	}
+	return true;
+} // End of parseTcpFrames
+
+/**
+ * @fn static bool readTcpResponses(stTcpRecvData_t *a_pstConn)
+ *
+ * @brief This function reads responses from a socket till no more data is available.
+ * Socket is edge triggered, so it must be drained for its next readability to be
+ * signalled. Each call receives whatever is available in free space of receive buffer
+ * of the connection, so responses which arrive back to back are received together.
+ * All complete frames are parsed from the buffer after each receive.
+ *
+ * @param a_pstConn [in] stTcpRecvData_t* connection to read from
+ *
+ * @return bool [out] true if all available data is read;
+ * 					  false if connection is closed, failed or framing is lost
+ */
+static bool readTcpResponses(stTcpRecvData_t *a_pstConn)
+{
+	struct iovec astIov[2];
+	struct msghdr stMsg = { 0 };
+	ssize_t bytes_read = 0;
+
+	while(true)
+	{
+		// A complete frame is always parsed, so buffer has less than one frame
+		// and free space is never empty.
+		uint32_t u32Free = TCP_RECV_BUFFER_SIZE - (a_pstConn->m_u32Tail - a_pstConn->m_u32Head);
+		uint32_t u32Off = a_pstConn->m_u32Tail & (TCP_RECV_BUFFER_SIZE - 1);
+		uint32_t u32First = TCP_RECV_BUFFER_SIZE - u32Off;
+
+		if(u32First > u32Free)
+		{
+			u32First = u32Free;
+		}
+		// free space wraps around end of buffer
+		astIov[0].iov_base = &a_pstConn->m_au8Buf[u32Off];
+		astIov[0].iov_len = u32First;
+		astIov[1].iov_base = a_pstConn->m_au8Buf;
+		astIov[1].iov_len = u32Free - u32First;
+		stMsg.msg_iov = astIov;
+		stMsg.msg_iovlen = (u32Free > u32First) ? 2 : 1;
+
+		//receive data from socket
+		bytes_read = recvmsg(a_pstConn->m_pstConRef->m_sockfd, &stMsg, MSG_DONTWAIT);
+		if(bytes_read < 0)
+		{
+			if(EAGAIN == errno || EWOULDBLOCK == errno)
+			{
+				// all available data is read
+				return true;
+			}
+			if(EINTR == errno)
+			{
+				continue;
+			}
+			perror("Recv() failed : ");
+			return false;
+		}
+		if(0 == bytes_read)
+		{
+			// connection is closed by Modbus slave device
+			return false;
+		}
+
+		a_pstConn->m_u32Tail += (uint32_t)bytes_read;
+		if(false == parseTcpFrames(a_pstConn))
+		{
+			return false;
+		}
+	}
+} // End of readTcpResponses
+
+#else
+
+/**
+ *
+ *@fn void* SessionControlThread(void* threadArg)
+ *
+ * @brief This function is a thread routine to send Modbus RTU messages to Modbus slave device
+ * which are available in the Linux message queue. Thread continuously checks for a new message in
+ * Linux message queue; once the message is available it sends the request to the Modbus slave device.
+ * The Modbus_SendPacket function receives the response from Modbus slave device, after this session
+ * control thread function invokes the ModbusApp callback function. After invoking ModbusApp callback
+ * function, this function frees up with request node from request manager's list.
+ *
+ * @param threadArg [in] void* thread argument
+ *
+ * @return [out] none
+ *
+ */
+void* SessionControlThread(void* threadArg)
+{
+	int32_t i32MsgQueIdSC = 0;
+	Linux_Msg_t stScMsgQue = { 0 };
+	stMbusPacketVariables_t *pstMBusReqPact = NULL;
+	stRTUConnectionData_t stRTUConnectionData = {};
+	t_Status u8ReturnType = 0;
+	stLiveSerSessionList_t pstLivSerSesslist;
+
+	pstLivSerSesslist = *((stLiveSerSessionList_t *)threadArg);
+	i32MsgQueIdSC = pstLivSerSesslist.MsgQId;
+
+	stRTUConnectionData.m_fd = -1;
+	while(false == g_bThreadExit)
+	{
+		memset(&stScMsgQue,00,sizeof(stScMsgQue));
+		if(OSAL_Get_Message(&stScMsgQue, i32MsgQueIdSC))
+		{
+			pstMBusReqPact = stScMsgQue.lParam;
+			// message holds a chain of requests if posted by Modbus_Submit_Batch()
+			while(NULL != pstMBusReqPact)
+			{
+				// node may be freed once it is processed, take next link first
+				stMbusPacketVariables_t *pstNext = pstMBusReqPact->m_pstBatchNext;
+				pstMBusReqPact->m_pstBatchNext = NULL;
+				// Check if connection is established
+				if(stRTUConnectionData.m_fd == -1)
+				{
+					int ret = initSerialPort(&stRTUConnectionData,
+									pstLivSerSesslist.m_portName,
+									pstLivSerSesslist.m_baudrate,
+									pstLivSerSesslist.m_parity,
+									pstLivSerSesslist.m_stopbits);
+
+					if(-1 == ret)
+					{
+						stRTUConnectionData.m_fd = -1;
+						pstMBusReqPact->m_u8ProcessReturn = STS_MBUS_STACK_ERROR_SERIAL_PORT_ERROR;
+						printf("Failed to initialize serial port for RTU. File descriptor is set to :: %d\n",stRTUConnectionData.m_fd);
+						addToRespQ(pstMBusReqPact);
+						pstMBusReqPact = pstNext;
+						continue;
+					}
+				}
+				u8ReturnType = Modbus_SendPacket(pstMBusReqPact, stRTUConnectionData,
+						pstLivSerSesslist.m_lInterframeDelay, pstLivSerSesslist.m_lrespTimeout);
+
+				pstMBusReqPact->m_u8ProcessReturn = u8ReturnType;
+				if(STS_MBUS_STACK_NO_ERROR == u8ReturnType)
+				{
+					//pstMBusReqPact->m_state = RESP_RCVD_FROM_NETWORK;
+				}
+				else
+				{
+					addToRespQ(pstMBusReqPact);
+				}
+				pstMBusReqPact = pstNext;
+			}
+		}
+		fflush(stdin);
+
+		// check for thread exit
+		if(g_bThreadExit)
+		{
+			break;
+		}
+	}
+	return NULL;
+}  // End of SessionControlThread
+#endif
+
+
+// when Modbus communication mode is TCP
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+/**
+ *
+ *@fn unsigned long get_nanos(void)
+ *
+ * @brief This function gets current time stamp in nano-seconds.
+ *
+ * @param none
+ *
+ * @return [out] unsigned long time in nano-seconds
+ */
+unsigned long get_nanos(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (unsigned long)ts.tv_sec * 1000000000L + ts.tv_nsec;
+} // End of get_nanos
+
+/**
+ *
+ * @fn static void lockTimeoutTracker(void)
+ *
+ * @brief This function acquires spin lock guarding timing wheel of timeout tracker.
+ *
+ * @param none
+ *
+ * @return none
+ */
+static void lockTimeoutTracker(void)
+{
+	int expected = 0;
+	do
+	{
+		expected = 0;
+	} while(!atomic_compare_exchange_weak(&g_oTimeOutTracker.m_iIsLocked, &expected, 1));
+} // End of lockTimeoutTracker
+
+/**
+ *
+ * @fn static void unlockTimeoutTracker(void)
+ *
+ * @brief This function releases spin lock guarding timing wheel of timeout tracker.
+ *
+ * @param none
+ *
+ * @return none
+ */
+static void unlockTimeoutTracker(void)
+{
+	atomic_store(&g_oTimeOutTracker.m_iIsLocked, 0);
+} // End of unlockTimeoutTracker
+
+/**
+ *
+ * @fn void releaseFromTrackerNode(stMbusPacketVariables_t *a_pstNodeToRemove,
+	struct stTimeOutTrackerNode *a_pstTracker)
+ *
+ * @brief This function removes request from a list of timing wheel.
+ * Assumed is calling function has acquired lock of timeout tracker.
+ *
+ * @param pstMBusRequesPacket [in] stMbusPacketVariables_t* pointer to structure holding request
+ * 								   sent on Modbus slave device
+ *
+ * @param a_pstTracker [in] stTimeOutTrackerNode* reference to timeout tracker list from which
+ * 							node needs to be removed
+ *
+ * @return [out] none
+ */
+void releaseFromTrackerNode(stMbusPacketVariables_t *a_pstNodeToRemove,
+		struct stTimeOutTrackerNode *a_pstTracker)
+{
+	if((NULL == a_pstNodeToRemove) || (NULL == a_pstTracker))
+	{
+		return;
+	}
+
+	{
+		stReqHotMeta_t *pstHot = REQ_HOT_META(a_pstNodeToRemove);
+		int32_t i32Prev = pstHot->m_i32TimeoutPrev;
+		int32_t i32Next = pstHot->m_i32TimeoutNext;
+
+		if(REQ_LINK_NONE != i32Prev)
+		{
+			g_objReqManager.m_pstReqHot[i32Prev].m_i32TimeoutNext = i32Next;
+		}
+		if(REQ_LINK_NONE != i32Next)
+		{
+			g_objReqManager.m_pstReqHot[i32Next].m_i32TimeoutPrev = i32Prev;
+		}
+		if((int32_t)a_pstNodeToRemove->m_ulMyId == a_pstTracker->m_i32Start)
+		{
+			a_pstTracker->m_i32Start = i32Next;
+		}
+		if((int32_t)a_pstNodeToRemove->m_ulMyId == a_pstTracker->m_i32Last)
+		{
+			a_pstTracker->m_i32Last = i32Prev;
+		}
+
+		pstHot->m_i32TimeoutPrev = REQ_LINK_NONE;
+		pstHot->m_i32TimeoutNext = REQ_LINK_NONE;
+	}
+} // End of releaseFromTrackerNode
+
+
+/**
+ *
+ * @fn void releaseFromTracker(stMbusPacketVariables_t *pstMBusRequesPacket)
+ *
+ * @brief This function removes the request from timeout tracker in O(1).
+ * Request is unlinked from the list of timing wheel it is kept in.
+ *
+ * @param pstMBusRequesPacket [in] stMbusPacketVariables_t* pointer to structure holding information
+ * 									about the request
+ *
+ * @return void [out] none
+ */
+void releaseFromTracker(stMbusPacketVariables_t *pstMBusRequesPacket)
+{
+	if(NULL == pstMBusRequesPacket)
+	{
+		return;
+	}
+	stReqHotMeta_t *pstHot = REQ_HOT_META(pstMBusRequesPacket);
+	// Request is not tracked. It is added to wheel before it is marked as sent,
+	// so a request which is freed is never added concurrently.
+	if(pstHot->m_iTimeOutIndex < 0)
+	{
+		return;
+	}
+
+	lockTimeoutTracker();
+	// list is read under lock, request may have been moved by event loop expiring timeouts
+	if((pstHot->m_iTimeOutIndex >= 0) && (pstHot->m_iTimeOutIndex < TIMEOUT_WHEEL_SIZE))
+	{
+		releaseFromTrackerNode(pstMBusRequesPacket,
+				&g_oTimeOutTracker.m_astWheel[pstHot->m_iTimeOutIndex]);
+		pstHot->m_iTimeOutIndex = -1;
+		g_oTimeOutTracker.m_iCount--;
+	}
+	unlockTimeoutTracker();
+} // End of releaseFromTracker
+
+#endif
+
+/**
+ *
+ * @fn void addToRespQ(stMbusPacketVariables_t *a_pstReq)
+ *
+ * @brief This function adds Modbus request (sent to Modbus slave device) in
+ * response queue. Queue is selected by context of request, so responses of
+ * a context are handled by one dispatcher thread in order.
+ *
+ * @param a_pstReq [in] stMbusPacketVariables_t* pointer to structure holding information
+ * 						about request to add in response queue
+ *
+ * @return [out] none
+ */
+void addToRespQ(stMbusPacketVariables_t *a_pstReq)
+{
+	if(NULL != a_pstReq)
+	{
+		Post_Thread_Msg_t stPostThreadMsg = { 0 };
+		// context quota slot is unique per context; requests without slot use first dispatcher
+		int iCtxSlot = REQ_HOT_META(a_pstReq)->m_i16CtxSlot;
+		uint32_t u32Dispatcher = (iCtxSlot < 0) ? 0 :
+				((uint32_t)iCtxSlot % g_stRespProcess.m_u32DispatcherCount);
+
+		// request is complete, next request of its device can be sent
+		releaseReqWindow(a_pstReq);
+		// Add to queue
+		stPostThreadMsg.idThread = g_stRespProcess.m_astDispatcher[u32Dispatcher].m_i32RespMsgQueId;
+		stPostThreadMsg.wParam = NULL;
+		stPostThreadMsg.lParam = a_pstReq;
+		stPostThreadMsg.MsgType = a_pstReq->m_lPriority;
+
+		// response thread is woken only if it waits on empty queue. Queue holds
+		// whole request pool, so post never waits; it must not block event loop.
+		if(!OSAL_Post_Message_Timed(&stPostThreadMsg, 0))
+		{
+			//OSAL_Free(a_pstReq);
+			freeReqNode(a_pstReq);
+		}
+	}
+} // End of addToRespQ
+
+/**
+ *
+ * @fn void* postResponseToApp(void* threadArg)
+ *
+ * @brief This function is thread routine which posts response to application.
+ * It listens on response queue of its dispatcher to receive response of requests to post to ModbusApp.
+ * All responses ready in queue are taken in one go on each wakeup.
+ * Once the response is sent to ModbusApp, function frees the response node so that other
+ * requests can reuse it. The thread keeps working till the flag is not set to terminate
+ * the thread.
+ *
+ * @param threadArg [in] void* pointer to stRespDispatcher_t of this thread
+ *
+ * @return [out] none
+ */
+void* postResponseToApp(void* threadArg)
+{
+	const stRespDispatcher_t *pstDispatcher = (const stRespDispatcher_t *)threadArg;
+	Linux_Msg_t astRespMsgs[RESP_QUEUE_BATCH_SIZE];
+	stMbusPacketVariables_t *pstMBusRequesPacket = NULL;
+	int32_t i32RetVal = 0;
+	int32_t i32Count = 0;
+
+	// set thread priority
+	set_thread_sched_param();
+
+	while(false == g_bThreadExit)
+	{
+		i32RetVal = OSAL_Get_Message_Batch(astRespMsgs, RESP_QUEUE_BATCH_SIZE,
+				pstDispatcher->m_i32RespMsgQueId);
+		if(i32RetVal <= 0)
+		{
+			// queue is deleted
+			break;
+		}
+		for(i32Count = 0; i32Count < i32RetVal; i32Count++)
+		{
+			pstMBusRequesPacket = astRespMsgs[i32Count].lParam;
+			if(NULL != pstMBusRequesPacket)
+			{
+				if(REQ_HOT_META(pstMBusRequesPacket)->m_state == RESP_RCVD_FROM_NETWORK)
+				{
+					pstMBusRequesPacket->m_u8ProcessReturn = DecodeRxPacket(pstMBusRequesPacket->m_u8RawResp, pstMBusRequesPacket);
+				}
+				ApplicationCallBackHandler(pstMBusRequesPacket, pstMBusRequesPacket->m_u8ProcessReturn);
+				freeReqNode(pstMBusRequesPacket);
+			}
+		}
+	}
+
+	return NULL;
+} // End of postResponseToApp
+
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+/**
+ *
+ * @fn static uint64_t getTimeoutClockMs(void)
+ *
+ * @brief This function returns current time of monotonic clock in milliseconds.
+ * Deadlines of timeout tracker are kept in this time base.
+ *
+ * @param none
+ *
+ * @return [out] uint64_t current monotonic time in milliseconds
+ */
+static uint64_t getTimeoutClockMs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+} // End of getTimeoutClockMs
+
+/**
+ *
+ * @fn static uint64_t getReqDeadlineMs(const stReqHotMeta_t *a_pstHot)
+ *
+ * @brief This function gives deadline of a tracked request in full width monotonic
+ * milliseconds. Hot metadata holds lower 32 bits only; deadline is within a few
+ * hours of wheel time, so it is rebuilt relative to it.
+ *
+ * @param a_pstHot [in] const stReqHotMeta_t* hot metadata of request
+ *
+ * @return [out] uint64_t deadline in monotonic milliseconds
+ */
+static uint64_t getReqDeadlineMs(const stReqHotMeta_t *a_pstHot)
+{
+	uint64_t u64WheelMs = g_oTimeOutTracker.m_u64WheelMs;
+	return u64WheelMs + (int64_t)(int32_t)(a_pstHot->m_u32DeadlineMs - (uint32_t)u64WheelMs);
+} // End of getReqDeadlineMs
+
+/**
+ *
+ * @fn static int getWheelList(uint64_t a_u64DeadlineMs, uint64_t a_u64BaseMs)
+ *
+ * @brief This function finds list of timing wheel for a deadline. Deadlines within
+ * TIMEOUT_WHEEL_L0_SIZE ms of base time go to level 0, which has a list per millisecond.
+ * Later deadlines go to the lowest level whose range covers them; their list is moved
+ * down when it becomes due.
+ *
+ * @param a_u64DeadlineMs 	[in] uint64_t deadline in monotonic milliseconds
+ * @param a_u64BaseMs 		[in] uint64_t first millisecond not yet processed by wheel
+ *
+ * @return [out] int index of list in m_astWheel
+ */
+static int getWheelList(uint64_t a_u64DeadlineMs, uint64_t a_u64BaseMs)
+{
+	int iLevel = 1;
+	int iShift = TIMEOUT_WHEEL_L0_BITS;
+	uint64_t u64Delta = 0;
+
+	// a deadline which has passed is processed with next millisecond
+	if(a_u64DeadlineMs < a_u64BaseMs)
+	{
+		a_u64DeadlineMs = a_u64BaseMs;
+	}
+	u64Delta = a_u64DeadlineMs - a_u64BaseMs;
+	if(u64Delta < TIMEOUT_WHEEL_L0_SIZE)
+	{
+		return (int)(a_u64DeadlineMs & (TIMEOUT_WHEEL_L0_SIZE - 1));
+	}
+	if(u64Delta >= TIMEOUT_WHEEL_RANGE_MS)
+	{
+		a_u64DeadlineMs = a_u64BaseMs + TIMEOUT_WHEEL_RANGE_MS - 1;
+		u64Delta = TIMEOUT_WHEEL_RANGE_MS - 1;
+	}
+	for(; iLevel < TIMEOUT_WHEEL_LEVELS - 1; iLevel++)
+	{
+		if(u64Delta < (1ULL << (iShift + TIMEOUT_WHEEL_LN_BITS)))
+		{
+			break;
+		}
+		iShift += TIMEOUT_WHEEL_LN_BITS;
+	}
+	return TIMEOUT_WHEEL_L0_SIZE + (iLevel - 1) * TIMEOUT_WHEEL_LN_SIZE +
+			(int)((a_u64DeadlineMs >> iShift) & (TIMEOUT_WHEEL_LN_SIZE - 1));
+} // End of getWheelList
+
+/**
+ *
+ * @fn static void addToWheel(int32_t a_i32Id, uint64_t a_u64DeadlineMs, uint64_t a_u64BaseMs)
+ *
+ * @brief This function appends a request to list of timing wheel for its deadline.
+ * Assumed is calling function has acquired lock of timeout tracker.
+ *
+ * @param a_i32Id 			[in] int32_t index of request node
+ * @param a_u64DeadlineMs 	[in] uint64_t deadline in monotonic milliseconds
+ * @param a_u64BaseMs 		[in] uint64_t first millisecond not yet processed by wheel
+ *
+ * @return none
+ */
+static void addToWheel(int32_t a_i32Id, uint64_t a_u64DeadlineMs, uint64_t a_u64BaseMs)
+{
+	int iList = getWheelList(a_u64DeadlineMs, a_u64BaseMs);
+	struct stTimeOutTrackerNode *pstList = &g_oTimeOutTracker.m_astWheel[iList];
+	stReqHotMeta_t *pstHot = &g_objReqManager.m_pstReqHot[a_i32Id];
+
+	pstHot->m_i32TimeoutNext = REQ_LINK_NONE;
+	pstHot->m_i32TimeoutPrev = pstList->m_i32Last;
+	if(REQ_LINK_NONE == pstList->m_i32Start)
+	{
+		pstList->m_i32Start = a_i32Id;
+	}
+	else
+	{
+		g_objReqManager.m_pstReqHot[pstList->m_i32Last].m_i32TimeoutNext = a_i32Id;
+	}
+	pstList->m_i32Last = a_i32Id;
+	pstHot->m_iTimeOutIndex = iList;
+} // End of addToWheel
+
+/**
+ *
+ * @fn static void cascadeWheelList(int a_iList, uint64_t a_u64NowMs)
+ *
+ * @brief This function moves requests of a list of higher level which has become due
+ * to lists of lower levels. Assumed is calling function has acquired lock of timeout tracker.
+ *
+ * @param a_iList 		[in] int index of list in m_astWheel
+ * @param a_u64NowMs 	[in] uint64_t millisecond being processed
+ *
+ * @return none
+ */
+static void cascadeWheelList(int a_iList, uint64_t a_u64NowMs)
+{
+	int32_t i32NextNode = g_oTimeOutTracker.m_astWheel[a_iList].m_i32Start;
+
+	g_oTimeOutTracker.m_astWheel[a_iList].m_i32Start = REQ_LINK_NONE;
+	g_oTimeOutTracker.m_astWheel[a_iList].m_i32Last = REQ_LINK_NONE;
+	while(REQ_LINK_NONE != i32NextNode)
+	{
+		int32_t i32Cur = i32NextNode;
+		stReqHotMeta_t *pstHot = &g_objReqManager.m_pstReqHot[i32Cur];
+		i32NextNode = pstHot->m_i32TimeoutNext;
+		addToWheel(i32Cur, getReqDeadlineMs(pstHot), a_u64NowMs);
+	}
+} // End of cascadeWheelList
+
+/**
+ *
+ * @fn static uint64_t getNextWheelEventMs(void)
+ *
+ * @brief This function finds first millisecond after wheel time at which timeout tracker
+ * has work to do: a level 0 list holding requests, or a list of higher level which has
+ * to be moved down. Assumed is calling function has acquired lock of timeout tracker.
+ *
+ * @param none
+ *
+ * @return [out] uint64_t millisecond of next event; TIMEOUT_TIMER_DISARMED if wheel is empty
+ */
+static uint64_t getNextWheelEventMs(void)
+{
+	uint64_t u64Next = TIMEOUT_TIMER_DISARMED;
+	uint64_t u64Ms = 0;
+	uint64_t u64WheelMs = g_oTimeOutTracker.m_u64WheelMs;
+	int iLevel = 1;
+	int iShift = TIMEOUT_WHEEL_L0_BITS;
+	int iCount = 0;
+
+	if(0 == g_oTimeOutTracker.m_iCount)
+	{
+		return TIMEOUT_TIMER_DISARMED;
+	}
+	for(iCount = 1; iCount <= TIMEOUT_WHEEL_L0_SIZE; iCount++)
+	{
+		u64Ms = u64WheelMs + (uint64_t)iCount;
+		if(REQ_LINK_NONE !=
+				g_oTimeOutTracker.m_astWheel[u64Ms & (TIMEOUT_WHEEL_L0_SIZE - 1)].m_i32Start)
+		{
+			u64Next = u64Ms;
+			break;
+		}
+	}
+	// a list of higher level becomes due at multiples of range of the level below
+	for(; iLevel < TIMEOUT_WHEEL_LEVELS; iLevel++, iShift += TIMEOUT_WHEEL_LN_BITS)
+	{
+		int iBase = TIMEOUT_WHEEL_L0_SIZE + (iLevel - 1) * TIMEOUT_WHEEL_LN_SIZE;
+		u64Ms = ((u64WheelMs >> iShift) + 1) << iShift;
+		for(iCount = 0; iCount < TIMEOUT_WHEEL_LN_SIZE && u64Ms < u64Next; iCount++)
+		{
+			if(REQ_LINK_NONE != g_oTimeOutTracker.m_astWheel[iBase +
+					(int)((u64Ms >> iShift) & (TIMEOUT_WHEEL_LN_SIZE - 1))].m_i32Start)
+			{
+				u64Next = u64Ms;
+				break;
+			}
+			u64Ms += (1ULL << iShift);
+		}
+	}
+	return u64Next;
+} // End of getNextWheelEventMs
+
+/**
+ *
+ * @fn static int32_t expireWheel(uint64_t a_u64NowMs)
+ *
+ * @brief This function advances timing wheel to given time. Lists of higher levels which
+ * become due are moved down and requests of due level 0 lists are removed from wheel.
+ * Requests still waiting for response are marked as timed out and returned as a chain,
+ * so that their responses are posted after lock is released. Only milliseconds with
+ * work are visited. Assumed is calling function has acquired lock of timeout tracker.
+ *
+ * @param a_u64NowMs [in] uint64_t current monotonic time in milliseconds
+ *
+ * @return [out] int32_t index of first timed out request, linked by m_i32TimeoutNext;
+ * 					 REQ_LINK_NONE if none
+ */
+static int32_t expireWheel(uint64_t a_u64NowMs)
+{
+	int32_t i32Expired = REQ_LINK_NONE;
+	uint64_t u64Ms = 0;
+
+	while((u64Ms = getNextWheelEventMs()) <= a_u64NowMs)
+	{
+		int iLevel = 1;
+		int iShift = TIMEOUT_WHEEL_L0_BITS;
+
+		g_oTimeOutTracker.m_u64WheelMs = u64Ms;
+		for(; iLevel < TIMEOUT_WHEEL_LEVELS; iLevel++, iShift += TIMEOUT_WHEEL_LN_BITS)
+		{
+			if(0 != (u64Ms & ((1ULL << iShift) - 1)))
+			{
+				break;
+			}
+			cascadeWheelList(TIMEOUT_WHEEL_L0_SIZE + (iLevel - 1) * TIMEOUT_WHEEL_LN_SIZE +
+					(int)((u64Ms >> iShift) & (TIMEOUT_WHEEL_LN_SIZE - 1)), u64Ms);
+		}
+
+		struct stTimeOutTrackerNode *pstList =
+				&g_oTimeOutTracker.m_astWheel[u64Ms & (TIMEOUT_WHEEL_L0_SIZE - 1)];
+		int32_t i32NextNode = pstList->m_i32Start;
+		pstList->m_i32Start = REQ_LINK_NONE;
+		pstList->m_i32Last = REQ_LINK_NONE;
+		while(REQ_LINK_NONE != i32NextNode)
+		{
+			int32_t i32Cur = i32NextNode;
+			stReqHotMeta_t *pstHot = &g_objReqManager.m_pstReqHot[i32Cur];
+			eTransactionState expected = REQ_SENT_ON_NETWORK;
+
+			i32NextNode = pstHot->m_i32TimeoutNext;
+			pstHot->m_i32TimeoutPrev = REQ_LINK_NONE;
+			pstHot->m_i32TimeoutNext = REQ_LINK_NONE;
+			pstHot->m_iTimeOutIndex = -1;
+			g_oTimeOutTracker.m_iCount--;
+			// A timed out request is freed only after its response is posted,
+			// so its link can be used to chain it
+			if(true ==
+					atomic_compare_exchange_strong(&pstHot->m_state, &expected, RESP_TIMEDOUT))
+			{
+				pstHot->m_i32TimeoutNext = i32Expired;
+				i32Expired = i32Cur;
+			}
+		}
+	}
+	if(a_u64NowMs > g_oTimeOutTracker.m_u64WheelMs)
+	{
+		g_oTimeOutTracker.m_u64WheelMs = a_u64NowMs;
+	}
+	return i32Expired;
+} // End of expireWheel
+
+/**
+ *
+ * @fn static void armTimeoutTimer(uint64_t a_u64DeadlineMs)
+ *
+ * @brief This function arms timeout timer for given deadline if it is earlier than
+ * deadline timer is armed for. Timer is not touched otherwise, so adding requests
+ * to a busy tracker does not cost a system call.
+ *
+ * @param a_u64DeadlineMs [in] uint64_t deadline in monotonic milliseconds
+ *
+ * @return none
+ */
+static void armTimeoutTimer(uint64_t a_u64DeadlineMs)
+{
+	uint64_t u64Armed = atomic_load(&g_oTimeOutTracker.m_u64ArmedMs);
+	struct itimerspec stTimerSpec = { 0 };
+
+	do
+	{
+		if(a_u64DeadlineMs >= u64Armed)
+		{
+			return;
+		}
+	} while(!atomic_compare_exchange_weak(&g_oTimeOutTracker.m_u64ArmedMs, &u64Armed, a_u64DeadlineMs));
+
+	// timer is set to latest armed deadline under lock, so that concurrent
+	// updates are not applied out of order
+	Osal_Wait_Mutex(g_oTimeOutTracker.m_hTimerMutex);
+	u64Armed = atomic_load(&g_oTimeOutTracker.m_u64ArmedMs);
+	if(TIMEOUT_TIMER_DISARMED != u64Armed)
+	{
+		stTimerSpec.it_value.tv_sec = (time_t)(u64Armed / 1000);
+		stTimerSpec.it_value.tv_nsec = (long)(u64Armed % 1000) * 1000000;
+		if(-1 == timerfd_settime(g_oTimeOutTracker.m_iTimerFd, TFD_TIMER_ABSTIME, &stTimerSpec, NULL))
+		{
+			perror("Timeout tracker: unable to arm timer: ");
+		}
+	}
+	Osal_Release_Mutex(g_oTimeOutTracker.m_hTimerMutex);
+} // End of armTimeoutTimer
+
+/**
+ *
+ * @fn static void expireTimedOutRequests(void)
+ *
+ * @brief This function is called when timeout timer expires. It takes timed out
+ * requests out of timing wheel, arms timer for next event of wheel and completes
+ * timed out requests with timeout error.
+ *
+ * @param none
+ *
+ * @return none
+ */
+static void expireTimedOutRequests(void)
+{
+	uint64_t u64NextMs = 0;
+	int32_t i32Expired = REQ_LINK_NONE;
+
+	// requests added from here on arm timer themselves if they are due
+	// before next event found below
+	atomic_store(&g_oTimeOutTracker.m_u64ArmedMs, TIMEOUT_TIMER_DISARMED);
+	lockTimeoutTracker();
+	i32Expired = expireWheel(getTimeoutClockMs());
+	u64NextMs = getNextWheelEventMs();
+	unlockTimeoutTracker();
+	if(TIMEOUT_TIMER_DISARMED != u64NextMs)
+	{
+		armTimeoutTimer(u64NextMs);
+	}
+
+	while(REQ_LINK_NONE != i32Expired)
+	{
+		stMbusPacketVariables_t *pstCur = &g_objReqManager.m_pstReqArray[i32Expired];
+		// node may be freed once it is posted, take next link first
+		i32Expired = g_objReqManager.m_pstReqHot[i32Expired].m_i32TimeoutNext;
+		pstCur->m_u8ProcessReturn = STS_MBUS_STACK_ERROR_RECV_TIMEOUT;
+		pstCur->m_stMbusRxData.m_u8Length = 0;
+		// Init resp received timestamp
+		timespec_get(&(pstCur->m_objTimeStamps.tsRespRcvd), TIME_UTC);
+		addToRespQ(pstCur);
+	}
+} // End of expireTimedOutRequests
+
+/**
+ *
+ * @fn int initTimeoutTrackerArray(void)
+ *
+ * @brief This function initialize timeout tracker data structure and its timer.
+ * Timer is polled by an event loop, which expires timed out requests.
+ *
+ * @param none
+ *
+ * @return [out] int 0 if function succeeds in the initialization of timeout tracker;
+ * 					-1 if function fails
+ */
+int initTimeoutTrackerArray(void)
+{
+	int iCount = 0;
+
+	atomic_store(&g_oTimeOutTracker.m_u64ArmedMs, TIMEOUT_TIMER_DISARMED);
+	// timer is polled by event loop, so it must not block
+	g_oTimeOutTracker.m_iTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+	if(-1 == g_oTimeOutTracker.m_iTimerFd)
+	{
+		perror("Timeout tracker: timer creation error: ");
+		return -1;
+	}
+	g_oTimeOutTracker.m_hTimerMutex = Osal_Mutex();
+	if(NULL == g_oTimeOutTracker.m_hTimerMutex)
+	{
+		return -1;
+	}
+
+	// Resets the lists of timing wheel
+	for(; iCount < TIMEOUT_WHEEL_SIZE; ++iCount)
+	{
+		g_oTimeOutTracker.m_astWheel[iCount].m_i32Start = REQ_LINK_NONE;
+		g_oTimeOutTracker.m_astWheel[iCount].m_i32Last = REQ_LINK_NONE;
+	}
+	g_oTimeOutTracker.m_iCount = 0;
+	g_oTimeOutTracker.m_u64WheelMs = getTimeoutClockMs();
+	atomic_store(&g_oTimeOutTracker.m_iIsLocked, 0);
+
+	printf("Timeout tracker is configured\n");
+	return 0;
+} // End of initTimeoutTrackerArray
+#endif
+/**
+ *
+ * @fn int initRespStructs(const stStackInitConfig_t *a_pstConfig)
+ *
+ * @brief This function starts response dispatcher threads and, in TCP mode, timeout
+ * tracker and event loops serving devices.
+ *
+ * @param a_pstConfig [in] const stStackInitConfig_t* validated stack configuration
+ *
+ * @return [out] int  0 if function succeeds in initialization;
+ * 					  -1 if function fails to initialize
+ */
+int initRespStructs(const stStackInitConfig_t *a_pstConfig)
+{
+	uint32_t u32Dispatcher = 0;
+
+	g_stRespProcess.m_u32DispatcherCount = 0;
+	if(NULL == a_pstConfig || 0 == a_pstConfig->m_u32RespDispatchers ||
+			a_pstConfig->m_u32RespDispatchers > MAX_RESP_DISPATCHERS)
+	{
+		return -1;
+	}
+	// Initiate response dispatcher threads
+	for(u32Dispatcher = 0; u32Dispatcher < a_pstConfig->m_u32RespDispatchers; u32Dispatcher++)
+	{
+		stRespDispatcher_t *pstDispatcher = &g_stRespProcess.m_astDispatcher[u32Dispatcher];
+		thread_Create_t stThreadParam1 = { 0 };
+
+		// response thread sleeps on eventfd doorbell of its queue. Each request node is
+		// in at most one response queue, so a queue of pool size is never full.
+		pstDispatcher->m_i32RespMsgQueId = OSAL_Init_Event_Message_Queue(a_pstConfig->m_u32ReqPoolMaxSize);
+		if(-1 == pstDispatcher->m_i32RespMsgQueId)
+		{
+			 return -1;
+		}
+
+		stThreadParam1.dwStackSize = 0;
+		stThreadParam1.lpStartAddress = postResponseToApp;
+		stThreadParam1.lpParameter = pstDispatcher;
+		stThreadParam1.lpThreadId = &pstDispatcher->m_threadIdRespToApp;
+
+		// osal create thread
+		pstDispatcher->m_threadIdRespToApp = Osal_Thread_Create(&stThreadParam1);
+
+		if(-1 == pstDispatcher->m_threadIdRespToApp)
+		{
+			// error
+			OSAL_Delete_Message_Queue(pstDispatcher->m_i32RespMsgQueId);
+			return -1;
+		}
+		// dispatcher is published only when its queue and thread are ready
+		g_stRespProcess.m_u32DispatcherCount = u32Dispatcher + 1;
+	}
+
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+	// timed out requests are posted to dispatchers, so start tracker after them
+	if(0 > initTimeoutTrackerArray())
+	{
+		printf("Timeout tracker array init failed\n");
+		return -1;
+	}
+	if(false == initReactors(a_pstConfig))
+	{
+		printf("Event loops init failed\n");
+		return -1;
+	}
+#endif
+	return 0;
+} // End of initRespStructs
+
+/**
+ *
+ * @fn void deinitRespStructs(void)
+ *
+ * @brief This function de-initializes data structures related to response processing.
+ *
+ * @param none
+ *
+ * @return Nothing
+ */
+void deinitRespStructs(void)
+{
+	uint32_t u32Dispatcher = 0;
+
+	// 3 steps:
+	// Deinit event loops, which poll timeout timer
+	// Deinit response timeout mechanism
+	// Deinit threads which post responses to app
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+	deinitReactors();
+	deinitTimeoutTrackerArray();
+#endif
+
+	// De-Initiate response dispatcher threads
+	for(u32Dispatcher = 0; u32Dispatcher < g_stRespProcess.m_u32DispatcherCount; u32Dispatcher++)
+	{
+		stRespDispatcher_t *pstDispatcher = &g_stRespProcess.m_astDispatcher[u32Dispatcher];
+
+		// terminate the thread
+		Osal_Thread_Terminate(pstDispatcher->m_threadIdRespToApp);
+		if(pstDispatcher->m_i32RespMsgQueId)
+		{
+			// deallocate memory allocated for message queue
+			OSAL_Delete_Message_Queue(pstDispatcher->m_i32RespMsgQueId);
+		}
+	}
+	g_stRespProcess.m_u32DispatcherCount = 0;
+} // End of deinitRespStructs
+
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+/**
+ * @fn void deinitTimeoutTrackerArray(void)
+ *
+ * @brief This function de-initializes the timeout tracker data structure and its timer.
+ *
+ * @param none
+ *
+ * @return none
+ */
+void deinitTimeoutTrackerArray(void)
+{
+	if(g_oTimeOutTracker.m_iTimerFd > 0)
+	{
+		close(g_oTimeOutTracker.m_iTimerFd);
+		g_oTimeOutTracker.m_iTimerFd = -1;
+	}
+	if(NULL != g_oTimeOutTracker.m_hTimerMutex)
+	{
+		Osal_Close_Mutex(g_oTimeOutTracker.m_hTimerMutex);
+		g_oTimeOutTracker.m_hTimerMutex = NULL;
+	}
+	g_oTimeOutTracker.m_iCount = 0;
+} // End of deinitTimeoutTrackerArray
+
+/**
+ *
+ * @fn int addReqToList(stMbusPacketVariables_t *pstMBusRequesPacket)
+ *
+ * @brief This function adds request to timing wheel for tracking timeout. Deadline is
+ * taken from timeout of request, which is timeout of its context unless a batch
+ * request gives its own; response timeout of stack is used if none is given.
+ *
+ * @param pstMBusRequesPacket [in] stMbusPacketVariables_t* pointer to structure holding
+ * 									 information about the request sent on Modbus slave device
+ *
+ * @return [out] int 0 if function succeeds;
+ *  				 -1 if function fails
+ */
+int addReqToList(stMbusPacketVariables_t *pstMBusRequesPacket)
+{
+	//check NULL pointer
+	if(NULL == pstMBusRequesPacket)
+	{
+		return -1;
+	}
+	stReqHotMeta_t *pstHot = REQ_HOT_META(pstMBusRequesPacket);
+	uint64_t u64NowMs = getTimeoutClockMs();
+	// request timeout, else response timeout of stack
+	uint64_t u64DeadlineMs = u64NowMs + ((0 != pstMBusRequesPacket->m_u32RespTimeoutMs) ?
+			pstMBusRequesPacket->m_u32RespTimeoutMs :
+			(uint64_t)g_stModbusDevConfig.m_lResponseTimeout/1000);
+
+	pstHot->m_u32DeadlineMs = (uint32_t)u64DeadlineMs;
+
+	lockTimeoutTracker();
+	// wheel time is not advanced while wheel is empty, catch up before inserting
+	if((0 == g_oTimeOutTracker.m_iCount) && (u64NowMs > g_oTimeOutTracker.m_u64WheelMs))
+	{
+		g_oTimeOutTracker.m_u64WheelMs = u64NowMs;
+	}
+	addToWheel((int32_t)pstMBusRequesPacket->m_ulMyId, u64DeadlineMs,
+			g_oTimeOutTracker.m_u64WheelMs + 1);
+	g_oTimeOutTracker.m_iCount++;
+	unlockTimeoutTracker();
+
+	// wake event loop earlier only if this request is due before its current deadline
+	armTimeoutTimer(u64DeadlineMs);
+
+	return 0;
+} // End of addReqToList
+
+/**
+ *@fn stMbusPacketVariables_t* markRespRcvd(const stTcpRecvData_t *a_pstConn,
+ *					uint8_t a_u8UnitID, uint16_t a_u16TransactionID)
+ *
+ * @brief This function searches a request with specific unit id (Modbus slave device id) and
+ * transaction id (request id that was sent on Modbus slave device) in request list and
+ * mark as response is received. Node is found from index bits of transaction id. Complete
+ * transaction id including generation must match, so a late response for an earlier use
+ * of the node is not matched. Request must also be sent on the connection response is
+ * received on, since transaction ids are unique only within request pool and not within
+ * a device: generation bits may be zero or reset, so a late response of one device could
+ * otherwise complete a request sent to another device.
+ *
+ * @param a_pstConn 				[in] const stTcpRecvData_t* connection response is received on
+ * @param a_u8UnitID 				[in] uint8_t Modbus slave device ID
+ * @param a_u16TransactionID  		[in] uint16_t request id that was sent on Modbus slave device
+ * @return stMbusPacketVariables_t 	[out] stMbusPacketVariables_t* pointer to structure holding
+ * 										  information; NULL if no request in flight matches
+ */
+stMbusPacketVariables_t* markRespRcvd(const stTcpRecvData_t *a_pstConn, uint8_t a_u8UnitID,
+		uint16_t a_u16TransactionID)
+{
+	//Initialize to NULL;
+	stMbusPacketVariables_t *pstTemp = NULL;
+	uint32_t u32Index = REQ_TID_INDEX(a_u16TransactionID);
+	// validate request id against transaction id
+	if(u32Index < atomic_load(&g_objReqManager.m_u32Committed))
+	{
+		eTransactionState expected = REQ_SENT_ON_NETWORK;
+		// match on hot metadata, payload of request is touched only if it matches
+		stReqHotMeta_t *pstHot = &g_objReqManager.m_pstReqHot[u32Index];
+		// connection is read only after state shows request is sent, so it is the one
+		// stored by markReactorRequestSent() for this use of the node
+		if(a_u8UnitID == pstHot->m_u8UnitID && a_u16TransactionID == pstHot->m_u16TransactionID &&
+				expected == atomic_load(&pstHot->m_state) &&
+				a_pstConn == g_objReqManager.m_pstReqArray[u32Index].m_pstConn)
+		{
+
+			if(true ==
+					atomic_compare_exchange_strong(&pstHot->m_state, &expected, RESP_RCVD_FROM_NETWORK))
+			{
+				pstTemp = &g_objReqManager.m_pstReqArray[u32Index];
+			}
+		}
+	}
+
+	return pstTemp;
+} // End of markRespRcvd
+
+/**
+ * @fn stMbusPacketVariables_t* matchRespHeader(const stTcpRecvData_t *a_pstConn, const uint8_t *a_pu8Header)
+ *
+ * @brief This function finds the request a completely received frame belongs to.
+ * Response is matched with request in flight on the receiving connection using
+ * complete transaction id (generation and node index) and unit id.
+ * A response which does not match is counted as stale.
+ *
+ * @param a_pstConn   [in] const stTcpRecvData_t* connection frame is received on
+ * @param a_pu8Header [in] const uint8_t* valid MBAP header of a complete frame
+ *
+ * @return stMbusPacketVariables_t* [out] request frame belongs to;
+ * 										  NULL if frame is to be dropped
+ */
+stMbusPacketVariables_t* matchRespHeader(const stTcpRecvData_t *a_pstConn, const uint8_t *a_pu8Header)
+{
+	stMbusPacketVariables_t *pstReq = NULL;
+	// Holds the unit id
+	uint8_t  u8UnitID = a_pu8Header[6];
+
+	// Get TxID
+	uByteOrder_t ustByteOrder = {0};
+	ustByteOrder.u16Word = 0;
+	ustByteOrder.TwoByte.u8ByteTwo = a_pu8Header[0];
+	ustByteOrder.TwoByte.u8ByteOne = a_pu8Header[1];
+
+	pstReq = markRespRcvd(a_pstConn, u8UnitID, ustByteOrder.u16Word);
+	if(NULL == pstReq)
+	{
+		// Late response (request timed out or node is reused since), response to a
+		// request sent on another connection or response with unknown transaction id.
+		// Drop it before any copy or decode.
+		atomic_fetch_add(&g_objReqManager.m_u64StaleResp, 1);
+	}
+	return pstReq;
+} // End of matchRespHeader
+
+/**
+ * @fn void addToHandleRespQ(stMbusPacketVariables_t *a_pstReq)
+ *
+ * @brief This function adds a completely received response in response queue.
+ * Response is already in buffer of the request found by matchRespHeader().
+ *
+ * @param a_pstReq [in] stMbusPacketVariables_t* request with complete response
+ *
+ * @return [out] none
+ */
+void addToHandleRespQ(stMbusPacketVariables_t *a_pstReq)
+{
+	if(NULL != a_pstReq)
+	{
+		// Initialize response received timestamp
+		timespec_get(&(a_pstReq->m_objTimeStamps.tsRespRcvd), TIME_UTC);
+		// Add to response queue for further processing
+		addToRespQ(a_pstReq);
+	}
+
+	return;
+} // End of addToHandleRespQ
+
+/**
+ * @fn static void failReactorRequest(stMbusPacketVariables_t *a_pstReq, t_Status a_eStatus)
+ *
+ * @brief This function completes a request which could not be sent with given error.
+ *
+ * @param a_pstReq 	[in] stMbusPacketVariables_t* request
+ * @param a_eStatus [in] t_Status error to complete request with
+ *
+ * @return [out] none
+ */
+static void failReactorRequest(stMbusPacketVariables_t *a_pstReq, t_Status a_eStatus)
+{
+	a_pstReq->m_pstBatchNext = NULL;
+	a_pstReq->m_u8ProcessReturn = a_eStatus;
+	a_pstReq->m_u8CommandStatus = a_eStatus;
+	REQ_HOT_META(a_pstReq)->m_state = REQ_PROCESS_ERROR;
+	// add to error response to queue
+	addToRespQ(a_pstReq);
+} // End of failReactorRequest
+
+/**
+ * @fn static void failReactorRequests(stReactorSession_t *a_pstSession, t_Status a_eStatus)
+ *
+ * @brief This function completes all requests of a session which are not sent yet
+ * with given error, including requests held back by in-flight window.
+ *
+ * @param a_pstSession 	[in] stReactorSession_t* session
+ * @param a_eStatus 	[in] t_Status error to complete requests with
+ *
+ * @return [out] none
+ */
+static void failReactorRequests(stReactorSession_t *a_pstSession, t_Status a_eStatus)
+{
+	stMbusPacketVariables_t *apstLists[] = { a_pstSession->m_pstPendHead, a_pstSession->m_pstHeld };
+
+	a_pstSession->m_pstPendHead = NULL;
+	a_pstSession->m_pstPendTail = NULL;
+	a_pstSession->m_pstHeld = NULL;
+	a_pstSession->m_u16PendOffset = 0;
+	for(size_t szList = 0; szList < sizeof(apstLists) / sizeof(apstLists[0]); szList++)
+	{
+		stMbusPacketVariables_t *pstReq = apstLists[szList];
+		while(NULL != pstReq)
+		{
+			// node may be freed once it is posted, take next link first
+			stMbusPacketVariables_t *pstNext = pstReq->m_pstBatchNext;
+			failReactorRequest(pstReq, a_eStatus);
+			pstReq = pstNext;
+		}
+	}
+} // End of failReactorRequests
+
+/**
+ * @fn static void failReactorQueue(stReactorSession_t *a_pstSession, t_Status a_eStatus)
+ *
+ * @brief This function completes requests left in context queue of a session with given
+ * error. It is called when session is detached, since queue is deleted along with its
+ * messages afterwards and requests held back by in-flight window may still be in it.
+ *
+ * @param a_pstSession 	[in] stReactorSession_t* session
+ * @param a_eStatus 	[in] t_Status error to complete requests with
+ *
+ * @return [out] none
+ */
+static void failReactorQueue(stReactorSession_t *a_pstSession, t_Status a_eStatus)
+{
+	Linux_Msg_t astMsgs[REACTOR_MAX_SUBMIT_BATCH];
+	int32_t i32Count = 0;
+
+	while((i32Count = OSAL_Poll_Message_Batch(astMsgs, REACTOR_MAX_SUBMIT_BATCH, a_pstSession->m_i32MsgQId)) > 0)
+	{
+		for(int32_t i32Msg = 0; i32Msg < i32Count; i32Msg++)
+		{
+			stMbusPacketVariables_t *pstReq = astMsgs[i32Msg].lParam;
+			while(NULL != pstReq)
+			{
+				// node may be freed once it is posted, take next link first
+				stMbusPacketVariables_t *pstNext = pstReq->m_pstBatchNext;
+				failReactorRequest(pstReq, a_eStatus);
+				pstReq = pstNext;
+			}
+		}
+	}
+} // End of failReactorQueue
+
+/**
+ * @fn static stReactorFdTable_t* allocReactorFdTable(uint32_t a_u32Size)
+ *
+ * @brief This function allocates an empty descriptor table of an event loop.
+ *
+ * @param a_u32Size [in] uint32_t number of entries
+ *
+ * @return [out] stReactorFdTable_t* table; NULL if memory is not available
+ */
+static stReactorFdTable_t* allocReactorFdTable(uint32_t a_u32Size)
+{
+	stReactorFdTable_t *pstTable = calloc(1, sizeof(stReactorFdTable_t) +
+			a_u32Size * sizeof(stReactorSession_t *));
+	if(NULL != pstTable)
+	{
+		pstTable->m_u32Size = a_u32Size;
+	}
+	return pstTable;
+} // End of allocReactorFdTable
+
+/**
+ * @fn static void freeReactorFdTable(stReactorFdTable_t *a_pstTable)
+ *
+ * @brief This function frees descriptor table of an event loop along with
+ * all tables it replaced.
+ *
+ * @param a_pstTable [in] stReactorFdTable_t* current table
+ *
+ * @return [out] none
+ */
+static void freeReactorFdTable(stReactorFdTable_t *a_pstTable)
+{
+	while(NULL != a_pstTable)
+	{
+		stReactorFdTable_t *pstRetired = a_pstTable->m_pstRetired;
+		free(a_pstTable);
+		a_pstTable = pstRetired;
+	}
+} // End of freeReactorFdTable
+
+/**
+ * @fn static bool setReactorFdSession(stReactor_t *a_pstReactor, int a_iFd,
+ * 								stReactorSession_t *a_pstSession)
+ *
+ * @brief This function sets session owning a descriptor in descriptor table of an event
+ * loop. Entry is set before descriptor is registered with epoll and cleared after it is
+ * removed. Table is changed under mutex of event loop, while event loop reads it without
+ * lock: when descriptor does not fit, entries are copied in a table of double size which
+ * then replaces current one.
+ *
+ * @param a_pstReactor 	[in] stReactor_t* event loop
+ * @param a_iFd 		[in] int descriptor
+ * @param a_pstSession 	[in] stReactorSession_t* session owning descriptor; NULL to clear entry
+ *
+ * @return [out] bool true if entry is set;
+ * 					  false if table cannot grow
+ */
+static bool setReactorFdSession(stReactor_t *a_pstReactor, int a_iFd,
+		stReactorSession_t *a_pstSession)
+{
+	stReactorFdTable_t *pstTable = NULL;
+	bool bRet = true;
+
+	if(a_iFd < 0)
+	{
+		return false;
+	}
+	if(0 != Osal_Wait_Mutex(a_pstReactor->m_hMutex))
+	{
+		// fail to lock mutex
+		return false;
+	}
+	pstTable = atomic_load_explicit(&a_pstReactor->m_pstFdTable, memory_order_relaxed);
+	if((uint32_t)a_iFd >= pstTable->m_u32Size && NULL != a_pstSession)
+	{
+		uint32_t u32NewSize = pstTable->m_u32Size;
+		stReactorFdTable_t *pstNewTable = NULL;
+
+		while((uint32_t)a_iFd >= u32NewSize)
+		{
+			u32NewSize *= 2;
+		}
+		pstNewTable = allocReactorFdTable(u32NewSize);
+		if(NULL == pstNewTable)
+		{
+			printf("Event loop %u: unable to grow descriptor table for %d\n", a_pstReactor->m_u32Index, a_iFd);
+			bRet = false;
+		}
+		else
+		{
+			for(uint32_t u32Fd = 0; u32Fd < pstTable->m_u32Size; u32Fd++)
+			{
+				atomic_init(&pstNewTable->m_apstSessions[u32Fd],
+						atomic_load_explicit(&pstTable->m_apstSessions[u32Fd], memory_order_relaxed));
+			}
+			pstNewTable->m_pstRetired = pstTable;
+			atomic_store_explicit(&a_pstReactor->m_pstFdTable, pstNewTable, memory_order_release);
+			pstTable = pstNewTable;
+		}
+	}
+	// descriptor beyond table has no entry to clear
+	if(true == bRet && (uint32_t)a_iFd < pstTable->m_u32Size)
+	{
+		atomic_store_explicit(&pstTable->m_apstSessions[a_iFd], a_pstSession, memory_order_release);
+	}
+	Osal_Release_Mutex(a_pstReactor->m_hMutex);
+	return bRet;
+} // End of setReactorFdSession
+
+/**
+ * @fn static stReactorSession_t* getReactorFdSession(stReactor_t *a_pstReactor, int a_iFd)
+ *
+ * @brief This function finds session owning a descriptor in descriptor table of an
+ * event loop. It is called by event loop thread without lock.
+ *
+ * @param a_pstReactor 	[in] stReactor_t* event loop
+ * @param a_iFd 		[in] int descriptor
+ *
+ * @return [out] stReactorSession_t* session; NULL if descriptor has no session
+ */
+static stReactorSession_t* getReactorFdSession(stReactor_t *a_pstReactor, int a_iFd)
+{
+	stReactorFdTable_t *pstTable = atomic_load_explicit(&a_pstReactor->m_pstFdTable, memory_order_acquire);
+
+	if(a_iFd < 0 || (uint32_t)a_iFd >= pstTable->m_u32Size)
+	{
+		return NULL;
+	}
+	return atomic_load_explicit(&pstTable->m_apstSessions[a_iFd], memory_order_acquire);
+} // End of getReactorFdSession
+
+/**
+ * @fn static void unlinkReactorConnecting(stReactorSession_t *a_pstSession)
+ *
+ * @brief This function removes a session from sessions of its event loop with connect
+ * in progress.
+ *
+ * @param a_pstSession [in] stReactorSession_t* session with connect in progress
+ *
+ * @return [out] none
+ */
+static void unlinkReactorConnecting(stReactorSession_t *a_pstSession)
+{
+	if(NULL != a_pstSession->m_pstConnPrev)
+	{
+		a_pstSession->m_pstConnPrev->m_pstConnNext = a_pstSession->m_pstConnNext;
+	}
+	else
+	{
+		a_pstSession->m_pstReactor->m_pstConnecting = a_pstSession->m_pstConnNext;
+	}
+	if(NULL != a_pstSession->m_pstConnNext)
+	{
+		a_pstSession->m_pstConnNext->m_pstConnPrev = a_pstSession->m_pstConnPrev;
+	}
+	a_pstSession->m_pstConnNext = NULL;
+	a_pstSession->m_pstConnPrev = NULL;
+} // End of unlinkReactorConnecting
+
+/**
+ * @fn static void closeReactorConnection(stReactorSession_t *a_pstSession)
+ *
+ * @brief This function removes socket of a session from its event loop and
+ * closes it. Requests in flight on the connection time out; a response partially
+ * received completes its request with receive error. A request partially sent is
+ * sent again from start on next connection.
+ *
+ * @param a_pstSession [in] stReactorSession_t* session
+ *
+ * @return [out] none
+ */
+static void closeReactorConnection(stReactorSession_t *a_pstSession)
+{
+	if(0 != a_pstSession->m_stIPConnect.m_sockfd)
+	{
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+		if(a_pstSession->m_pstReactor->m_bUring)
+		{
+			// operations on socket complete once they are cancelled
+			cancelUringOps(a_pstSession);
+		}
+		else
+#endif
+		{
+			struct epoll_event stEvent = { 0 };
+			if(epoll_ctl(a_pstSession->m_pstReactor->m_iEpollFd, EPOLL_CTL_DEL,
+					a_pstSession->m_stIPConnect.m_sockfd, &stEvent))
+			{
+				perror("Failed to delete file descriptor from epoll:");
+			}
+			setReactorFdSession(a_pstSession->m_pstReactor, a_pstSession->m_stIPConnect.m_sockfd, NULL);
+		}
+		if(SOCK_CONNECT_INPROGRESS == a_pstSession->m_stIPConnect.m_lastConnectStatus)
+		{
+			unlinkReactorConnecting(a_pstSession);
+		}
+		resetEPollClientDataStruct(&a_pstSession->m_stRecv);
+		closeConnection(&a_pstSession->m_stIPConnect);
+	}
+	a_pstSession->m_u16PendOffset = 0;
+} // End of closeReactorConnection
+
+/**
+ * @fn static bool registerReactorSocket(stReactorSession_t *a_pstSession)
+ *
+ * @brief This function registers socket of a session with its event loop. With epoll,
+ * socket is edge triggered for both readability and writability: first writability
+ * signals that connect is complete, later ones signal that send buffer has room again.
+ * With io_uring, completion of connect is polled, or receive is started if socket is
+ * already connected.
+ *
+ * @param a_pstSession [in] stReactorSession_t* session with socket
+ *
+ * @return [out] bool true if socket is registered;
+ * 					  false otherwise
+ */
+static bool registerReactorSocket(stReactorSession_t *a_pstSession)
+{
+	IP_Connect_t *pstConn = &a_pstSession->m_stIPConnect;
+	struct epoll_event stEvent = { 0 };
+
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+	if(a_pstSession->m_pstReactor->m_bUring)
+	{
+		if(SOCK_CONNECT_INPROGRESS == pstConn->m_lastConnectStatus)
+		{
+			struct io_uring_sqe *pstSqe = getUringSqe(a_pstSession->m_pstReactor, a_pstSession, URING_OP_CONNECT);
+			if(NULL == pstSqe)
+			{
+				return false;
+			}
+			pstSqe->opcode = IORING_OP_POLL_ADD;
+			pstSqe->fd = pstConn->m_sockfd;
+			pstSqe->poll32_events = POLLOUT;
+			a_pstSession->m_bConnArmed = true;
+		}
+		else
+		{
+			armUringRecv(a_pstSession);
+		}
+		return true;
+	}
+#endif
+	stEvent.events = EPOLLIN | EPOLLOUT | EPOLLET;
+	stEvent.data.fd = pstConn->m_sockfd;
+	if(false == setReactorFdSession(a_pstSession->m_pstReactor, pstConn->m_sockfd, a_pstSession))
+	{
+		return false;
+	}
+	if(epoll_ctl(a_pstSession->m_pstReactor->m_iEpollFd, EPOLL_CTL_ADD, pstConn->m_sockfd, &stEvent))
+	{
+		perror("Failed to add file descriptor to epoll:");
+		setReactorFdSession(a_pstSession->m_pstReactor, pstConn->m_sockfd, NULL);
+		return false;
+	}
+	return true;
+} // End of registerReactorSocket
+
+/**
+ * @fn static bool connectReactorSession(stReactorSession_t *a_pstSession)
+ *
+ * @brief This function starts connecting session with its device. Socket is registered
+ * with its event loop by registerReactorSocket().
+ * Connect must complete within connect timeout of session. If connect cannot be
+ * started, requests not sent yet are completed with error.
+ *
+ * @param a_pstSession [in] stReactorSession_t* session
+ *
+ * @return [out] bool true if connect is started or done;
+ * 					  false otherwise
+ */
+static bool connectReactorSession(stReactorSession_t *a_pstSession)
+{
+	IP_Connect_t *pstConn = &a_pstSession->m_stIPConnect;
+	t_Status eStatus = Modbus_StartConnect(pstConn);
+
+	if(STS_MBUS_STACK_NO_ERROR == eStatus)
+	{
+		if(false == registerReactorSocket(a_pstSession))
+		{
+			eStatus = STS_MBUS_STACK_ERROR_SOCKET_LISTEN_FAILED;
+			closeConnection(pstConn);
+		}
+		else
+		{
+			uint64_t u64TimeoutMs = (0 != a_pstSession->m_u32ConnectTimeoutMs) ?
+					a_pstSession->m_u32ConnectTimeoutMs : (uint64_t)g_stModbusDevConfig.m_lResponseTimeout/1000;
+			if(0 == u64TimeoutMs)
 			{
-				if(EEXIST != errno)
-				{
-					perror("Failed to add file descriptor to epoll:");
-					ret = -1;
-				}
+				// stack configuration is not set
+				u64TimeoutMs = DEFAULT_RESPONSE_TIMEOUT_MS;
 			}
-			if(ret == 0)
+			pstConn->m_bIsAddedToEPoll = true;
+			if(SOCK_CONNECT_INPROGRESS == pstConn->m_lastConnectStatus)
 			{
-				// Set 2 way-references
-				m_clientAccepted[index].m_pstConRef = a_pstIPConnect;
-				a_pstIPConnect->m_iRcvConRef = index;
-				ret = index;
-				//printf("adding ref: %d", ret);
+				stReactor_t *pstReactor = a_pstSession->m_pstReactor;
+				a_pstSession->m_pstConnPrev = NULL;
+				a_pstSession->m_pstConnNext = pstReactor->m_pstConnecting;
+				if(NULL != pstReactor->m_pstConnecting)
+				{
+					pstReactor->m_pstConnecting->m_pstConnPrev = a_pstSession;
+				}
+				pstReactor->m_pstConnecting = a_pstSession;
 			}
+			a_pstSession->m_u64ConnectDeadlineMs = getTimeoutClockMs() + u64TimeoutMs;
 		}
-		if(0 != Osal_Release_Mutex (EPollMutex))
-		{
-			// fail to unlock mutex
-			return -1;
-		}
-		return ret;
 	}
-	return -1;
-} // End of addtoEPollList
+	if(STS_MBUS_STACK_NO_ERROR != eStatus)
+	{
+		failReactorRequests(a_pstSession, eStatus);
+		return false;
+	}
+	return true;
+} // End of connectReactorSession
 
 /**
+ * @fn static void markReactorRequestSent(stReactorSession_t *a_pstSession)
  *
- * @fn struct timespec getEpochTime()
- *
- * @brief This function gets the current epoch time
+ * @brief This function takes first request not sent yet of a session once it is sent
+ * completely and adds it to timing wheel. Response is received by the same thread,
+ * so it cannot be matched before the request is tracked.
  *
- * @param none
+ * @param a_pstSession [in] stReactorSession_t* session
  *
- * @return struct timespec [out] epoch time struct
+ * @return [out] none
  */
-struct timespec getEpochTime()
+static void markReactorRequestSent(stReactorSession_t *a_pstSession)
 {
+	stMbusPacketVariables_t *pstReq = a_pstSession->m_pstPendHead;
 
-	struct timespec ts;
-    timespec_get(&ts, TIME_UTC);
-
-    return ts;
-} // End of getEpochTime
+	a_pstSession->m_pstPendHead = pstReq->m_pstBatchNext;
+	if(NULL == a_pstSession->m_pstPendHead)
+	{
+		a_pstSession->m_pstPendTail = NULL;
+	}
+	a_pstSession->m_u16PendOffset = 0;
+	pstReq->m_pstBatchNext = NULL;
+	pstReq->m_u8ProcessReturn = STS_MBUS_STACK_NO_ERROR;
+	pstReq->m_u8CommandStatus = STS_MBUS_STACK_NO_ERROR;
+	// Init req sent timestamp
+	timespec_get(&(pstReq->m_objTimeStamps.tsReqSent), TIME_UTC);
+	pstReq->m_pstConn = &a_pstSession->m_stRecv;
+	REQ_HOT_META(pstReq)->m_state = REQ_SENT_ON_NETWORK;
+	addReqToList(pstReq);
+} // End of markReactorRequestSent
 
 /**
+ * @fn static void flushReactorSession(stReactorSession_t *a_pstSession)
  *
- * @fn void* EpollRecvThread()
+ * @brief This function sends requests of a session which are not sent yet, in order.
+ * Connection is established first if there is none. Sending stops when send buffer of
+ * socket is full; rest is sent when socket becomes writable again. Once a request is
+ * sent completely, it is added to timing wheel. With io_uring, requests are sent by
+ * armUringSend() instead.
  *
- * @brief This function is a thread routine to start polling on sockets registered with epoll to receive data.
- * This function sets the thread priority as per the configuration. It then allocates the number of polling events
- * the can occur and thus initializes epoll descriptors event structure.
- * Function then waits for events to occur on registered socket descriptors. If any socket descriptor notifies
- * of incoming response, epoll notifies it to the function. Function then iterates through all the socket descriptors
- * and reads the response data. In order to read the data, the function first reads only 6 bytes from the response
- * and parses the length of the response. Then calculates the number of bytes to be read from that socket descriptor.
- * It keeps on reading till a complete response is not received or if it has read 0 bytes, it goes to read from the
- * next socket descriptor.
- * Once the complete response is received, function adds it to the request manager's queue to process further
- * and resets the socket descriptor to be used for next request.
+ * @param a_pstSession [in] stReactorSession_t* session
  *
- * @param  none
  * @return [out] none
- *
  */
-void* EpollRecvThread(void)
+static void flushReactorSession(stReactorSession_t *a_pstSession)
 {
-	int event_count = 0;
-	size_t bytes_read = 0;
-	size_t bytes_to_read = 0;
-
-	// set thread priority
-	set_thread_sched_param();
-
-	// allocate no of polling events
-	m_events = (struct epoll_event*) calloc(MAXEVENTS, sizeof(struct epoll_event));
+	IP_Connect_t *pstConn = &a_pstSession->m_stIPConnect;
 
-	if(NULL == m_events)
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+	if(a_pstSession->m_pstReactor->m_bUring)
 	{
-		return NULL;
+		armUringSend(a_pstSession);
+		return;
 	}
+#endif
 
-	while (true != g_bThreadExit)
+	while(NULL != a_pstSession->m_pstPendHead)
 	{
-		event_count = 0;
-
-		event_count = epoll_wait(m_epollFd, m_events, MAXEVENTS, EPOLL_TIMEOUT);
+		stMbusPacketVariables_t *pstReq = a_pstSession->m_pstPendHead;
+		const MbusTXData_t *pstTxData = &pstReq->m_stMbusTxData;
+		ssize_t iSent = 0;
 
-		// addressed review comment
-		if(0 != Osal_Wait_Mutex(EPollMutex))
+		if(0 == pstConn->m_sockfd && false == connectReactorSession(a_pstSession))
 		{
-			// fail to lock mutex
-			continue;
+			return;
 		}
-
-		for (int i = 0; i < event_count; i++)
+		if(SOCK_CONNECT_INPROGRESS == pstConn->m_lastConnectStatus)
 		{
-			int clientID = getClientIdFromList(m_events[i].data.fd);
-
-			if (clientID == -1)
-			{
-				continue;
-			}
-			if(NULL == m_clientAccepted[clientID].m_pstConRef)
-			{
-				continue;
-			}
-
-			//if there are still bytes remaining to be read for this socket, adjust read size accordingly
-			if (m_clientAccepted[clientID].m_bytesToBeRead > 0)
-			{
-				bytes_to_read = m_clientAccepted[clientID].m_bytesToBeRead;
-			}
-			else
-			{
-				bytes_to_read = MODBUS_HEADER_LENGTH; //read only header till length
-			}
-
-			//receive data from socket
-			bytes_read = recv(m_clientAccepted[clientID].m_pstConRef->m_sockfd,
-					m_clientAccepted[clientID].m_readBuffer+m_clientAccepted[clientID].m_bytesRead, bytes_to_read, 0);
-
+			// requests are sent once connect is complete
+			return;
+		}
 
-			if (bytes_read == 0)
+		// in order to avoid application stop whenever SIGPIPE gets generated,
+		// used send function with MSG_NOSIGNAL argument
+		iSent = send(pstConn->m_sockfd, pstTxData->m_au8DataFields + a_pstSession->m_u16PendOffset,
+				pstTxData->m_u16Length - a_pstSession->m_u16PendOffset, MSG_NOSIGNAL | MSG_DONTWAIT);
+		if(iSent < 0)
+		{
+			if(EINTR == errno)
 			{
-				// No data received, check for new socket
 				continue;
 			}
-
-			//parse length if fd has 0 bytes read, otherwise rest packets are with actual data and not header
-			if (m_clientAccepted[clientID].m_bytesRead == 0)
+			if(EAGAIN == errno || EWOULDBLOCK == errno)
 			{
-				m_clientAccepted[clientID].m_len = (m_clientAccepted[clientID].m_readBuffer[4] << 8
-						| m_clientAccepted[clientID].m_readBuffer[5]);
+				// send buffer is full, continue on next writability edge
+				return;
 			}
-
-			if (bytes_to_read == bytes_read)
+			printf("Error %d occurred while sending request on %d closing the socket\n", errno, pstConn->m_sockfd);
+			a_pstSession->m_pstPendHead = pstReq->m_pstBatchNext;
+			if(NULL == a_pstSession->m_pstPendHead)
 			{
-				m_clientAccepted[clientID].m_bytesRead += bytes_read;
-
-				m_clientAccepted[clientID].m_bytesToBeRead =
-						(m_clientAccepted[clientID].m_len + MODBUS_HEADER_LENGTH)
-								- m_clientAccepted[clientID].m_bytesRead;
+				a_pstSession->m_pstPendTail = NULL;
 			}
+			failReactorRequest(pstReq, STS_MBUS_STACK_ERROR_SEND_FAILED);
+			// next request is sent on a new connection
+			closeReactorConnection(a_pstSession);
+			continue;
+		}
+		a_pstSession->m_u16PendOffset += (uint16_t)iSent;
+		if(a_pstSession->m_u16PendOffset < pstTxData->m_u16Length)
+		{
+			continue;
+		}
 
-			//add one more recv to read response completely
-			if (m_clientAccepted[clientID].m_bytesToBeRead > 0)
-			{
-				while (m_clientAccepted[clientID].m_bytesToBeRead != 0)
-					{
-					bytes_to_read = m_clientAccepted[clientID].m_bytesToBeRead;
-
-					//receive data from socket
-					bytes_read = recv(m_clientAccepted[clientID].m_pstConRef->m_sockfd,
-								m_clientAccepted[clientID].m_readBuffer+m_clientAccepted[clientID].m_bytesRead,
-								bytes_to_read, 0);
-
-					if(bytes_read < 0)
-					{
-						//recv failed with error
-						perror("Recv() failed : ");
-						//Close the connection and mark socket invalid
-						removeEPollRefNoLock(clientID);
-						closeConnection(m_clientAccepted[clientID].m_pstConRef);
-
-						break;
-					}
-					else
-					{
-						if (bytes_read == 0)
-						{
-							// there is no data read. Let's check new thing
-							break;
-						}
-
-						m_clientAccepted[clientID].m_bytesRead += bytes_read;
-
-						m_clientAccepted[clientID].m_bytesToBeRead =
-								(m_clientAccepted[clientID].m_len + MODBUS_HEADER_LENGTH)
-										- m_clientAccepted[clientID].m_bytesRead;
-					}
-				}
+		markReactorRequestSent(a_pstSession);
+	}
+} // End of flushReactorSession
 
-				//should have read response completely
-				if ((m_clientAccepted[clientID].m_len + MODBUS_HEADER_LENGTH)
-						== m_clientAccepted[clientID].m_bytesRead)
-				{
-					addToHandleRespQ(&m_clientAccepted[clientID]);
+/**
+ * @fn static void appendReactorRequests(stReactorSession_t *a_pstSession,
+ * 								stMbusPacketVariables_t *a_pstChain, uint32_t *a_pu32Free)
+ *
+ * @brief This function appends a chain of requests to requests not sent yet, as many as
+ * in-flight window of the session's context allows. Each appended request takes a slot
+ * of the window. Rest of the chain is held back, and so is every chain appended while
+ * requests are held back, to keep order of requests.
+ *
+ * @param a_pstSession 	[in] stReactorSession_t* session
+ * @param a_pstChain 	[in] stMbusPacketVariables_t* chain of requests; may be NULL
+ * @param a_pu32Free 	[in,out] uint32_t* free slots of window, UINT32_MAX for no window
+ *
+ * @return [out] none
+ */
+static void appendReactorRequests(stReactorSession_t *a_pstSession, stMbusPacketVariables_t *a_pstChain,
+		uint32_t *a_pu32Free)
+{
+	stMbusPacketVariables_t *pstLast = NULL;
 
-					//clear socket struct for next iteration
-					resetEPollClientDataStruct(&m_clientAccepted[clientID]);
+	if(NULL == a_pstChain)
+	{
+		return;
+	}
+	if(NULL != a_pstSession->m_pstHeld)
+	{
+		pstLast = a_pstSession->m_pstHeld;
+		while(NULL != pstLast->m_pstBatchNext)
+		{
+			pstLast = pstLast->m_pstBatchNext;
+		}
+		pstLast->m_pstBatchNext = a_pstChain;
+		return;
+	}
 
-				}
-				else
-				{
-					//this case should never happen ideally
-					//continue to read for the same socket & epolling
-					continue;
-				}
+	if(UINT32_MAX == *a_pu32Free)
+	{
+		pstLast = a_pstChain;
+		while(NULL != pstLast->m_pstBatchNext)
+		{
+			pstLast = pstLast->m_pstBatchNext;
+		}
+	}
+	else
+	{
+		for(stMbusPacketVariables_t *pstReq = a_pstChain; NULL != pstReq && 0 != *a_pu32Free;
+				pstReq = pstReq->m_pstBatchNext)
+		{
+			chargeReqWindow(pstReq);
+			(*a_pu32Free)--;
+			pstLast = pstReq;
+		}
+		if(NULL == pstLast)
+		{
+			a_pstSession->m_pstHeld = a_pstChain;
+			return;
+		}
+		a_pstSession->m_pstHeld = pstLast->m_pstBatchNext;
+		pstLast->m_pstBatchNext = NULL;
+	}
 
-			}
-		} //for loop for sockets ends
+	if(NULL == a_pstSession->m_pstPendTail)
+	{
+		a_pstSession->m_pstPendHead = a_pstChain;
+	}
+	else
+	{
+		a_pstSession->m_pstPendTail->m_pstBatchNext = a_pstChain;
+	}
+	a_pstSession->m_pstPendTail = pstLast;
+} // End of appendReactorRequests
 
-		if(0 != Osal_Release_Mutex (EPollMutex))
+/**
+ * @fn static void takeReactorRequests(stReactorSession_t *a_pstSession)
+ *
+ * @brief This function is called when doorbell of a session's context queue rings,
+ * after doorbell is reset. It takes requests from the queue and appends them to
+ * requests not sent yet. Queue is drained till it is empty, which arms doorbell again.
+ * If context has an in-flight window, requests beyond it are left in the queue; doorbell
+ * is rung by releaseReqWindow() once a request of the context completes.
+ *
+ * @param a_pstSession [in] stReactorSession_t* session
+ *
+ * @return [out] none
+ */
+static void takeReactorRequests(stReactorSession_t *a_pstSession)
+{
+	Linux_Msg_t astMsgs[REACTOR_MAX_SUBMIT_BATCH];
+	int32_t i32Count = 0;
+	uint32_t u32Free = getReqCtxWindowFree(a_pstSession->m_i32MsgQId);
+	stMbusPacketVariables_t *pstHeld = a_pstSession->m_pstHeld;
+
+	// requests held back before are taken first
+	a_pstSession->m_pstHeld = NULL;
+	appendReactorRequests(a_pstSession, pstHeld, &u32Free);
+	while(NULL == a_pstSession->m_pstHeld && 0 != u32Free)
+	{
+		// each message holds at least one request
+		int32_t i32MaxMsgs = (u32Free < REACTOR_MAX_SUBMIT_BATCH) ? (int32_t)u32Free : REACTOR_MAX_SUBMIT_BATCH;
+		i32Count = OSAL_Poll_Message_Batch(astMsgs, i32MaxMsgs, a_pstSession->m_i32MsgQId);
+		if(i32Count <= 0)
 		{
-			// fail to unlock mutex
-			continue;
+			break;
 		}
-	} //while ends
+		for(int32_t i32Msg = 0; i32Msg < i32Count; i32Msg++)
+		{
+			// message holds a chain of requests if posted by Modbus_Submit_Batch()
+			appendReactorRequests(a_pstSession, astMsgs[i32Msg].lParam, &u32Free);
+		}
+	}
+} // End of takeReactorRequests
 
-	//close client socket or push all the client sockets in a vector and close all
-	close(m_epollFd);
+/**
+ * @fn static void detachReactorSession(stReactorSession_t *a_pstSession)
+ *
+ * @brief This function is called by event loop when detach of a session is requested.
+ * Doorbell is removed from epoll, connection is closed and requests not sent yet,
+ * including those left in the queue, are completed with send error. Thread waiting in
+ * removeReactorSession() is then woken up to free the session.
+ *
+ * @param a_pstSession [in] stReactorSession_t* session
+ *
+ * @return [out] none
+ */
+static void detachReactorSession(stReactorSession_t *a_pstSession)
+{
+	struct epoll_event stEvent = { 0 };
 
-	if(m_events != NULL)
-		free(m_events);
+	if(epoll_ctl(a_pstSession->m_pstReactor->m_iEpollFd, EPOLL_CTL_DEL, a_pstSession->m_iDoorbellFd, &stEvent))
+	{
+		perror("Failed to delete context queue doorbell from epoll:");
+	}
+	setReactorFdSession(a_pstSession->m_pstReactor, a_pstSession->m_iDoorbellFd, NULL);
+	closeReactorConnection(a_pstSession);
+	failReactorRequests(a_pstSession, STS_MBUS_STACK_ERROR_SEND_FAILED);
+	failReactorQueue(a_pstSession, STS_MBUS_STACK_ERROR_SEND_FAILED);
+	// session must not be touched after this
+	atomic_store(&a_pstSession->m_u32DetachState, REACTOR_SESSION_DETACHED);
+	Osal_Futex_Wake(&a_pstSession->m_u32DetachState, 1);
+} // End of detachReactorSession
 
-	return NULL;
-} // End of EpollRecvThread
+/**
+ * @fn static bool completeReactorConnect(stReactorSession_t *a_pstSession)
+ *
+ * @brief This function checks result of a connect which was in progress once socket
+ * is writable. If connect failed, connection is closed and requests not sent yet are
+ * completed with connect error.
+ *
+ * @param a_pstSession [in] stReactorSession_t* session with connect in progress
+ *
+ * @return [out] bool true if connection is established;
+ * 					  false otherwise
+ */
+static bool completeReactorConnect(stReactorSession_t *a_pstSession)
+{
+	IP_Connect_t *pstConn = &a_pstSession->m_stIPConnect;
+	int iSockErr = 0;
+	socklen_t lon = sizeof(iSockErr);
 
-#else
+	if(0 != getsockopt(pstConn->m_sockfd, SOL_SOCKET, SO_ERROR, &iSockErr, &lon) || 0 != iSockErr)
+	{
+		printf("Connection with Modbus slave failed on socket %d : %d\n", pstConn->m_sockfd, iSockErr);
+		closeReactorConnection(a_pstSession);
+		failReactorRequests(a_pstSession, STS_MBUS_STACK_ERROR_CONNECT_FAILED);
+		return false;
+	}
+	unlinkReactorConnecting(a_pstSession);
+	pstConn->m_lastConnectStatus = SOCK_CONNECT_SUCCESS;
+	printf("Modbus slave connection established on socket %d\n", pstConn->m_sockfd);
+	return true;
+} // End of completeReactorConnect
 
 /**
+ * @fn static void handleReactorSocket(stReactorSession_t *a_pstSession, uint32_t a_u32Events)
  *
- *@fn void* SessionControlThread(void* threadArg)
- *
- * @brief This function is a thread routine to send Modbus RTU messages to Modbus slave device
- * which are available in the Linux message queue. Thread continuously checks for a new message in
- * Linux message queue; once the message is available it sends the request to the Modbus slave device.
- * The Modbus_SendPacket function receives the response from Modbus slave device, after this session
- * control thread function invokes the ModbusApp callback function. After invoking ModbusApp callback
- * function, this function frees up with request node from request manager's list.
+ * @brief This function handles events of a session's socket. Connect in progress is
+ * completed on writability, responses are read and matched on readability and
+ * requests not sent yet are sent. Socket is edge triggered, so all available data
+ * is read and requests are sent till send buffer is full. If connection fails, it is closed; requests not
+ * sent yet are sent on a new connection.
  *
- * @param threadArg [in] void* thread argument
+ * @param a_pstSession 	[in] stReactorSession_t* session
+ * @param a_u32Events 	[in] uint32_t epoll events of socket
  *
  * @return [out] none
- *
  */
-void* SessionControlThread(void* threadArg)
+static void handleReactorSocket(stReactorSession_t *a_pstSession, uint32_t a_u32Events)
 {
-	int32_t i32MsgQueIdSC = 0;
-	Linux_Msg_t stScMsgQue = { 0 };
-	stMbusPacketVariables_t *pstMBusReqPact = NULL;
-	stRTUConnectionData_t stRTUConnectionData = {};
-	t_Status u8ReturnType = 0;
-	stLiveSerSessionList_t pstLivSerSesslist;
+	IP_Connect_t *pstConn = &a_pstSession->m_stIPConnect;
 
-	pstLivSerSesslist = *((stLiveSerSessionList_t *)threadArg);
-	i32MsgQueIdSC = pstLivSerSesslist.MsgQId;
+	if(SOCK_CONNECT_INPROGRESS == pstConn->m_lastConnectStatus)
+	{
+		if(0 == (a_u32Events & (EPOLLOUT | EPOLLERR | EPOLLHUP)))
+		{
+			return;
+		}
+		if(false == completeReactorConnect(a_pstSession))
+		{
+			return;
+		}
+	}
 
-	stRTUConnectionData.m_fd = -1;
-	while(false == g_bThreadExit)
+	if(0 != (a_u32Events & (EPOLLIN | EPOLLERR | EPOLLHUP)))
 	{
-		memset(&stScMsgQue,00,sizeof(stScMsgQue));
-		if(OSAL_Get_Message(&stScMsgQue, i32MsgQueIdSC))
+		if(false == readTcpResponses(&a_pstSession->m_stRecv))
 		{
-			pstMBusReqPact = stScMsgQue.lParam;
-			// Check if connection is established
-			if(stRTUConnectionData.m_fd == -1)
-			{
-				int ret = initSerialPort(&stRTUConnectionData,
-								pstLivSerSesslist.m_portName,
-								pstLivSerSesslist.m_baudrate,
-								pstLivSerSesslist.m_parity,
-								pstLivSerSesslist.m_stopbits);
+			//Close the connection and mark socket invalid
+			closeReactorConnection(a_pstSession);
+		}
+	}
+	flushReactorSession(a_pstSession);
+} // End of handleReactorSocket
 
-				if(-1 == ret)
-				{
-					stRTUConnectionData.m_fd = -1;
-					pstMBusReqPact->m_u8ProcessReturn = STS_MBUS_STACK_ERROR_SERIAL_PORT_ERROR;
-					printf("Failed to initialize serial port for RTU. File descriptor is set to :: %d\n",stRTUConnectionData.m_fd);
-					addToRespQ(pstMBusReqPact);
-					continue;
-				}
-			}
-			u8ReturnType = Modbus_SendPacket(pstMBusReqPact, stRTUConnectionData,
-					pstLivSerSesslist.m_lInterframeDelay, pstLivSerSesslist.m_lrespTimeout);
+/**
+ * @fn static int checkReactorConnects(stReactor_t *a_pstReactor, uint64_t a_u64NowMs)
+ *
+ * @brief This function fails connects of an event loop which did not complete within
+ * connect timeout and finds how long event loop can wait for next connect deadline.
+ * Only sessions with connect in progress are scanned.
+ *
+ * @param a_pstReactor 	[in] stReactor_t* event loop
+ * @param a_u64NowMs 	[in] uint64_t current monotonic time in milliseconds
+ *
+ * @return [out] int timeout for epoll wait in milliseconds
+ */
+static int checkReactorConnects(stReactor_t *a_pstReactor, uint64_t a_u64NowMs)
+{
+	int iTimeout = EPOLL_TIMEOUT;
+	stReactorSession_t *pstSession = a_pstReactor->m_pstConnecting;
 
-			pstMBusReqPact->m_u8ProcessReturn = u8ReturnType;
-			if(STS_MBUS_STACK_NO_ERROR == u8ReturnType)
-			{
-				//pstMBusReqPact->m_state = RESP_RCVD_FROM_NETWORK;
-			}
-			else
-			{
-				addToRespQ(pstMBusReqPact);
-			}
+	while(NULL != pstSession)
+	{
+		// session is unlinked if its connect is failed
+		stReactorSession_t *pstNext = pstSession->m_pstConnNext;
+		if(pstSession->m_u64ConnectDeadlineMs <= a_u64NowMs)
+		{
+			printf("Connect status INPROGRESS. Connect timed out %d\n", pstSession->m_stIPConnect.m_sockfd);
+			closeReactorConnection(pstSession);
+			failReactorRequests(pstSession, STS_MBUS_STACK_ERROR_CONNECT_FAILED);
 		}
-		fflush(stdin);
+		else if(pstSession->m_u64ConnectDeadlineMs - a_u64NowMs < (uint64_t)iTimeout)
+		{
+			iTimeout = (int)(pstSession->m_u64ConnectDeadlineMs - a_u64NowMs);
+		}
+		pstSession = pstNext;
+	}
+	return iTimeout;
+} // End of checkReactorConnects
 
-		// check for thread exit
-		if(g_bThreadExit)
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+/**
+ * @fn static struct io_uring_sqe* getUringSqe(stReactor_t *a_pstReactor,
+ * 								stReactorSession_t *a_pstSession, eUringOp a_eOp)
+ *
+ * @brief This function takes a submission entry of io_uring of an event loop and tags
+ * it with session and operation. Session is allocated with malloc() alignment, which
+ * leaves low bits of its address free for operation. If submission ring is full,
+ * entries filled so far are submitted first. Operation is counted in flight for session.
+ *
+ * @param a_pstReactor 	[in] stReactor_t* event loop
+ * @param a_pstSession 	[in] stReactorSession_t* session; NULL for operation of event loop
+ * @param a_eOp 		[in] eUringOp operation
+ *
+ * @return [out] struct io_uring_sqe* entry to fill;
+ * 				 NULL if no entry is available
+ */
+static struct io_uring_sqe* getUringSqe(stReactor_t *a_pstReactor, stReactorSession_t *a_pstSession,
+		eUringOp a_eOp)
+{
+	struct io_uring_sqe *pstSqe = Osal_Uring_Get_Sqe(&a_pstReactor->m_stUring);
+
+	if(NULL == pstSqe)
+	{
+		// submission ring is full, submit without waiting
+		Osal_Uring_Submit(&a_pstReactor->m_stUring, 0);
+		pstSqe = Osal_Uring_Get_Sqe(&a_pstReactor->m_stUring);
+		if(NULL == pstSqe)
 		{
-			break;
+			printf("Event loop %u: io_uring submission ring is full\n", a_pstReactor->m_u32Index);
+			return NULL;
 		}
 	}
-	return NULL;
-}  // End of SessionControlThread
-#endif
+	pstSqe->user_data = (uint64_t)(uintptr_t)a_pstSession | (uint64_t)a_eOp;
+	if(NULL != a_pstSession)
+	{
+		a_pstSession->m_u32UringOps++;
+	}
+	return pstSqe;
+} // End of getUringSqe
+
+/**
+ * @fn static void armUringRead(stReactor_t *a_pstReactor, stReactorSession_t *a_pstSession,
+ * 								eUringOp a_eOp, int a_iFd, uint64_t *a_pu64Val)
+ *
+ * @brief This function starts reading an eventfd with io_uring. Read completes when
+ * eventfd is written, and resets it.
+ *
+ * @param a_pstReactor 	[in] stReactor_t* event loop
+ * @param a_pstSession 	[in] stReactorSession_t* session; NULL for operation of event loop
+ * @param a_eOp 		[in] eUringOp operation
+ * @param a_iFd 		[in] int eventfd
+ * @param a_pu64Val 	[out] uint64_t* value read
+ *
+ * @return [out] none
+ */
+static void armUringRead(stReactor_t *a_pstReactor, stReactorSession_t *a_pstSession,
+		eUringOp a_eOp, int a_iFd, uint64_t *a_pu64Val)
+{
+	struct io_uring_sqe *pstSqe = getUringSqe(a_pstReactor, a_pstSession, a_eOp);
 
+	if(NULL != pstSqe)
+	{
+		pstSqe->opcode = IORING_OP_READ;
+		pstSqe->fd = a_iFd;
+		pstSqe->addr = (uint64_t)(uintptr_t)a_pu64Val;
+		pstSqe->len = sizeof(uint64_t);
+	}
+} // End of armUringRead
+
+/**
+ * @fn static void armUringPoll(stReactor_t *a_pstReactor, eUringOp a_eOp, int a_iFd)
+ *
+ * @brief This function polls a descriptor of an event loop for readability with io_uring.
+ *
+ * @param a_pstReactor 	[in] stReactor_t* event loop
+ * @param a_eOp 		[in] eUringOp operation
+ * @param a_iFd 		[in] int descriptor
+ *
+ * @return [out] none
+ */
+static void armUringPoll(stReactor_t *a_pstReactor, eUringOp a_eOp, int a_iFd)
+{
+	struct io_uring_sqe *pstSqe = getUringSqe(a_pstReactor, NULL, a_eOp);
+
+	if(NULL != pstSqe)
+	{
+		pstSqe->opcode = IORING_OP_POLL_ADD;
+		pstSqe->fd = a_iFd;
+		pstSqe->poll32_events = POLLIN;
+	}
+} // End of armUringPoll
 
-// when Modbus communication mode is TCP
-#ifdef MODBUS_STACK_TCPIP_ENABLED
 /**
+ * @fn static void armUringTick(stReactor_t *a_pstReactor, int a_iTimeoutMs)
  *
- *@fn unsigned long get_nanos(void)
- *
- * @brief This function gets current time stamp in nano-seconds.
+ * @brief This function starts a timeout with io_uring so that event loop wakes up for
+ * next connect deadline.
  *
- * @param none
+ * @param a_pstReactor 	[in] stReactor_t* event loop
+ * @param a_iTimeoutMs 	[in] int timeout in milliseconds
  *
- * @return [out] unsigned long time in nano-seconds
+ * @return [out] none
  */
-unsigned long get_nanos(void)
+static void armUringTick(stReactor_t *a_pstReactor, int a_iTimeoutMs)
 {
-    struct timespec ts;
-    timespec_get(&ts, TIME_UTC);
-    return (unsigned long)ts.tv_sec * 1000000000L + ts.tv_nsec;
-} // End of get_nanos
+	struct io_uring_sqe *pstSqe = getUringSqe(a_pstReactor, NULL, URING_OP_TICK);
+
+	if(NULL != pstSqe)
+	{
+		a_pstReactor->m_stTick.tv_sec = a_iTimeoutMs / 1000;
+		a_pstReactor->m_stTick.tv_nsec = (long long)(a_iTimeoutMs % 1000) * 1000000;
+		pstSqe->opcode = IORING_OP_TIMEOUT;
+		pstSqe->addr = (uint64_t)(uintptr_t)&a_pstReactor->m_stTick;
+		pstSqe->len = 1;
+		a_pstReactor->m_bTickArmed = true;
+	}
+} // End of armUringTick
 
 /**
+ * @fn static void armUringRecv(stReactorSession_t *a_pstSession)
  *
- * @fn void releaseFromTrackerNode(stMbusPacketVariables_t *a_pstNodeToRemove,
-	struct stTimeOutTrackerNode *a_pstTracker)
- *
- * @brief This function removes request from timeout tracker node.
- * Assumed is calling function has acquired lock.
- *
- * @param pstMBusRequesPacket [in] stMbusPacketVariables_t* pointer to structure holding request
- * 								   sent on Modbus slave device
+ * @brief This function starts receiving responses of a session with io_uring into free
+ * space of its receive buffer, up to end of the buffer. Nothing is done if a receive is
+ * in flight or session has no connection.
  *
- * @param a_pstTracker [in] stTimeOutTrackerNode* reference to timeout tracker list from which
- * 							node needs to be removed
+ * @param a_pstSession [in] stReactorSession_t* session
  *
  * @return [out] none
  */
-void releaseFromTrackerNode(stMbusPacketVariables_t *a_pstNodeToRemove,
-		struct stTimeOutTrackerNode *a_pstTracker)
+static void armUringRecv(stReactorSession_t *a_pstSession)
 {
-	if((NULL == a_pstNodeToRemove) || (NULL == a_pstTracker))
+	stTcpRecvData_t *pstRecv = &a_pstSession->m_stRecv;
+	struct io_uring_sqe *pstSqe = NULL;
+	uint32_t u32Free = 0;
+	uint32_t u32Off = 0;
+	uint32_t u32First = 0;
+
+	if(a_pstSession->m_bRecvArmed || 0 == a_pstSession->m_stIPConnect.m_sockfd)
 	{
 		return;
 	}
-
+	// buffer has less than one frame, so free space is never empty
+	u32Free = TCP_RECV_BUFFER_SIZE - (pstRecv->m_u32Tail - pstRecv->m_u32Head);
+	u32Off = pstRecv->m_u32Tail & (TCP_RECV_BUFFER_SIZE - 1);
+	u32First = TCP_RECV_BUFFER_SIZE - u32Off;
+	if(u32First > u32Free)
 	{
-		stMbusPacketVariables_t *pstPrev = a_pstNodeToRemove->__prev;
-		stMbusPacketVariables_t *pstNext = a_pstNodeToRemove->__next;
-
-		if(NULL != pstPrev)
-		{
-			pstPrev->__next = pstNext;
-		}
-		if(NULL != pstNext)
-		{
-			pstNext->__prev = pstPrev;
-		}
-		if(a_pstNodeToRemove == a_pstTracker->m_pstStart)
-		{
-			a_pstTracker->m_pstStart = pstNext;
-		}
-		if(a_pstNodeToRemove == a_pstTracker->m_pstLast)
-		{
-			a_pstTracker->m_pstLast = pstPrev;
-		}
-
-		a_pstNodeToRemove->__prev = NULL;
-		a_pstNodeToRemove->__next = NULL;
+		u32First = u32Free;
 	}
-} // End of releaseFromTrackerNode
-
+	pstSqe = getUringSqe(a_pstSession->m_pstReactor, a_pstSession, URING_OP_RECV);
+	if(NULL == pstSqe)
+	{
+		return;
+	}
+	pstSqe->opcode = IORING_OP_RECV;
+	pstSqe->fd = a_pstSession->m_stIPConnect.m_sockfd;
+	pstSqe->addr = (uint64_t)(uintptr_t)&pstRecv->m_au8Buf[u32Off];
+	pstSqe->len = u32First;
+	a_pstSession->m_bRecvArmed = true;
+} // End of armUringRecv
 
 /**
+ * @fn static void armUringSend(stReactorSession_t *a_pstSession)
  *
- * @fn void releaseFromTracker(stMbusPacketVariables_t *pstMBusRequesPacket)
- *
- * @brief This function removes the request from timeout tracker.
- * Identifies tracker node from the tracker list and then removes the node from that tracker
+ * @brief This function sends requests of a session which are not sent yet with io_uring.
+ * Up to REACTOR_MAX_SUBMIT_BATCH requests are sent with one message, each request
+ * directly from its buffer in request pool. Connection is established first if there is
+ * none, once operations on previous connection are complete. Only one send is in flight
+ * per session, so requests go out in order.
  *
- * @param pstMBusRequesPacket [in] stMbusPacketVariables_t* pointer to structure holding information
- * 									about the request
+ * @param a_pstSession [in] stReactorSession_t* session
  *
- * @return void [out] none
+ * @return [out] none
  */
-void releaseFromTracker(stMbusPacketVariables_t *pstMBusRequesPacket)
+static void armUringSend(stReactorSession_t *a_pstSession)
 {
-	if(NULL == pstMBusRequesPacket)
+	IP_Connect_t *pstConn = &a_pstSession->m_stIPConnect;
+	stMbusPacketVariables_t *pstReq = NULL;
+	struct io_uring_sqe *pstSqe = NULL;
+	uint16_t u16Offset = a_pstSession->m_u16PendOffset;
+	size_t szIov = 0;
+
+	if(NULL == a_pstSession->m_pstPendHead || a_pstSession->m_bSendArmed)
 	{
 		return;
 	}
-	// Timeout index is out of bounds
-	if((pstMBusRequesPacket->m_iTimeOutIndex < 0) ||
-			(pstMBusRequesPacket->m_iTimeOutIndex > g_oTimeOutTracker.m_iSize))
+	if(0 == pstConn->m_sockfd)
 	{
-		return;
+		if(a_pstSession->m_bRecvArmed || a_pstSession->m_bConnArmed)
+		{
+			// cancelled operations of previous connection are not complete yet
+			return;
+		}
+		if(false == connectReactorSession(a_pstSession))
+		{
+			return;
+		}
 	}
-	// tract timeout requests
-	struct stTimeOutTrackerNode *pstTemp = &g_oTimeOutTracker.m_pstArray[pstMBusRequesPacket->m_iTimeOutIndex];
-	if(NULL == pstTemp)
+	if(SOCK_CONNECT_INPROGRESS == pstConn->m_lastConnectStatus)
 	{
-		printf("Error: Null timeout tracker node\n");
+		// requests are sent once connect is complete
 		return;
 	}
 
-	// Obtain the lock
-	int expected = 0;
-	do
+	for(pstReq = a_pstSession->m_pstPendHead; NULL != pstReq && szIov < REACTOR_MAX_SUBMIT_BATCH;
+			pstReq = pstReq->m_pstBatchNext)
 	{
-		expected = 0;
-	} while(!atomic_compare_exchange_weak(&(pstTemp->m_iIsLocked), &expected, 1));
-
-	// Lock is obtained
-
-	releaseFromTrackerNode(pstMBusRequesPacket, pstTemp);
-	pstMBusRequesPacket->m_iTimeOutIndex = -1;
-	// Done. Release the lock
-	pstTemp->m_iIsLocked = 0;
-
-} // End of releaseFromTracker
-
-#endif
+		a_pstSession->m_astSendIov[szIov].iov_base = pstReq->m_stMbusTxData.m_au8DataFields + u16Offset;
+		a_pstSession->m_astSendIov[szIov].iov_len = pstReq->m_stMbusTxData.m_u16Length - u16Offset;
+		u16Offset = 0;
+		szIov++;
+	}
+	pstSqe = getUringSqe(a_pstSession->m_pstReactor, a_pstSession, URING_OP_SEND);
+	if(NULL == pstSqe)
+	{
+		return;
+	}
+	memset(&a_pstSession->m_stSendMsg, 0, sizeof(a_pstSession->m_stSendMsg));
+	a_pstSession->m_stSendMsg.msg_iov = a_pstSession->m_astSendIov;
+	a_pstSession->m_stSendMsg.msg_iovlen = szIov;
+	pstSqe->opcode = IORING_OP_SENDMSG;
+	pstSqe->fd = pstConn->m_sockfd;
+	pstSqe->addr = (uint64_t)(uintptr_t)&a_pstSession->m_stSendMsg;
+	pstSqe->len = 1;
+	// in order to avoid application stop whenever SIGPIPE gets generated, send with MSG_NOSIGNAL
+	pstSqe->msg_flags = MSG_NOSIGNAL;
+	a_pstSession->m_bSendArmed = true;
+} // End of armUringSend
 
 /**
+ * @fn static void cancelUringOps(stReactorSession_t *a_pstSession)
  *
- * @fn void addToRespQ(stMbusPacketVariables_t *a_pstReq)
- *
- * @brief This function adds Modbus request (sent to Modbus slave device) in
- * response queue
+ * @brief This function cancels operations in flight on connection of a session when it
+ * is closed. Cancelled operations still complete; their results are ignored since
+ * session has no connection then.
  *
- * @param a_pstReq [in] stMbusPacketVariables_t* pointer to structure holding information
- * 						about request to add in response queue
+ * @param a_pstSession [in] stReactorSession_t* session
  *
  * @return [out] none
  */
-void addToRespQ(stMbusPacketVariables_t *a_pstReq)
+static void cancelUringOps(stReactorSession_t *a_pstSession)
 {
-	if(NULL != a_pstReq)
+	const struct
 	{
-		Post_Thread_Msg_t stPostThreadMsg = { 0 };
-		// Add to queue
-		stPostThreadMsg.idThread = g_stRespProcess.m_i32RespMsgQueId;
-		stPostThreadMsg.wParam = NULL;
-		stPostThreadMsg.lParam = a_pstReq;
-		stPostThreadMsg.MsgType = a_pstReq->m_lPriority;
-
-		if(!OSAL_Post_Message(&stPostThreadMsg))
+		bool bArmed;
+		eUringOp eOp;
+	} astOps[] = {
+		{ a_pstSession->m_bRecvArmed, URING_OP_RECV },
+		{ a_pstSession->m_bSendArmed, URING_OP_SEND },
+		{ a_pstSession->m_bConnArmed, URING_OP_CONNECT }
+	};
+
+	for(size_t szOp = 0; szOp < sizeof(astOps) / sizeof(astOps[0]); szOp++)
+	{
+		struct io_uring_sqe *pstSqe = NULL;
+		if(false == astOps[szOp].bArmed)
 		{
-			//OSAL_Free(a_pstReq);
-			freeReqNode(a_pstReq);
+			continue;
 		}
-		else
+		pstSqe = getUringSqe(a_pstSession->m_pstReactor, NULL, URING_OP_CANCEL);
+		if(NULL != pstSqe)
 		{
-			// Signal response timeout thread
-			sem_post(&g_stRespProcess.m_semaphoreResp);
+			pstSqe->opcode = IORING_OP_ASYNC_CANCEL;
+			pstSqe->addr = (uint64_t)(uintptr_t)a_pstSession | (uint64_t)astOps[szOp].eOp;
 		}
 	}
-} // End of addToRespQ
+} // End of cancelUringOps
 
 /**
+ * @fn static void completeUringSend(stReactorSession_t *a_pstSession, int32_t a_i32Res)
  *
- * @fn void* postResponseToApp(void* threadArg)
- *
- * @brief This function is thread routine which posts response to application.
- * It listens on a Linux message queue to receive response of requests to post to ModbusApp.
- * Once the response is sent to ModbusApp, function frees the response node so that other
- * requests can reuse it. The thread keeps working till the flag is not set to terminate
- * the thread.
+ * @brief This function handles completion of a send. Requests sent completely are
+ * added to timing wheel; rest of a request partially sent is sent with next message.
+ * If send failed, first request is completed with send error and connection is closed.
  *
- * @param threadArg [in] void* pointer
+ * @param a_pstSession 	[in] stReactorSession_t* session
+ * @param a_i32Res 		[in] int32_t bytes sent or negative error number
  *
  * @return [out] none
  */
-void* postResponseToApp(void* threadArg)
+static void completeUringSend(stReactorSession_t *a_pstSession, int32_t a_i32Res)
 {
-	Linux_Msg_t stScMsgQue = { 0 };
-	stMbusPacketVariables_t *pstMBusRequesPacket = NULL;
-	int32_t i32RetVal = 0;
+	uint32_t u32Sent = 0;
 
-	// set thread priority
-	set_thread_sched_param();
-
-	while(false == g_bThreadExit)
+	if(0 == a_pstSession->m_stIPConnect.m_sockfd)
 	{
-		if((sem_wait(&g_stRespProcess.m_semaphoreResp)) == -1 && errno == EINTR)
+		// connection is closed, requests are sent again on next connection
+		return;
+	}
+	if(a_i32Res < 0)
+	{
+		stMbusPacketVariables_t *pstReq = a_pstSession->m_pstPendHead;
+		if(-EINTR == a_i32Res || -EAGAIN == a_i32Res)
 		{
-			// Continue if interrupted by handler
-			continue;
+			return;
 		}
-		memset(&stScMsgQue,00,sizeof(stScMsgQue));
-		i32RetVal = 0;
-		i32RetVal = OSAL_Get_NonBlocking_Message(&stScMsgQue, g_stRespProcess.m_i32RespMsgQueId);
-		if(i32RetVal > 0)
+		printf("Error %d occurred while sending request on %d closing the socket\n",
+				-a_i32Res, a_pstSession->m_stIPConnect.m_sockfd);
+		a_pstSession->m_pstPendHead = pstReq->m_pstBatchNext;
+		if(NULL == a_pstSession->m_pstPendHead)
 		{
-			pstMBusRequesPacket = stScMsgQue.lParam;
-			if(NULL != pstMBusRequesPacket)
-			{
-				if(pstMBusRequesPacket->m_state == RESP_RCVD_FROM_NETWORK)
-				{
-					pstMBusRequesPacket->m_u8ProcessReturn = DecodeRxPacket(pstMBusRequesPacket->m_u8RawResp, pstMBusRequesPacket);
-				}
-				ApplicationCallBackHandler(pstMBusRequesPacket, pstMBusRequesPacket->m_u8ProcessReturn);
-				freeReqNode(pstMBusRequesPacket);
-			}
+			a_pstSession->m_pstPendTail = NULL;
 		}
-		// check for thread exit
-		if(g_bThreadExit)
+		failReactorRequest(pstReq, STS_MBUS_STACK_ERROR_SEND_FAILED);
+		// next request is sent on a new connection
+		closeReactorConnection(a_pstSession);
+		return;
+	}
+
+	u32Sent = (uint32_t)a_i32Res;
+	while(u32Sent > 0 && NULL != a_pstSession->m_pstPendHead)
+	{
+		const MbusTXData_t *pstTxData = &a_pstSession->m_pstPendHead->m_stMbusTxData;
+		uint32_t u32Left = pstTxData->m_u16Length - a_pstSession->m_u16PendOffset;
+		if(u32Sent < u32Left)
 		{
+			a_pstSession->m_u16PendOffset += (uint16_t)u32Sent;
 			break;
 		}
+		u32Sent -= u32Left;
+		markReactorRequestSent(a_pstSession);
 	}
+} // End of completeUringSend
 
-	return NULL;
-} // End of postResponseToApp
-
-#ifdef MODBUS_STACK_TCPIP_ENABLED
 /**
+ * @fn static void completeUringRecv(stReactorSession_t *a_pstSession, int32_t a_i32Res)
  *
- * @fn int getTimeoutTrackerCount()
+ * @brief This function handles completion of a receive. Complete frames are parsed from
+ * receive buffer and next receive is started. Connection is closed if it is closed by
+ * device, failed or framing is lost.
  *
- * @brief This function returns current timeout counter.
- * Timeout is implemented in the form of counter.
+ * @param a_pstSession 	[in] stReactorSession_t* session
+ * @param a_i32Res 		[in] int32_t bytes received or negative error number
  *
- * @param none
- *
- * @return [out] int the timeout counter
+ * @return [out] none
  */
-int getTimeoutTrackerCount()
+static void completeUringRecv(stReactorSession_t *a_pstSession, int32_t a_i32Res)
 {
-	return g_oTimeOutTracker.m_iCounter;
-} // End of getTimeoutTrackerCount
+	if(0 == a_pstSession->m_stIPConnect.m_sockfd)
+	{
+		// data of closed connection is dropped
+		return;
+	}
+	if(-EINTR == a_i32Res || -EAGAIN == a_i32Res)
+	{
+		armUringRecv(a_pstSession);
+		return;
+	}
+	if(a_i32Res <= 0)
+	{
+		if(a_i32Res < 0)
+		{
+			printf("Recv() failed on socket %d : %d\n", a_pstSession->m_stIPConnect.m_sockfd, -a_i32Res);
+		}
+		// connection is closed by Modbus slave device or failed
+		closeReactorConnection(a_pstSession);
+		return;
+	}
+	a_pstSession->m_stRecv.m_u32Tail += (uint32_t)a_i32Res;
+	if(false == parseTcpFrames(&a_pstSession->m_stRecv))
+	{
+		closeReactorConnection(a_pstSession);
+		return;
+	}
+	armUringRecv(a_pstSession);
+} // End of completeUringRecv
 
 /**
+ * @fn static bool checkUringDetach(stReactorSession_t *a_pstSession)
  *
- * @fn void* timeoutTimerThread(void* threadArg)
- *
- * @brief This function is a thread routine which implements a timer to measure timeout for
- * initiated requests. If the timeout occurs for a request, it notifies the processing
- * thread about the same.
+ * @brief This function detaches a session from io_uring event loop if detach is
+ * requested. Connection is closed, and once all operations of the session are complete,
+ * requests not sent yet, including those left in the queue, are completed with send
+ * error and thread waiting in removeReactorSession() is woken up to free the session.
  *
- * @param [in] void* thread argument
+ * @param a_pstSession [in] stReactorSession_t* session
  *
- * @return none
+ * @return [out] bool true if detach is requested; session is not served any more
+ * 					  false otherwise
  */
-void* timeoutTimerThread(void* threadArg)
+static bool checkUringDetach(stReactorSession_t *a_pstSession)
 {
-	// set thread priority
-	set_thread_sched_param();
-	g_oTimeOutTracker.m_iCounter = 0;
-
-	struct timespec ts;
-	int rc = clock_getres(CLOCK_MONOTONIC, &ts);
-	if(0 != rc)
+	if(REACTOR_SESSION_DETACHING != atomic_load(&a_pstSession->m_u32DetachState))
 	{
-		perror("Unable to get clock resolution: ");
+		return false;
 	}
-	else
+	if(0 != a_pstSession->m_stIPConnect.m_sockfd)
 	{
-		printf("Monotonic Clock resolution: %10ld.%09ld\n", (long) ts.tv_sec, ts.tv_nsec);
+		closeReactorConnection(a_pstSession);
 	}
-
-	rc = clock_gettime(CLOCK_MONOTONIC, &ts);
-	if(0 != rc)
+	if(0 == a_pstSession->m_u32UringOps)
 	{
-		perror("Stack fatal error: Response timeout: clock_gettime failed: ");
-		return NULL;
+		failReactorRequests(a_pstSession, STS_MBUS_STACK_ERROR_SEND_FAILED);
+		failReactorQueue(a_pstSession, STS_MBUS_STACK_ERROR_SEND_FAILED);
+		// session must not be touched after this
+		atomic_store(&a_pstSession->m_u32DetachState, REACTOR_SESSION_DETACHED);
+		Osal_Futex_Wake(&a_pstSession->m_u32DetachState, 1);
 	}
-	while(false == g_bThreadExit)
-	{
-		unsigned long next_tick = (ts.tv_sec * 1000000000L + ts.tv_nsec) + 1*1000*1000;
-		ts.tv_sec = next_tick / 1000000000L;
-		ts.tv_nsec = next_tick % 1000000000L;
-		do
-		{
-			rc = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
-		} while(EINTR == rc);
-
-		if(0 == rc)
-		{
-			g_oTimeOutTracker.m_iCounter = (g_oTimeOutTracker.m_iCounter + 1) % g_oTimeOutTracker.m_iSize;
+	return true;
+} // End of checkUringDetach
 
-			struct stIntDataForQ objSt;
-			objSt.m_iID = g_oTimeOutTracker.m_iCounter;
-			objSt.m_lType = 1;
+/**
+ * @fn static void attachUringSessions(stReactor_t *a_pstReactor)
+ *
+ * @brief This function starts serving sessions added to io_uring event loop since its
+ * wake descriptor was last read, by reading their doorbells.
+ *
+ * @param a_pstReactor [in] stReactor_t* event loop
+ *
+ * @return [out] none
+ */
+static void attachUringSessions(stReactor_t *a_pstReactor)
+{
+	stReactorSession_t *pstSession = NULL;
 
-			if(-1 != msgsnd(g_oTimeOutTracker.m_iTimeoutActionQ, &objSt, sizeof(objSt) - sizeof(long), 0))
-			{
-				sem_post(&g_oTimeOutTracker.m_semTimeout);
-			}
-			else
-			{
-				perror("Unable to post timeout timer action:");
-			}
-		}
-		else
-		{
-			printf("Stack: Error in Response timeout function: %d\n", rc);
-		}
+	if(0 != Osal_Wait_Mutex(a_pstReactor->m_hMutex))
+	{
+		// fail to lock mutex
+		return;
 	}
+	pstSession = a_pstReactor->m_pstAttaching;
+	a_pstReactor->m_pstAttaching = NULL;
+	Osal_Release_Mutex(a_pstReactor->m_hMutex);
 
-	return NULL;
-} // End of timeoutTimerThread
+	while(NULL != pstSession)
+	{
+		stReactorSession_t *pstNext = pstSession->m_pstAttachNext;
+		pstSession->m_pstAttachNext = NULL;
+		armUringRead(a_pstReactor, pstSession, URING_OP_DOORBELL, pstSession->m_iDoorbellFd,
+				&pstSession->m_u64DoorbellVal);
+		pstSession = pstNext;
+	}
+} // End of attachUringSessions
 
 /**
+ * @fn static void handleUringCompletion(stReactor_t *a_pstReactor, uint64_t a_u64UserData,
+ * 								int32_t a_i32Res)
  *
- * @fn void* timeoutActionThread(void* threadArg)
- *
- * @brief The function is a thread routine which identifies timed out requests and
- * initiates a response accordingly.
+ * @brief This function handles a completion of io_uring event loop. Operations of event
+ * loop re-arm themselves. For an operation of a session, requests are taken from its
+ * context queue when doorbell is read, responses are parsed when they are received and
+ * requests not sent yet are sent.
  *
- * @param [in] void* thread argument
+ * @param a_pstReactor 	[in] stReactor_t* event loop
+ * @param a_u64UserData [in] uint64_t user data of completion
+ * @param a_i32Res 		[in] int32_t result of operation
  *
- * @return none
+ * @return [out] none
  */
-void* timeoutActionThread(void* threadArg)
+static void handleUringCompletion(stReactor_t *a_pstReactor, uint64_t a_u64UserData, int32_t a_i32Res)
 {
-	printf("in timeoutActionThread thread\n");
-
-	// set thread priority
-	set_thread_sched_param();
-
-	const int iArrayToTimeoutDiff = g_oTimeOutTracker.m_iSize - g_stModbusDevConfig.m_lResponseTimeout/1000;
-	const size_t MsgSize = sizeof(struct stIntDataForQ) - sizeof(long);
+	stReactorSession_t *pstSession = (stReactorSession_t *)(uintptr_t)(a_u64UserData & ~(uint64_t)URING_OP_MASK);
+	eUringOp eOp = (eUringOp)(a_u64UserData & URING_OP_MASK);
 
-	while(false == g_bThreadExit)
+	if(NULL == pstSession)
 	{
-		if((sem_wait(&g_oTimeOutTracker.m_semTimeout)) == -1 && errno == EINTR)
-		{
-			// Continue if interrupted by handler
-			continue;
-		}
-		struct stIntDataForQ objSt = {0};
-		int i32RetVal = msgrcv(g_oTimeOutTracker.m_iTimeoutActionQ, &objSt, MsgSize, 0, MSG_NOERROR | IPC_NOWAIT);
-		if(i32RetVal <= 0)
-		{
-			//i32RetVal = -1;
-			perror("Unable to get data from timeout q");
-			continue;
-		}
-
-		// get list corresponding to the index
-		// This is the current index
-		// Find timed out index using following formula
-		// timedOutIndex = [current index + (timeout-array-size - timeout)] % timeout-array-size
-		int iTimedOutIndex = (objSt.m_iID + iArrayToTimeoutDiff) % g_oTimeOutTracker.m_iSize;
-
-		// identify index into q
-		if(iTimedOutIndex > g_oTimeOutTracker.m_iSize)
+		if(URING_OP_WAKE == eOp)
 		{
-			printf("Error: Timed out Index is greater than array size\n");
-			continue;
-		}
-		int expected = 0;
-		struct stTimeOutTrackerNode *pstTemp = &g_oTimeOutTracker.m_pstArray[iTimedOutIndex];
-		if(NULL == pstTemp)
-		{
-			printf("Error: Null timeout tracker node\n");
-			continue;
+			attachUringSessions(a_pstReactor);
+			armUringRead(a_pstReactor, NULL, URING_OP_WAKE, a_pstReactor->m_iWakeFd, &a_pstReactor->m_u64WakeVal);
 		}
-
-		// Obtain the lock
-		do
-		{
-			expected = 0;
-		} while(!atomic_compare_exchange_weak(&(pstTemp->m_iIsLocked), &expected, 1));
-
-		// Lock is obtained
-		stMbusPacketVariables_t *pstNextNode = pstTemp->m_pstStart;
-		while(NULL != pstNextNode)
+		else if(URING_OP_TIMER == eOp)
 		{
-			stMbusPacketVariables_t *pstCur = pstNextNode;
-			pstNextNode = pstNextNode->__next;
-			eTransactionState expected = REQ_SENT_ON_NETWORK;
-			// Change the state of request node
-			if(true ==
-					atomic_compare_exchange_strong(&pstCur->m_state, &expected, RESP_TIMEDOUT))
+			uint64_t u64Expirations = 0;
+			// timer is non-blocking, nothing is read if it was re-armed meanwhile
+			if(sizeof(u64Expirations) ==
+					read(g_oTimeOutTracker.m_iTimerFd, &u64Expirations, sizeof(u64Expirations)))
 			{
-				pstCur->m_u8ProcessReturn = STS_MBUS_STACK_ERROR_RECV_TIMEOUT;
-				pstCur->m_stMbusRxData.m_u8Length = 0;
-				// Init resp received timestamp
-				timespec_get(&(pstCur->m_objTimeStamps.tsRespRcvd), TIME_UTC);
-				addToRespQ(pstCur);
+				expireTimedOutRequests();
 			}
+			armUringPoll(a_pstReactor, URING_OP_TIMER, g_oTimeOutTracker.m_iTimerFd);
+		}
+		else if(URING_OP_TICK == eOp)
+		{
+			a_pstReactor->m_bTickArmed = false;
 		}
-		// Done. Release the lock
-		pstTemp->m_iIsLocked = 0;
+		return;
 	}
-	return NULL;
-} // End of timeoutActionThread
 
-/**
- *
- * @fn int initTimeoutTrackerArray(void)
- *
- * @brief This function initialize timeout tracker data structure and threads.
- *
- * @param none
- *
- * @return [out] int 0 if function succeeds in the initialization of timeout tracker;
- * 					-1 if function fails
- */
-int initTimeoutTrackerArray(void)
-{
-	g_oTimeOutTracker.m_iTimeoutActionQ = OSAL_Init_Message_Queue();
-	if(-1 == g_oTimeOutTracker.m_iTimeoutActionQ)
+	pstSession->m_u32UringOps--;
+	if(URING_OP_RECV == eOp)
 	{
-		return -1;
+		pstSession->m_bRecvArmed = false;
 	}
-
-	if(-1 == sem_init(&g_oTimeOutTracker.m_semTimeout, 0, 0 /* Initial value of zero*/))
+	else if(URING_OP_SEND == eOp)
 	{
-		perror("Timeout tracker: semaphore creation error: ");
-		return -1;
+		pstSession->m_bSendArmed = false;
 	}
-
-	// determine size of timeout tracker array
-	g_oTimeOutTracker.m_iSize = g_stModbusDevConfig.m_lResponseTimeout/1000 + ADDITIONAL_RECORDS_TIMEOUT_TRACKER;
-	if(g_oTimeOutTracker.m_iSize % REQ_ARRAY_MULTIPLIER)
+	else if(URING_OP_CONNECT == eOp)
 	{
-		g_oTimeOutTracker.m_iSize =
-				g_oTimeOutTracker.m_iSize + (REQ_ARRAY_MULTIPLIER - g_oTimeOutTracker.m_iSize % REQ_ARRAY_MULTIPLIER);
+		pstSession->m_bConnArmed = false;
 	}
-	printf("Timeout tracker array size: %d\n", g_oTimeOutTracker.m_iSize);
-
-	if(g_oTimeOutTracker.m_iSize > 0)
+	if(checkUringDetach(pstSession))
 	{
-		// allocate memory
-		g_oTimeOutTracker.m_pstArray =
-			(struct stTimeOutTrackerNode*)calloc(g_oTimeOutTracker.m_iSize, sizeof(struct stTimeOutTrackerNode));
+		return;
 	}
 
-	if(NULL == g_oTimeOutTracker.m_pstArray)
+	switch(eOp)
 	{
-		printf("Unable to allocate memory for timeout tracker of size: %d\n", g_oTimeOutTracker.m_iSize);
-		return -1;
+		case URING_OP_DOORBELL:
+			takeReactorRequests(pstSession);
+			armUringRead(a_pstReactor, pstSession, URING_OP_DOORBELL, pstSession->m_iDoorbellFd,
+					&pstSession->m_u64DoorbellVal);
+			break;
+		case URING_OP_RECV:
+			completeUringRecv(pstSession, a_i32Res);
+			break;
+		case URING_OP_SEND:
+			completeUringSend(pstSession, a_i32Res);
+			break;
+		case URING_OP_CONNECT:
+			if(0 != pstSession->m_stIPConnect.m_sockfd && true == completeReactorConnect(pstSession))
+			{
+				armUringRecv(pstSession);
+			}
+			break;
+		default:
+			break;
 	}
+	flushReactorSession(pstSession);
+} // End of handleUringCompletion
 
-	// Resets the timeout tracker lists
-	int iCount = 0;
-	for(; iCount < g_oTimeOutTracker.m_iSize; ++iCount)
-	{
-		g_oTimeOutTracker.m_pstArray[iCount].m_pstStart = NULL;
-		g_oTimeOutTracker.m_pstArray[iCount].m_pstLast = NULL;
-		g_oTimeOutTracker.m_pstArray[iCount].m_iIsLocked = 0;
-	}
+/**
+ * @fn static void runUringReactor(stReactor_t *a_pstReactor)
+ *
+ * @brief This function is event loop routine with io_uring. Operations queued while
+ * handling completions are submitted for all devices of event loop with one system call,
+ * which also waits for next completions. Sends and receives complete in the kernel, so
+ * no readiness is polled for sockets. First event loop also polls timeout timer.
+ *
+ * @param a_pstReactor [in] stReactor_t* event loop
+ *
+ * @return [out] none
+ */
+static void runUringReactor(stReactor_t *a_pstReactor)
+{
+	struct io_uring_cqe *pstCqe = NULL;
+	int iTimeout = EPOLL_TIMEOUT;
 
-	// Initiate timeout timer thread. This thread measures timeout tracker counter
+	armUringRead(a_pstReactor, NULL, URING_OP_WAKE, a_pstReactor->m_iWakeFd, &a_pstReactor->m_u64WakeVal);
+	if(0 == a_pstReactor->m_u32Index)
 	{
-		thread_Create_t stThreadParam = { 0 };
-		stThreadParam.dwStackSize = 0;
-		stThreadParam.lpStartAddress = timeoutTimerThread;
-		stThreadParam.lpParameter = NULL;
-		stThreadParam.lpThreadId = &g_oTimeOutTracker.m_threadIdTimeoutTimer;
-
-		g_oTimeOutTracker.m_threadIdTimeoutTimer = Osal_Thread_Create(&stThreadParam);
-
-		if(-1 == g_oTimeOutTracker.m_threadIdTimeoutTimer)
-		{
-			return -1;
-		}
+		armUringPoll(a_pstReactor, URING_OP_TIMER, g_oTimeOutTracker.m_iTimerFd);
 	}
 
-	// Initiate timeout action thread
+	// Event loop runs till it is terminated by deinitReactors()
+	while(true)
 	{
-		thread_Create_t stThreadParam = { 0 };
-		stThreadParam.dwStackSize = 0;
-		stThreadParam.lpStartAddress = timeoutActionThread;
-		stThreadParam.lpParameter = NULL;
-		stThreadParam.lpThreadId = &g_oTimeOutTracker.m_threadTimeoutAction;
-
-		// create thread
-		g_oTimeOutTracker.m_threadTimeoutAction = Osal_Thread_Create(&stThreadParam);
+		if(Osal_Uring_Submit(&a_pstReactor->m_stUring, 1) < 0 && EBUSY != errno)
+		{
+			perror("io_uring submit failed:: ");
+		}
+		while(NULL != (pstCqe = Osal_Uring_Peek_Cqe(&a_pstReactor->m_stUring)))
+		{
+			uint64_t u64UserData = pstCqe->user_data;
+			int32_t i32Res = pstCqe->res;
+			Osal_Uring_Cqe_Seen(&a_pstReactor->m_stUring);
+			handleUringCompletion(a_pstReactor, u64UserData, i32Res);
+		}
 
-		if(-1 == g_oTimeOutTracker.m_threadTimeoutAction)
+		iTimeout = checkReactorConnects(a_pstReactor, getTimeoutClockMs());
+		if(NULL != a_pstReactor->m_pstConnecting && false == a_pstReactor->m_bTickArmed)
 		{
-			return -1;
+			armUringTick(a_pstReactor, iTimeout);
 		}
 	}
-	printf("Timeout tracker is configured\n");
-	return 0;
-} // End of initTimeoutTrackerArray
-#endif
+} // End of runUringReactor
+
 /**
+ * @fn static bool initReactorUring(stReactor_t *a_pstReactor)
  *
- * @fn int initRespStructs(void)
- *
- * @brief This function initializes the request list data and data structures
- * needed for epoll mechanism.
+ * @brief This function sets up io_uring of an event loop. Kernel must poll sockets
+ * internally for operations which cannot complete at once and must not drop completions.
+ * Event loop uses epoll if io_uring is not available.
  *
- * @param none
+ * @param a_pstReactor [in] stReactor_t* event loop
  *
- * @return [out] int  0 if function succeeds in initialization;
- * 					  -1 if function fails to initialize
+ * @return [out] bool true if event loop uses io_uring;
+ * 					  false otherwise
  */
-int initRespStructs(void)
+static bool initReactorUring(stReactor_t *a_pstReactor)
 {
-	g_stRespProcess.m_i32RespMsgQueId = OSAL_Init_Message_Queue();
+	const uint32_t u32Required = IORING_FEAT_FAST_POLL | IORING_FEAT_NODROP;
 
-	if(-1 == g_stRespProcess.m_i32RespMsgQueId)
+	// completions are handled by event loop thread only when it waits for them
+	if(false == Osal_Uring_Init(&a_pstReactor->m_stUring, REACTOR_URING_ENTRIES, IORING_SETUP_COOP_TASKRUN) &&
+			false == Osal_Uring_Init(&a_pstReactor->m_stUring, REACTOR_URING_ENTRIES, 0))
 	{
-		 return -1;
+		printf("Event loop %u: io_uring is not available, epoll is used\n", a_pstReactor->m_u32Index);
+		return false;
 	}
-	// Initialize semaphore for response process
-	if(-1 == sem_init(&g_stRespProcess.m_semaphoreResp, 0, 0 /* Initial value of zero*/))
+	if(u32Required != (a_pstReactor->m_stUring.m_u32Features & u32Required))
 	{
-	   //printf("initTCPRespStructs::Could not create unnamed semaphore\n");
-	   return -1;
+		printf("Event loop %u: io_uring features missing, epoll is used\n", a_pstReactor->m_u32Index);
+		Osal_Uring_Deinit(&a_pstReactor->m_stUring);
+		return false;
 	}
-#ifdef MODBUS_STACK_TCPIP_ENABLED
-	if(0 > initTimeoutTrackerArray())
+	a_pstReactor->m_iWakeFd = eventfd(0, EFD_CLOEXEC);
+	if(a_pstReactor->m_iWakeFd < 0)
 	{
-		printf("Timeout tracker array init failed\n");
-		return -1;
+		perror("Failed to create event loop wake descriptor:");
+		Osal_Uring_Deinit(&a_pstReactor->m_stUring);
+		return false;
 	}
-#endif
+	return true;
+} // End of initReactorUring
 
-	// Initiate response thread
+/**
+ * @fn static void deinitReactorUring(stReactor_t *a_pstReactor)
+ *
+ * @brief This function releases io_uring of an event loop, if it uses one.
+ *
+ * @param a_pstReactor [in] stReactor_t* event loop
+ *
+ * @return [out] none
+ */
+static void deinitReactorUring(stReactor_t *a_pstReactor)
+{
+	if(a_pstReactor->m_bUring)
 	{
-		thread_Create_t stThreadParam1 = { 0 };
-		stThreadParam1.dwStackSize = 0;
-		stThreadParam1.lpStartAddress = postResponseToApp;
-		stThreadParam1.lpParameter = &g_stRespProcess.m_i32RespMsgQueId;
-		stThreadParam1.lpThreadId = &g_stRespProcess.m_threadIdRespToApp;
-
-		// osal create thread
-		g_stRespProcess.m_threadIdRespToApp = Osal_Thread_Create(&stThreadParam1);
-
-		if(-1 == g_stRespProcess.m_threadIdRespToApp)
-		{
-			// error
-			return -1;
-		}
+		Osal_Uring_Deinit(&a_pstReactor->m_stUring);
+		close(a_pstReactor->m_iWakeFd);
+		a_pstReactor->m_bUring = false;
 	}
-
-#ifdef MODBUS_STACK_TCPIP_ENABLED
-	initEPollData();
+} // End of deinitReactorUring
 #endif
-	return 0;
-} // End of initRespStructs
 
 /**
+ * @fn static bool isReactorUring(const stReactor_t *a_pstReactor)
  *
- * @fn void deinitRespStructs(void)
- *
- * @brief This function de-initializes data structures related to response processing.
+ * @brief This function checks whether an event loop uses io_uring instead of epoll.
  *
- * @param none
+ * @param a_pstReactor [in] const stReactor_t* event loop
  *
- * @return Nothing
+ * @return [out] bool true if event loop uses io_uring;
+ * 					  false otherwise
  */
-void deinitRespStructs(void)
+static bool isReactorUring(const stReactor_t *a_pstReactor)
 {
-	// 3 steps:
-	// Deinit response timeout mechanism
-	// Deinit epoll mechanism
-	// Deinit thread which posts responses to app
-#ifdef MODBUS_STACK_TCPIP_ENABLED
-	deinitTimeoutTrackerArray();
-	deinitEPollData();
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+	return a_pstReactor->m_bUring;
+#else
+	(void)a_pstReactor;
+	return false;
 #endif
+} // End of isReactorUring
+
+/**
+ * @fn static stReactor_t* selectReactor(const uint8_t *a_pu8IpAddr, uint16_t a_u16Port)
+ *
+ * @brief This function selects event loop to serve a new device. Device is given to event
+ * loop serving fewest devices, or to event loop found from hash of its address, as per
+ * assignment policy given at stack init.
+ *
+ * @param a_pu8IpAddr 	[in] uint8_t* IP address of device
+ * @param a_u16Port 	[in] uint16_t TCP port of device
+ *
+ * @return [out] stReactor_t* selected event loop
+ */
+static stReactor_t* selectReactor(const uint8_t *a_pu8IpAddr, uint16_t a_u16Port)
+{
+	uint32_t u32Selected = 0;
 
-	// De-Initiate response thread
+	if(eReactorHash == g_eReactorAssign)
 	{
-		// terminate the thread
-		Osal_Thread_Terminate(g_stRespProcess.m_threadIdRespToApp);
-		// deallocate memory allocated for semaphore
-		sem_destroy(&g_stRespProcess.m_semaphoreResp);
-		if(g_stRespProcess.m_i32RespMsgQueId)
+		// multiplicative hash of address, spreads neighbouring addresses
+		uint32_t u32Hash = ((uint32_t)a_pu8IpAddr[0] << 24) | ((uint32_t)a_pu8IpAddr[1] << 16) |
+				((uint32_t)a_pu8IpAddr[2] << 8) | (uint32_t)a_pu8IpAddr[3];
+		u32Hash = (u32Hash ^ ((uint32_t)a_u16Port << 7)) * 2654435761u;
+		u32Selected = (u32Hash >> 16) % g_u32ReactorCount;
+	}
+	else
+	{
+		uint32_t u32Min = UINT32_MAX;
+		for(uint32_t u32Reactor = 0; u32Reactor < g_u32ReactorCount; u32Reactor++)
 		{
-			// deallocate memory allocated for message queue
-			OSAL_Delete_Message_Queue(g_stRespProcess.m_i32RespMsgQueId);
+			uint32_t u32Count = atomic_load(&g_astReactor[u32Reactor].m_u32SessionCount);
+			if(u32Count < u32Min)
+			{
+				u32Min = u32Count;
+				u32Selected = u32Reactor;
+			}
 		}
 	}
-} // End of deinitRespStructs
+	return &g_astReactor[u32Selected];
+} // End of selectReactor
 
-#ifdef MODBUS_STACK_TCPIP_ENABLED
 /**
- * @fn void deinitTimeoutTrackerArray(void)
+ * @fn static void unlinkReactorSession(stReactorSession_t *a_pstSession)
  *
- * @brief This function de-initializes the timeout tracker data structure and threads.
+ * @brief This function takes a session off the list of devices served by its event loop.
  *
- * @param none
+ * @param a_pstSession [in] stReactorSession_t* session
  *
- * @return none
+ * @return [out] none
  */
-void deinitTimeoutTrackerArray(void)
+static void unlinkReactorSession(stReactorSession_t *a_pstSession)
 {
-	// terminate the thread created for timeout tracker
-	Osal_Thread_Terminate(g_oTimeOutTracker.m_threadIdTimeoutTimer);
-	Osal_Thread_Terminate(g_oTimeOutTracker.m_threadTimeoutAction);
-	// deallocate the memory
-	sem_destroy(&g_oTimeOutTracker.m_semTimeout);
-	if(g_oTimeOutTracker.m_iTimeoutActionQ)
+	stReactor_t *pstReactor = a_pstSession->m_pstReactor;
+
+	if(0 != Osal_Wait_Mutex(pstReactor->m_hMutex))
 	{
-		// deallocate memory allocated for message queue created for timeout tracker
-		OSAL_Delete_Message_Queue(g_stRespProcess.m_i32RespMsgQueId);
+		// fail to lock mutex
+		return;
 	}
-
-	if(NULL != g_oTimeOutTracker.m_pstArray)
+	if(NULL != a_pstSession->m_pstPrev)
 	{
-		//free the memory allocated for pointer to array
-		free(g_oTimeOutTracker.m_pstArray);
+		a_pstSession->m_pstPrev->m_pstNext = a_pstSession->m_pstNext;
 	}
-	g_oTimeOutTracker.m_iSize = 0;
-} // End of deinitTimeoutTrackerArray
+	else
+	{
+		pstReactor->m_pstSessions = a_pstSession->m_pstNext;
+	}
+	if(NULL != a_pstSession->m_pstNext)
+	{
+		a_pstSession->m_pstNext->m_pstPrev = a_pstSession->m_pstPrev;
+	}
+	a_pstSession->m_pstNext = NULL;
+	a_pstSession->m_pstPrev = NULL;
+	Osal_Release_Mutex(pstReactor->m_hMutex);
+} // End of unlinkReactorSession
 
 /**
+ * @fn stReactorSession_t* addReactorSession(int32_t a_i32MsgQId, const uint8_t *a_pu8IpAddr,
+ * 								uint16_t a_u16Port, uint32_t a_u32ConnectTimeoutMs)
  *
- * @fn int addReqToList(stMbusPacketVariables_t *pstMBusRequesPacket)
- *
- * @brief This function adds request to list for tracking timeout.
+ * @brief This function attaches a device to an event loop. Doorbell of context queue is
+ * registered with epoll of the event loop; with io_uring, event loop is woken up to start
+ * reading it. Device is connected when first request is sent.
  *
- * @param pstMBusRequesPacket [in] stMbusPacketVariables_t* pointer to structure holding
- * 									 information about the request sent on Modbus slave device
+ * @param a_i32MsgQId 			[in] int32_t context queue created with eventfd doorbell
+ * @param a_pu8IpAddr 			[in] uint8_t* IP address of device
+ * @param a_u16Port 			[in] uint16_t TCP port of device
+ * @param a_u32ConnectTimeoutMs [in] uint32_t connect timeout; 0 for response timeout of stack
  *
- * @return [out] int 0 if function succeeds;
- *  				 -1 if function fails
+ * @return [out] stReactorSession_t* session of device, kept by caller to detach device;
+ * 					  NULL if function fails
  */
-int addReqToList(stMbusPacketVariables_t *pstMBusRequesPacket)
+stReactorSession_t* addReactorSession(int32_t a_i32MsgQId, const uint8_t *a_pu8IpAddr,
+		uint16_t a_u16Port, uint32_t a_u32ConnectTimeoutMs)
 {
-	//check NULL pointer
-	if(NULL == pstMBusRequesPacket)
+	stReactorSession_t *pstSession = NULL;
+	stReactor_t *pstReactor = NULL;
+	IP_address_t stTempIpAdd = {0};
+	struct epoll_event stEvent = { 0 };
+	uint64_t u64Val = 1;
+
+	if(NULL == a_pu8IpAddr || 0 == g_u32ReactorCount)
 	{
-		return -1;
+		return NULL;
 	}
-	pstMBusRequesPacket->__next = NULL;
-	// get the timeout tracker counter
-	int iTimeoutTracker = getTimeoutTrackerCount();
-
-	if((0 > iTimeoutTracker)
-		|| (iTimeoutTracker > g_oTimeOutTracker.m_iSize))
+	pstSession = OSAL_Malloc(sizeof(stReactorSession_t));
+	if(NULL == pstSession)
 	{
-		printf("Error:addReqToList: %d index is greater than size %d",
-				iTimeoutTracker,
-				g_oTimeOutTracker.m_iSize);
-
-		return -1;
+		return NULL;
 	}
-    // structure to pointer which holds the modbus slave request data
-	struct stTimeOutTrackerNode *pstTemp = &g_oTimeOutTracker.m_pstArray[iTimeoutTracker];
-	if(NULL == pstTemp)
+	memset(pstSession, 0, sizeof(stReactorSession_t));
+	pstSession->m_i32MsgQId = a_i32MsgQId;
+	pstSession->m_iDoorbellFd = OSAL_Get_Message_Queue_Event_Fd(a_i32MsgQId);
+	pstSession->m_u32ConnectTimeoutMs = a_u32ConnectTimeoutMs;
+	if(pstSession->m_iDoorbellFd < 0)
 	{
-		printf("Error: Null timeout tracker node\n");
-		return -1;
+		OSAL_Free(pstSession);
+		return NULL;
 	}
 
-	// Obtain the lock
-	int expected = 0;
-	do
+	pstSession->m_stIPConnect.m_sockfd = 0;
+	pstSession->m_stIPConnect.m_lastConnectStatus = SOCK_NOT_CONNECTED;
+	pstSession->m_stRecv.m_pstConRef = &pstSession->m_stIPConnect;
+	// copy IP address
+	stTempIpAdd.s_un.s_un_b.IP_1 = a_pu8IpAddr[0];
+	stTempIpAdd.s_un.s_un_b.IP_2 = a_pu8IpAddr[1];
+	stTempIpAdd.s_un.s_un_b.IP_3 = a_pu8IpAddr[2];
+	stTempIpAdd.s_un.s_un_b.IP_4 = a_pu8IpAddr[3];
+	pstSession->m_stIPConnect.m_servAddr.sin_addr.s_addr = stTempIpAdd.s_un.s_addr;
+	pstSession->m_stIPConnect.m_servAddr.sin_port = htons(a_u16Port);
+	pstSession->m_stIPConnect.m_servAddr.sin_family = AF_INET;
+
+	pstReactor = selectReactor(a_pu8IpAddr, a_u16Port);
+	pstSession->m_pstReactor = pstReactor;
+	if(0 != Osal_Wait_Mutex(pstReactor->m_hMutex))
 	{
-		expected = 0;
-	} while(!atomic_compare_exchange_weak(&(pstTemp->m_iIsLocked), &expected, 1));
-
-	// Lock is obtained
-	pstMBusRequesPacket->__prev = pstTemp->m_pstLast;
-	if(NULL == pstTemp->m_pstStart)
+		// fail to lock mutex
+		OSAL_Free(pstSession);
+		return NULL;
+	}
+	pstSession->m_pstPrev = NULL;
+	pstSession->m_pstNext = pstReactor->m_pstSessions;
+	if(NULL != pstReactor->m_pstSessions)
 	{
-		pstTemp->m_pstStart = pstMBusRequesPacket;
-		pstTemp->m_pstLast = pstMBusRequesPacket;
+		pstReactor->m_pstSessions->m_pstPrev = pstSession;
 	}
-	else
+	pstReactor->m_pstSessions = pstSession;
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+	if(pstReactor->m_bUring)
 	{
-		pstTemp->m_pstLast->__next = pstMBusRequesPacket;
-		pstTemp->m_pstLast = pstMBusRequesPacket;
+		pstSession->m_pstAttachNext = pstReactor->m_pstAttaching;
+		pstReactor->m_pstAttaching = pstSession;
 	}
-	pstMBusRequesPacket->m_iTimeOutIndex = iTimeoutTracker;
-	// Done. Release the lock
-	pstTemp->m_iIsLocked = 0;
+#endif
+	Osal_Release_Mutex(pstReactor->m_hMutex);
 
-	return 0;
-} // End of ServerSessTcpAndCbThread
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+	if(pstReactor->m_bUring)
+	{
+		atomic_fetch_add(&pstReactor->m_u32SessionCount, 1);
+		if(sizeof(u64Val) != write(pstReactor->m_iWakeFd, &u64Val, sizeof(u64Val)))
+		{
+			perror("Event loop wake descriptor write failed:: ");
+		}
+		// ring doorbell once, so that requests queued before are taken
+		if(sizeof(u64Val) != write(pstSession->m_iDoorbellFd, &u64Val, sizeof(u64Val)))
+		{
+			perror("Context queue doorbell write failed:: ");
+		}
+		return pstSession;
+	}
+#endif
+	stEvent.events = EPOLLIN | EPOLLET;
+	stEvent.data.fd = pstSession->m_iDoorbellFd;
+	if(false == setReactorFdSession(pstReactor, pstSession->m_iDoorbellFd, pstSession))
+	{
+		unlinkReactorSession(pstSession);
+		OSAL_Free(pstSession);
+		return NULL;
+	}
+	if(epoll_ctl(pstReactor->m_iEpollFd, EPOLL_CTL_ADD, pstSession->m_iDoorbellFd, &stEvent))
+	{
+		perror("Failed to add context queue doorbell to epoll:");
+		setReactorFdSession(pstReactor, pstSession->m_iDoorbellFd, NULL);
+		unlinkReactorSession(pstSession);
+		OSAL_Free(pstSession);
+		return NULL;
+	}
+	atomic_fetch_add(&pstReactor->m_u32SessionCount, 1);
+	// ring doorbell once, event loop arms it on its first poll of the queue
+	if(sizeof(u64Val) != write(pstSession->m_iDoorbellFd, &u64Val, sizeof(u64Val)))
+	{
+		perror("Context queue doorbell write failed:: ");
+	}
+	return pstSession;
+} // End of addReactorSession
 
 /**
- *@fn stMbusPacketVariables_t* markRespRcvd(uint8_t a_u8UnitID, uint16_t a_u16TransactionID)
+ * @fn void removeReactorSession(stReactorSession_t *a_pstSession)
  *
- * @brief This function searches a request with specific unit id (Modbus slave device id) and
- * transaction id (request id that was sent on Modbus slave device) in request list and
- * mark as response is received.
+ * @brief This function detaches a device from its event loop. It must be
+ * called before context queue is deleted. Session is taken off the list of event loop
+ * and doorbell is rung with detach requested; event loop then closes connection and
+ * completes requests not sent yet, including those still in the queue, with send error, since only
+ * event loop thread uses state of session. Function waits till event loop is done and
+ * frees the session.
  *
- * @param a_u8UnitID 				[in] uint8_t Modbus slave device ID
- * @param a_u16TransactionID  		[in] uint16_t request id that was sent on Modbus slave device
- * @return stMbusPacketVariables_t 	[out] stMbusPacketVariables_t* pointer to structure holding
- * 										  information
+ * @param a_pstSession [in] stReactorSession_t* session returned by addReactorSession()
+ *
+ * @return [out] none
  */
-stMbusPacketVariables_t* markRespRcvd(uint8_t a_u8UnitID, uint16_t a_u16TransactionID)
+void removeReactorSession(stReactorSession_t *a_pstSession)
 {
-	//Initialize to NULL;
-	stMbusPacketVariables_t *pstTemp = NULL;
-	// validate request id against transaction id
-	if(a_u16TransactionID < MAX_REQUESTS)
+	uint64_t u64Val = 1;
+	uint32_t u32State = REACTOR_SESSION_DETACHING;
+
+	if(NULL == a_pstSession)
 	{
-		eTransactionState expected = REQ_SENT_ON_NETWORK;
-		// create a pointer to structure it holds the request for transaction id
-		stMbusPacketVariables_t *pstTemp1 = &g_objReqManager.m_objReqArray[a_u16TransactionID];
-		if(a_u8UnitID == pstTemp1->m_u8UnitID && a_u16TransactionID == pstTemp1->m_u16TransactionID)
-		{
+		return;
+	}
+	unlinkReactorSession(a_pstSession);
+	atomic_fetch_sub(&a_pstSession->m_pstReactor->m_u32SessionCount, 1);
 
-			if(true ==
-					atomic_compare_exchange_strong(&pstTemp1->m_state, &expected, RESP_RCVD_FROM_NETWORK))
-			{
-				pstTemp = pstTemp1;//&g_objReqManager.m_objReqArray[a_u16TransactionID];
-			}
-		}
+	atomic_store(&a_pstSession->m_u32DetachState, REACTOR_SESSION_DETACHING);
+	if(sizeof(u64Val) != write(a_pstSession->m_iDoorbellFd, &u64Val, sizeof(u64Val)))
+	{
+		perror("Context queue doorbell write failed:: ");
+	}
+	while(REACTOR_SESSION_DETACHED != (u32State = atomic_load(&a_pstSession->m_u32DetachState)))
+	{
+		Osal_Futex_Wait(&a_pstSession->m_u32DetachState, u32State, NULL);
 	}
 
-	return pstTemp;
-} // End of markRespRcvd
+	OSAL_Free(a_pstSession);
+} // End of removeReactorSession
 
 /**
- * @fn void* ServerSessTcpAndCbThread(void* threadArg)
  *
- * @brief This function is a thread routine for TCP and callback functions. This function
- * sets the thread priority, receives a request from message queue and then sends it
- * to the Modbus slave device. After the request is sent a response is received in global
- * message queue, function adds it in the response queue for further processing.
- * The thread continues till the flag to terminate the thread is not set.
+ * @fn void* ReactorThread(void* threadArg)
  *
- * @param threadArg [in] void* thread argument
+ * @brief This function is event loop thread routine. It serves devices assigned to its
+ * event loop: requests are taken from context queues when their doorbells
+ * ring and sent on non-blocking sockets, and responses are read and matched with requests
+ * in flight. First event loop also expires timed out requests when timeout timer fires.
+ * Session of a ready descriptor is found directly in descriptor table of event loop.
+ * Sockets and doorbells are edge triggered and no lock is held while they are served.
+ * Event loop using io_uring is run by runUringReactor() instead. Completed requests are
+ * posted to response dispatchers, which decode them and call back ModbusApp.
  *
- * @return [out] void pointer
+ * @param threadArg [in] void* event loop of type stReactor_t
+ * @return [out] none
  *
  */
-void* ServerSessTcpAndCbThread(void* threadArg)
+void* ReactorThread(void* threadArg)
 {
-
-	Linux_Msg_t stScMsgQue = { 0 };
-	t_Status u8ReturnType = STS_MBUS_STACK_NO_ERROR;
-	stMbusPacketVariables_t *pstMBusRequesPacket = NULL;
-	int32_t i32MsgQueIdSSTC = 0;
-	int32_t i32RetVal = 0;
-	IP_Connect_t stIPConnect;
-	IP_address_t stTempIpAdd = {0};
-
-	stLiveSerSessionList_t pstLivSerSesslist;
-
-	pstLivSerSesslist = *((stLiveSerSessionList_t *)threadArg);
-	i32MsgQueIdSSTC = pstLivSerSesslist.MsgQId;
-
-	stIPConnect.m_bIsAddedToEPoll = false;
-	stIPConnect.m_sockfd = 0;
-	stIPConnect.m_retryCount = 0;
-	stIPConnect.m_lastConnectStatus = SOCK_NOT_CONNECTED;
-
-	memset(&stIPConnect.m_servAddr, '0', sizeof(stIPConnect.m_servAddr));
-	// copy IP address
-	stTempIpAdd.s_un.s_un_b.IP_1 = pstLivSerSesslist.m_u8IpAddr[0];
-	stTempIpAdd.s_un.s_un_b.IP_2 = pstLivSerSesslist.m_u8IpAddr[1];
-	stTempIpAdd.s_un.s_un_b.IP_3 = pstLivSerSesslist.m_u8IpAddr[2];
-	stTempIpAdd.s_un.s_un_b.IP_4 = pstLivSerSesslist.m_u8IpAddr[3];
-	stIPConnect.m_servAddr.sin_addr.s_addr = stTempIpAdd.s_un.s_addr;
-	stIPConnect.m_servAddr.sin_port = htons(pstLivSerSesslist.m_u16Port);
-	stIPConnect.m_servAddr.sin_family = AF_INET;
-    // This field gives index into an array of established connections/sessions.
-	// Keeping default value as -1 to indicate that connection is not yet established.
-	stIPConnect.m_iRcvConRef = -1;
+	stReactor_t *pstReactor = (stReactor_t *)threadArg;
+	int event_count = 0;
+	int iTimeout = EPOLL_TIMEOUT;
 
 	// set thread priority
 	set_thread_sched_param();
+	if(pstReactor->m_bCpuAffinity)
+	{
+		// event loops are spread over available CPUs
+		long lCpus = sysconf(_SC_NPROCESSORS_ONLN);
+		if(lCpus > 0 && false == Osal_Set_Thread_Affinity((int32_t)(pstReactor->m_u32Index % (uint32_t)lCpus)))
+		{
+			printf("Event loop %u: unable to set CPU affinity\n", pstReactor->m_u32Index);
+		}
+	}
 
-	while(false == g_bThreadExit)
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+	if(pstReactor->m_bUring)
 	{
-		memset(&stScMsgQue,00,sizeof(stScMsgQue));
-		i32RetVal = 0;
-		// get the message from message queue
-		i32RetVal = OSAL_Get_Message(&stScMsgQue, i32MsgQueIdSSTC);
+		runUringReactor(pstReactor);
+		return NULL;
+	}
+#endif
+
+	// Event loop runs till it is terminated by deinitReactors(), since devices are still
+	// detached through it while stack is de-initialized.
+	while (true)
+	{
+		event_count = epoll_wait(pstReactor->m_iEpollFd, pstReactor->m_pstEvents, MAXEVENTS, iTimeout);
 
-		if(i32RetVal > 0)
+		for (int i = 0; i < event_count; i++)
 		{
-			pstMBusRequesPacket = stScMsgQue.lParam;
+			int iFd = pstReactor->m_pstEvents[i].data.fd;
+			stReactorSession_t *pstSession = NULL;
 
-			if(NULL != pstMBusRequesPacket)
+			if(iFd == g_oTimeOutTracker.m_iTimerFd)
 			{
-				//send the valid modbus packet to slave device
-				u8ReturnType = Modbus_SendPacket(pstMBusRequesPacket, &stIPConnect);
-				pstMBusRequesPacket->m_u8ProcessReturn = u8ReturnType;
-				if(STS_MBUS_STACK_NO_ERROR == u8ReturnType)
+				uint64_t u64Expirations = 0;
+				// timer is non-blocking, nothing is read if it was re-armed meanwhile
+				if(sizeof(u64Expirations) ==
+						read(g_oTimeOutTracker.m_iTimerFd, &u64Expirations, sizeof(u64Expirations)))
 				{
-					pstMBusRequesPacket->m_state = REQ_SENT_ON_NETWORK;
+					expireTimedOutRequests();
 				}
-				else
+				continue;
+			}
+
+			// entry is cleared if descriptor was removed after events were returned
+			pstSession = getReactorFdSession(pstReactor, iFd);
+			if(NULL == pstSession)
+			{
+				continue;
+			}
+			if(iFd == pstSession->m_iDoorbellFd)
+			{
+				uint64_t u64Val = 0;
+				if(REACTOR_SESSION_DETACHING == atomic_load(&pstSession->m_u32DetachState))
+				{
+					detachReactorSession(pstSession);
+					continue;
+				}
+				// reset doorbell, it is readable since epoll reported it
+				if(-1 == read(iFd, &u64Val, sizeof(u64Val)) && EAGAIN != errno)
 				{
-					pstMBusRequesPacket->m_state = REQ_PROCESS_ERROR;
-					// add to error response to queue
-					addToRespQ(pstMBusRequesPacket);
+					perror("Context queue doorbell read failed:: ");
 				}
+				takeReactorRequests(pstSession);
+				flushReactorSession(pstSession);
+			}
+			else
+			{
+				handleReactorSocket(pstSession, pstReactor->m_pstEvents[i].events);
 			}
 		}
 
-		// check for thread exit
-		if(g_bThreadExit)
+		iTimeout = checkReactorConnects(pstReactor, getTimeoutClockMs());
+	}
+
+	return NULL;
+} // End of ReactorThread
+
+/**
+ * @fn bool initReactors(const stStackInitConfig_t *a_pstConfig)
+ *
+ * @brief This function creates event loops serving TCP devices, each with its own epoll
+ * descriptor, and starts their threads. Timeout timer is registered with first event loop.
+ * If stack is built with io_uring support, event loops use io_uring instead of epoll
+ * when kernel provides it.
+ *
+ * @param a_pstConfig [in] const stStackInitConfig_t* validated stack configuration
+ *
+ * @return [out] bool true if function succeeds;
+ * 					  false otherwise
+ */
+bool initReactors(const stStackInitConfig_t *a_pstConfig)
+{
+	g_u32ReactorCount = 0;
+	g_eReactorAssign = a_pstConfig->m_eReactorAssign;
+	if(0 == a_pstConfig->m_u32Reactors || a_pstConfig->m_u32Reactors > MAX_REACTORS)
+	{
+		return false;
+	}
+
+	for(uint32_t u32Reactor = 0; u32Reactor < a_pstConfig->m_u32Reactors; u32Reactor++)
+	{
+		stReactor_t *pstReactor = &g_astReactor[u32Reactor];
+		thread_Create_t stThreadParam = { 0 };
+
+		memset(pstReactor, 0, sizeof(stReactor_t));
+		pstReactor->m_u32Index = u32Reactor;
+		pstReactor->m_bCpuAffinity = a_pstConfig->m_bReactorCpuAffinity;
+		pstReactor->m_iEpollFd = -1;
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+		pstReactor->m_bUring = initReactorUring(pstReactor);
+		if(false == pstReactor->m_bUring)
+#endif
+		{
+			pstReactor->m_iEpollFd = epoll_create1(EPOLL_CLOEXEC);
+		}
+		pstReactor->m_hMutex = Osal_Mutex();
+		pstReactor->m_pstEvents = (struct epoll_event*) calloc(MAXEVENTS, sizeof(struct epoll_event));
+		atomic_init(&pstReactor->m_pstFdTable, allocReactorFdTable(REACTOR_FD_TABLE_INIT_SIZE));
+		if((-1 == pstReactor->m_iEpollFd && false == isReactorUring(pstReactor)) || NULL == pstReactor->m_hMutex ||
+				NULL == pstReactor->m_pstEvents || NULL == atomic_load(&pstReactor->m_pstFdTable))
+		{
+			perror("Failed to create event loop :: ");
+			break;
+		}
+		if(0 == u32Reactor && false == isReactorUring(pstReactor))
+		{
+			struct epoll_event stEvent = { 0 };
+			stEvent.events = EPOLLIN;
+			stEvent.data.fd = g_oTimeOutTracker.m_iTimerFd;
+			if(epoll_ctl(pstReactor->m_iEpollFd, EPOLL_CTL_ADD, g_oTimeOutTracker.m_iTimerFd, &stEvent))
+			{
+				perror("Failed to add timeout timer to epoll:");
+				break;
+			}
+		}
+
+		stThreadParam.dwStackSize = 0;
+		stThreadParam.lpStartAddress = ReactorThread;
+		stThreadParam.lpParameter = pstReactor;
+		stThreadParam.lpThreadId = &pstReactor->m_threadId;
+		pstReactor->m_threadId = Osal_Thread_Create(&stThreadParam);
+		if(-1 == pstReactor->m_threadId)
 		{
+			pstReactor->m_threadId = 0;
 			break;
 		}
+		// event loop is published only when its thread is running
+		g_u32ReactorCount = u32Reactor + 1;
 	}
-	// Close the socket descriptor
-	if(stIPConnect.m_sockfd)
+	if(g_u32ReactorCount != a_pstConfig->m_u32Reactors)
 	{
-		close(stIPConnect.m_sockfd);
+		// release event loop which failed half way
+		stReactor_t *pstReactor = &g_astReactor[g_u32ReactorCount];
+		if(pstReactor->m_iEpollFd > 0)
+		{
+			close(pstReactor->m_iEpollFd);
+		}
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+		deinitReactorUring(pstReactor);
+#endif
+		if(NULL != pstReactor->m_hMutex)
+		{
+			Osal_Close_Mutex(pstReactor->m_hMutex);
+		}
+		free(pstReactor->m_pstEvents);
+		freeReactorFdTable(atomic_load(&pstReactor->m_pstFdTable));
+		memset(pstReactor, 0, sizeof(stReactor_t));
+		return false;
 	}
-	return NULL;
-}  // End of ServerSessTcpAndCbThread
+	printf("Event loops %u, assignment policy %d, CPU affinity %d\n", g_u32ReactorCount,
+			g_eReactorAssign, a_pstConfig->m_bReactorCpuAffinity);
+	return true;
+} // End of initReactors
 
 /**
- * @fn void addToHandleRespQ(stTcpRecvData_t *a_pstReq)
+ * @fn void deinitReactors(void)
  *
- * @brief This function adds a response to handle in response queue.
+ * @brief This function terminates event loops and releases their resources.
+ * Devices are detached along with their contexts before; any left is freed.
  *
- * @param a_pstReq [in] stTcpRecvData_t* response data received from Modbus slave device
+ * @param none
  *
- * @return [out] none
+ * @return none
  */
-void addToHandleRespQ(stTcpRecvData_t *a_pstReq)
+void deinitReactors(void)
 {
-	if(NULL != a_pstReq)
+	for(uint32_t u32Reactor = 0; u32Reactor < g_u32ReactorCount; u32Reactor++)
 	{
-		// TCP IP message format
-		// 2 bytes = TxID, 2 bytes = Protocol ID, 2 bytes = length, 1 byte = unit id
-		// Holds the unit id
-		uint8_t  u8UnitID = a_pstReq->m_readBuffer[6];
-
-		// Get TxID
-		uByteOrder_t ustByteOrder = {0};
-		ustByteOrder.u16Word = 0;
-		ustByteOrder.TwoByte.u8ByteTwo = a_pstReq->m_readBuffer[0];
-		ustByteOrder.TwoByte.u8ByteOne = a_pstReq->m_readBuffer[1];
-
-		//create pointer to structure to hold the response recieved
-		stMbusPacketVariables_t *pstMBusRequesPacket = markRespRcvd(u8UnitID, ustByteOrder.u16Word);
-		if(NULL != pstMBusRequesPacket)
-		{
-			// copy the packet received from read buffer
-			memcpy_s(pstMBusRequesPacket->m_u8RawResp, sizeof(pstMBusRequesPacket->m_u8RawResp),
-							a_pstReq->m_readBuffer,sizeof(a_pstReq->m_readBuffer));
-			// Initialize response received timestamp
-			timespec_get(&(pstMBusRequesPacket->m_objTimeStamps.tsRespRcvd), TIME_UTC);
-			// Add to response queue for further processing
-			addToRespQ(pstMBusRequesPacket);
+		stReactor_t *pstReactor = &g_astReactor[u32Reactor];
+
+		Osal_Thread_Terminate(pstReactor->m_threadId);
+		while(NULL != pstReactor->m_pstSessions)
+		{
+			stReactorSession_t *pstSession = pstReactor->m_pstSessions;
+			pstReactor->m_pstSessions = pstSession->m_pstNext;
+			if(0 != pstSession->m_stIPConnect.m_sockfd)
+			{
+				close(pstSession->m_stIPConnect.m_sockfd);
+			}
+			OSAL_Free(pstSession);
 		}
-		else
+		if(pstReactor->m_iEpollFd > 0)
 		{
-			//printf("addToHandleRespQ: not found: %d %d\n", u8UnitID, u16TransactionID);
+			close(pstReactor->m_iEpollFd);
 		}
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+		deinitReactorUring(pstReactor);
+#endif
+		Osal_Close_Mutex(pstReactor->m_hMutex);
+		free(pstReactor->m_pstEvents);
+		freeReactorFdTable(atomic_load(&pstReactor->m_pstFdTable));
+		memset(pstReactor, 0, sizeof(stReactor_t));
 	}
-
-	return;
-} // End of addToHandleRespQ
+	g_u32ReactorCount = 0;
+} // End of deinitReactors
 #endif
 
 /**
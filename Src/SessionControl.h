@@ -39,13 +39,13 @@
 /**
  *
  * Description
- * Initialize Response list data
+ * Initialize Response list data and start response dispatcher threads
  *
- * @param none
+ * @param a_pstConfig [in] const stStackInitConfig_t* validated stack configuration
  * @return int [out] 0 (if success)
  * 					-1 (if failure)
  */
-int initRespStructs();
+int initRespStructs(const stStackInitConfig_t *a_pstConfig);
 
 /**
  *
@@ -122,6 +122,7 @@ typedef struct LiveSerSessionList
 	int m_iLastConnectStatus;			// Connection status
 	uint8_t m_u8ConnectAttempts;		// Connection attempts
 	uint16_t m_u16TxID;					// Transmission ID
+	struct ReactorSession *m_pstReactorSession;	// device in its event loop
 #else
 	uint8_t m_u8ReceivedDestination;	// Receive destination
 	uint8_t m_portName[256];			// Port name
@@ -161,21 +162,171 @@ typedef struct EpollTcpRecv
 typedef struct TcpRecvData
 {
 	IP_Connect_t *m_pstConRef;				//pointer reference
-	int m_len;								//TCPIP data length
-	int m_bytesRead;						// bytes read
-	int m_bytesToBeRead;					// No.Of bytes to be read
-	unsigned char m_readBuffer[MODBUS_DATA_LENGTH];  // read buffer
+	// Received bytes not parsed yet are between head and tail. Both are free running
+	// offsets, position in buffer is offset modulo TCP_RECV_BUFFER_SIZE.
+	uint32_t m_u32Head;						// offset of first byte not parsed yet
+	uint32_t m_u32Tail;						// offset after last byte received
+	unsigned char m_au8Buf[TCP_RECV_BUFFER_SIZE];	// receive ring buffer
 }stTcpRecvData_t;
 
+struct Reactor;
+
+/**
+ @enum ReactorDetachState
+ @brief
+    This enumerator defines progress of detaching a device from its event loop
+*/
+typedef enum ReactorDetachState
+{
+	REACTOR_SESSION_ATTACHED = 0,				// device is served by event loop
+	REACTOR_SESSION_DETACHING,					// detach is requested, event loop is not done yet
+	REACTOR_SESSION_DETACHED					// event loop does not use session any more
+}eReactorDetachState;
+
+/**
+ @struct ReactorSession
+ @brief
+    This structure defines a device served by an event loop.
+*/
+typedef struct ReactorSession
+{
+	IP_Connect_t m_stIPConnect;					// connection with device
+	stTcpRecvData_t m_stRecv;					// receive state of connection
+	struct Reactor *m_pstReactor;				// event loop serving device
+	int32_t m_i32MsgQId;						// context queue of requests
+	int m_iDoorbellFd;							// eventfd doorbell of context queue
+	stMbusPacketVariables_t *m_pstPendHead;		// requests taken from queue, not sent yet
+	stMbusPacketVariables_t *m_pstPendTail;		// last request not sent yet
+	stMbusPacketVariables_t *m_pstHeld;			// rest of a batch held back by in-flight window
+	uint16_t m_u16PendOffset;					// bytes of first pending request already sent
+	uint32_t m_u32ConnectTimeoutMs;				// connect timeout, 0 for response timeout of stack
+	uint64_t m_u64ConnectDeadlineMs;			// deadline of connect in progress
+	_Atomic uint32_t m_u32DetachState;			// eReactorDetachState of session
+	struct ReactorSession *m_pstNext;			// next session of event loop
+	struct ReactorSession *m_pstPrev;			// previous session of event loop
+	struct ReactorSession *m_pstConnNext;		// next session with connect in progress
+	struct ReactorSession *m_pstConnPrev;		// previous session with connect in progress
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+	struct ReactorSession *m_pstAttachNext;		// next session to be attached by io_uring event loop
+	uint64_t m_u64DoorbellVal;					// doorbell value read by io_uring
+	uint32_t m_u32UringOps;						// io_uring operations in flight for session
+	bool m_bRecvArmed;							// receive is in flight
+	bool m_bSendArmed;							// send is in flight
+	bool m_bConnArmed;							// poll for connect completion is in flight
+	struct msghdr m_stSendMsg;					// message of send in flight
+	struct iovec m_astSendIov[REACTOR_MAX_SUBMIT_BATCH];	// requests of send in flight
+#endif
+}stReactorSession_t;
+
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+/**
+ @enum UringOp
+ @brief
+    This enumerator defines operations of io_uring event loop. Operation is kept in
+    low bits of user data of its completion, with session it belongs to, if any.
+*/
+typedef enum UringOp
+{
+	URING_OP_DOORBELL = 1,						// read of context queue doorbell
+	URING_OP_RECV,								// receive of responses
+	URING_OP_SEND,								// send of requests
+	URING_OP_CONNECT,							// poll for connect completion
+	URING_OP_WAKE,								// read of event loop wake descriptor
+	URING_OP_TIMER,								// poll of timeout timer
+	URING_OP_TICK,								// timeout for connect deadlines
+	URING_OP_CANCEL,							// cancel of an operation
+	URING_OP_MASK = 0xF							// mask of operation in user data
+}eUringOp;
+#endif
+
+/**
+ @struct ReactorFdTable
+ @brief
+    This structure defines descriptor table of an event loop. A table which is
+    replaced by a larger one is kept, since event loop may still be reading it.
+*/
+typedef struct ReactorFdTable
+{
+	uint32_t m_u32Size;							// entries in table
+	struct ReactorFdTable *m_pstRetired;		// smaller table replaced by this one
+	stReactorSession_t *_Atomic m_apstSessions[];	// sessions indexed by descriptor
+}stReactorFdTable_t;
+
+/**
+ @struct Reactor
+ @brief
+    This structure defines an event loop. Each event loop has its own epoll
+    descriptor and serves its own share of devices. Descriptor table gives session of
+    a ready descriptor, so an event is dispatched to its device without a search.
+    State of sessions is used only by event loop thread; mutex is needed only to
+    attach or detach a device and to change descriptor table.
+*/
+typedef struct Reactor
+{
+	int m_iEpollFd;								// epoll descriptor of event loop
+	Mutex_H m_hMutex;							// protects session list and descriptor table changes
+	Thread_H m_threadId;						// event loop thread
+	struct epoll_event *m_pstEvents;			// events returned by epoll
+	uint32_t m_u32Index;						// index of event loop
+	bool m_bCpuAffinity;						// pin event loop thread to a CPU
+	_Atomic uint32_t m_u32SessionCount;			// number of devices served
+	stReactorSession_t *m_pstSessions;			// devices served
+	stReactorSession_t *m_pstConnecting;		// devices with connect in progress, used by event loop only
+	stReactorFdTable_t *_Atomic m_pstFdTable;	// descriptor table, grows on demand
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+	bool m_bUring;								// event loop uses io_uring instead of epoll
+	stOsalUring_t m_stUring;					// io_uring of event loop
+	int m_iWakeFd;								// eventfd rung when sessions are to be attached
+	uint64_t m_u64WakeVal;						// wake value read by io_uring
+	stReactorSession_t *m_pstAttaching;			// sessions to be attached, protected by mutex
+	bool m_bTickArmed;							// timeout for connect deadlines is in flight
+	struct __kernel_timespec m_stTick;			// timeout for connect deadlines
+#endif
+}stReactor_t;
+
+/**
+ *
+ * Description
+ * Create event loops of TCP mode and start their threads
+ *
+ * @param a_pstConfig [in] const stStackInitConfig_t* validated stack configuration
+ * @return bool [out] true on success, false on failure
+ */
+bool initReactors(const stStackInitConfig_t *a_pstConfig);
+
 /**
  *
  * Description
- * Initializes data structures needed for epoll operation for receiving TCP data
+ * Terminate event loops of TCP mode
  *
- * @param None
- * @return true/false based on status
+ * @param none
+ * @return void [out] none
+ */
+void deinitReactors(void);
+
+/**
+ *
+ * Description
+ * Attach a device to an event loop
+ *
+ * @param a_i32MsgQId 			[in] int32_t context queue created with eventfd doorbell
+ * @param a_pu8IpAddr 			[in] uint8_t* IP address of device
+ * @param a_u16Port 			[in] uint16_t TCP port of device
+ * @param a_u32ConnectTimeoutMs [in] uint32_t connect timeout, 0 for response timeout of stack
+ * @return stReactorSession_t* [out] session of device on success, NULL on failure
+ */
+stReactorSession_t* addReactorSession(int32_t a_i32MsgQId, const uint8_t *a_pu8IpAddr,
+		uint16_t a_u16Port, uint32_t a_u32ConnectTimeoutMs);
+
+/**
+ *
+ * Description
+ * Detach a device from event loop; requests not sent yet are completed with error
+ *
+ * @param a_pstSession [in] stReactorSession_t* session returned by addReactorSession()
+ * @return void [out] none
  */
-bool initEPollData();
+void removeReactorSession(stReactorSession_t *a_pstSession);
 
 /**
  *
@@ -190,13 +341,22 @@ int addReqToList(stMbusPacketVariables_t *pstMBusRequesPacket);
 /**
  *
  * Description
- * Add response to handle in a queue
+ * Find request a received frame belongs to
  *
- * @param a_u8UnitID [in] uint8_t unit id from modbus header
- * @param a_u16TransactionID  [in] uint16_t transction id from modbus header
+ * @param a_pu8Header [in] const uint8_t* MBAP header of a complete frame
+ * @return stMbusPacketVariables_t* [out] matching request, NULL if response is stale
+ */
+stMbusPacketVariables_t* matchRespHeader(const stTcpRecvData_t *a_pstConn, const uint8_t *a_pu8Header);
+
+/**
+ *
+ * Description
+ * Add completely received response to handle in a queue
+ *
+ * @param a_pstReq [in] stMbusPacketVariables_t* request with complete response
  * @return void [out] none
  */
-void addToHandleRespQ(stTcpRecvData_t *a_pstReq);
+void addToHandleRespQ(stMbusPacketVariables_t *a_pstReq);
 
 
 //stMbusPacketVariables_t* searchReqList(uint8_t a_u8UnitID, uint16_t a_u16TransactionID);
@@ -223,37 +383,27 @@ void closeConnection(IP_Connect_t *a_pstIPConnect);
 
 /**
  * Description
- * Set socket failure state
+ * Create a non-blocking socket and start connecting with Modbus slave device
  *
- * @param stIPConnect [in] pointer to struct of type IP_Connect_t
+ * @param a_pstIPConnect [in] pointer to struct of type IP_Connect_t
  *
- * @return void [out] none
+ * @return t_Status [out] STS_MBUS_STACK_NO_ERROR if connect is started or done,
+ * 						  respective error codes otherwise
  *
  */
-void Mark_Sock_Fail(IP_Connect_t *stIPConnect);
-
-/**
- *
- * Description
- * TCP and callback thread function
- *
- * @param threadArg [in] thread argument
- * @return void pointer
- *
- */
-void* ServerSessTcpAndCbThread(void* threadArg);
+t_Status Modbus_StartConnect(IP_Connect_t *a_pstIPConnect);
 
 void deinitTimeoutTrackerArray();
 
 /**
  *
  * Description
- * thread to start polling on sockets o receive data
+ * event loop thread serving TCP devices
  *
- * @param - none
+ * @param threadArg [in] event loop of type stReactor_t
  * @return void [out] none
  */
-void* EpollRecvThread();
+void* ReactorThread(void* threadArg);
 
 #endif
 
@@ -45,21 +45,45 @@
 	// This is as the modbus standard
 	#define TCP_MODBUS_ADU_LENGTH 260
 
-	// This value is used in timeout thread for tracking
-	// This value is used to add additional records to timeout tracker list
-	#define ADDITIONAL_RECORDS_TIMEOUT_TRACKER 100
-
-	// Multiplier value for request array
-	#define REQ_ARRAY_MULTIPLIER 100
-
-	// this value will specify maximum events to be register for epoll thread
-	// this is used in epoll receiver thread
+	// MBAP header length: transaction id, protocol id, length and unit id
+	#define MBAP_HEADER_LENGTH 7
+
+	// size of receive buffer of a connection, must be a power of 2
+	// and larger than a complete frame
+	#define TCP_RECV_BUFFER_SIZE 4096
+
+	// Timing wheel of timeout tracker. Level 0 has one list per millisecond;
+	// each list of a higher level covers whole range of the level below it.
+	#define TIMEOUT_WHEEL_L0_BITS 8
+	#define TIMEOUT_WHEEL_LN_BITS 6
+	#define TIMEOUT_WHEEL_LEVELS 4
+	#define TIMEOUT_WHEEL_L0_SIZE (1 << TIMEOUT_WHEEL_L0_BITS)
+	#define TIMEOUT_WHEEL_LN_SIZE (1 << TIMEOUT_WHEEL_LN_BITS)
+	#define TIMEOUT_WHEEL_SIZE (TIMEOUT_WHEEL_L0_SIZE + (TIMEOUT_WHEEL_LEVELS - 1) * TIMEOUT_WHEEL_LN_SIZE)
+	// Milliseconds covered by the wheel, later deadlines are kept in last list of last level
+	#define TIMEOUT_WHEEL_RANGE_MS (1ULL << (TIMEOUT_WHEEL_L0_BITS + \
+			(TIMEOUT_WHEEL_LEVELS - 1) * TIMEOUT_WHEEL_LN_BITS))
+
+	// this value will specify maximum events returned by one epoll wait
+	// this is used in event loop threads
 	#define MAXEVENTS 100
 
  	// epoll operation timeout
-	// this is used in epoll receiver thread
+	// this is used in event loop threads
 	#define EPOLL_TIMEOUT 1000
 
+	// initial number of entries in descriptor table of an event loop
+	// table is doubled when a descriptor of a device does not fit in it
+	#define REACTOR_FD_TABLE_INIT_SIZE 256
+
+	// maximum messages taken from a context queue in one go
+	// this is used in event loop threads
+	#define REACTOR_MAX_SUBMIT_BATCH 64
+
+	// submission queue entries of io_uring of an event loop
+	// this is used when stack is built with MODBUS_STACK_IO_URING_ENABLED
+	#define REACTOR_URING_ENTRIES 1024
+
 // RTU specific macros
 #else
 	// RTU packet length
@@ -94,10 +118,13 @@
 // Enumerated value used for stack errors
 #define MODBUS_STACK_ERROR 2
 
-// Response timeout (in milliseconds)value used by timeout thread
+// Response timeout (in milliseconds)value used by timeout tracker
 // This is used as a default when it is not provided by user in env
 #define DEFAULT_RESPONSE_TIMEOUT_MS 80
 
+// Maximum response timeout in ms of a context or a request
+#define MAX_RESP_TIMEOUT_MS 600000
+
 // Interframe delay (in milliseconds) value used while sending request to end device
 // This value is added for every request initiated by stack
 // This is used as a default when it is not provided by user in env
@@ -106,13 +133,37 @@
 // Number of bytes till length parameter in header out of total packet
 #define MODBUS_HEADER_LENGTH 6
 
-// maximum devices supported by stack
-// This value is used in epoll thread while receiving raw data from socket
-#define MAX_DEVICE_PER_SITE 300
+// percentage of maximum size of request pool kept aside for guaranteed shares of contexts
+// rest of the pool is shared overflow area, so it never shrinks to nothing as devices are added
+#define REQ_GUARANTEED_PERCENT 50
 
-// Maximum request array size for request queue
+// Default maximum size of request pool (requests in flight)
 #define MAX_REQUESTS 5000
 
+// Default number of request nodes committed at init and in one growth step
+#define DEFAULT_REQ_POOL_INIT_SIZE 256
+#define DEFAULT_REQ_POOL_CHUNK_SIZE 256
+
+// Upper limit for request pool size.
+// Index of request node is sent in 16 bit transaction id in TCP mode. Bits not needed
+// for the index carry a generation number, so a pool of maximum size has no generation bits.
+#define MAX_REQ_POOL_SIZE 65536
+
+// Default and maximum number of threads which decode responses and call back ModbusApp
+#define DEFAULT_RESP_DISPATCHERS 1
+#define MAX_RESP_DISPATCHERS 64
+// Event loop threads of TCP mode
+#define DEFAULT_REACTORS 1
+#define MAX_REACTORS 64
+// Minimum ring size of message queue of a TCP context. Ring of a context with in-flight
+// window is sized to the window. Event loop drains queue as requests are posted, so ring
+// holds only a burst posted faster than that; a post to a full queue waits or fails as per
+// admission mode. Must be power of 2.
+#define CTX_MSG_QUEUE_SIZE 256
+
+// Pool is trimmed only if it has not grown for these many seconds
+#define REQ_POOL_TRIM_DELAY_SEC 5
+
 // Thread priority value for all threads in stack in realtime
 #define THREAD_PRIORITY 30
 
@@ -203,17 +254,12 @@ typedef enum
 	SOCK_NOT_CONNECTED
 }eSockConnect_enum;
 
-// Retry count
-#define MAX_RETRY_COUNT 10
-
 typedef struct IP_Connect
 {
-	int32_t m_retryCount;					// retry count
 	struct sockaddr_in m_servAddr;			// socket address
 	int32_t m_sockfd;						// socket descriptor
 	eSockConnect_enum m_lastConnectStatus;	//Connection status
 	bool m_bIsAddedToEPoll;					// Added to Epoll
-	int m_iRcvConRef;						// Receive Conference reference
 }IP_Connect_t;
 
 /**
@@ -228,19 +274,13 @@ typedef struct IP_Connect
 */
 typedef struct _stMbusPacketVariables
 {
-	// Holds the received transaction ID
-	uint16_t m_u16TransactionID;
+	// Transaction id, unit id and state are in stReqHotMeta_t of the request
 	uint16_t m_u16AppTxID;
-	// Holds the unit id
-	uint8_t  m_u8UnitID;
-	_Atomic eTransactionState m_state;
 	t_Status  m_u8ProcessReturn;
 #ifdef MODBUS_STACK_TCPIP_ENABLED
 	// Holds Ip address of salve/server device
 	uint8_t m_u8IpAddr[4];
 	uint16_t u16Port;
-	struct _stMbusPacketVariables *__next;
-	struct _stMbusPacketVariables *__prev;
 #else
 	// Received destination address
 	uint8_t	m_u8ReceivedDestination;
@@ -248,6 +288,12 @@ typedef struct _stMbusPacketVariables
 	long m_lInterframeDealy;
 	// Response timeout
 	long m_lRespTimeout;
+#endif
+#ifdef MODBUS_STACK_TCPIP_ENABLED
+	// Response timeout of request in ms, 0 selects response timeout of stack
+	uint32_t m_u32RespTimeoutMs;
+	// Receive state of connection request is sent on, response is accepted only from it
+	const struct TcpRecvData *m_pstConn;
 #endif
 	// Holds the unit id
 	uint8_t m_u8FunctionCode;
@@ -265,19 +311,117 @@ typedef struct _stMbusPacketVariables
 	void *pFunc;
 	// Holds the Msg Priority
 	long m_lPriority;
+	// Next request posted in same queue message by Modbus_Submit_Batch(), NULL if none
+	struct _stMbusPacketVariables *m_pstBatchNext;
 
 	// bool m_bIsAvailable;
+	// Index of request in request array and in hot metadata array
 	unsigned int m_ulMyId;
-	int m_iTimeOutIndex;
 	stTimeStamps m_objTimeStamps;
 	unsigned char m_u8RawResp[MODBUS_DATA_LENGTH];
 }stMbusPacketVariables_t;
 
+/**
+ @struct stReqHotMeta_t
+ @brief
+    This structure holds fields of a request which are used by allocator, timeout tracker and
+    response matching. These are kept in an array parallel to request array, so that scans and
+    lookups touch this compact array instead of request payload.
+*/
+typedef struct
+{
+	_Atomic eTransactionState m_state;	// state of request
+	_Atomic uint32_t m_u32NextFree;		// index of next node in free-list, valid only while node is idle
+	int32_t m_i32TimeoutNext;			// index of next request in timeout tracker list, -1 if none
+	int32_t m_i32TimeoutPrev;			// index of previous request in timeout tracker list, -1 if none
+	int m_iTimeOutIndex;				// timeout tracker list holding this request, -1 if none
+	uint32_t m_u32DeadlineMs;			// response deadline, lower 32 bits of monotonic milliseconds
+	uint16_t m_u16TransactionID;		// transaction id sent on network, generation and node index
+	int16_t m_i16CtxSlot;				// context quota slot charged for this request, -1 if none
+	uint8_t m_u8UnitID;					// unit id of Modbus slave device
+	bool m_bIsSharedSlot;				// true if charged to shared overflow area instead of context share
+	bool m_bInWindow;					// true if request holds a slot of in-flight window of its context
+} __attribute__ ((aligned (32))) stReqHotMeta_t;
+
+// Marks end of request free-list
+#define REQ_FREE_LIST_END 0xFFFFFFFFu
+
+// Marks end of a timeout tracker list
+#define REQ_LINK_NONE (-1)
+
+// Number of slots in context quota table, must be a power of 2
+#define MAX_REQ_CTX_SLOTS 4096
+
+// Context id values of free and removed slots in context quota table
+#define REQ_CTX_SLOT_EMPTY (-1)
+#define REQ_CTX_SLOT_REMOVED (-2)
+
+/**
+ @struct stReqCtxQuota_t
+ @brief
+    This structure holds request quota usage of one context (TCP device or RTU port)
+*/
+typedef struct
+{
+	_Atomic int32_t m_i32CtxId;	// context (message queue id) owning this slot
+	_Atomic int m_iInFlight;	// requests in use from guaranteed share of this context
+	_Atomic int m_iTotalInFlight;	// requests in use by this context, including shared area
+	_Atomic uint32_t m_u32RespTimeoutMs;	// response timeout of context in ms, 0 selects timeout of stack
+	_Atomic uint32_t m_u32Window;	// maximum requests in flight on device of context, 0 for no limit
+	_Atomic uint32_t m_u32WindowUsed;	// requests taken by event loop and not completed yet
+}stReqCtxQuota_t;
+
 struct stReqManager {
-	stMbusPacketVariables_t m_objReqArray[MAX_REQUESTS];  // To receive the Request data
-	Mutex_H m_mutexReqArray;							  //  mutex request array
+	// Request nodes. Address space for maximum size of pool is reserved at init,
+	// memory is committed in chunks as pool grows.
+	stMbusPacketVariables_t *m_pstReqArray;
+	stReqHotMeta_t *m_pstReqHot;		// hot metadata of request nodes, parallel to m_pstReqArray
+	size_t m_szReserved;				// bytes of address space reserved for request nodes
+	size_t m_szHotReserved;				// bytes of address space reserved for hot metadata
+	uint32_t m_u32MaxSize;				// maximum number of request nodes
+	uint32_t m_u32InitSize;				// request nodes committed at init and kept on trim
+	uint32_t m_u32ChunkSize;			// request nodes committed in one growth step
+	eReqPoolPolicy m_ePolicy;			// growth policy of pool
+	_Atomic uint32_t m_u32Committed;	// request nodes committed so far
+	uint32_t m_u32Mapped;				// request nodes made accessible so far, never reduced
+	_Atomic int m_iInUse;				// request nodes taken from free-list
+	struct timespec m_tsLastGrow;		// CLOCK_MONOTONIC time when pool has grown last
+	Mutex_H m_poolMutex;				// serializes growth and trim of pool
+	// Head of lock-free free-list of idle nodes.
+	// Upper 32 bits hold a tag which changes on every update (avoids ABA),
+	// lower 32 bits hold index of the first idle node.
+	_Atomic uint64_t m_u64FreeListHead;
+	stReqCtxQuota_t m_objCtxQuota[MAX_REQ_CTX_SLOTS];	// per context quota, open addressing table
+	// Request nodes kept aside for guaranteed shares (REQ_GUARANTEED_PERCENT of maximum pool).
+	// They are split evenly among registered contexts, at least one node each; rest of the
+	// pool is shared overflow area. Guaranteed and shared nodes in use never exceed the pool.
+	int m_iGuaranteedTotal;
+	_Atomic int m_iGuaranteedInUse;	// requests in use from guaranteed shares of all contexts
+	_Atomic int m_iCtxCount;		// number of registered contexts
+	_Atomic int m_iSharedInUse;		// requests in use from shared overflow area
+	// Transaction id sent on network is split into generation (upper bits) and
+	// node index (lower m_u32TidIndexBits bits). Generation changes every time a node
+	// is reused, so that a late response does not match next request on the node.
+	uint32_t m_u32TidIndexBits;		// bits of transaction id holding node index
+	uint32_t m_u32TidIndexMask;		// mask of node index in transaction id
+	_Atomic uint64_t m_u64StaleResp;	// responses dropped as not matching a request in flight
+	eReqAdmissionMode m_eAdmissionMode;	// behaviour when no request node can be taken
+	long m_lAdmissionTimeout;			// maximum wait in ms for eReqAdmitTimedWait
+	// Incremented every time a request node is freed while requests wait for admission.
+	// Waiting requests sleep on it with Osal_Futex_Wait().
+	_Atomic uint32_t m_u32FreeSeq;
+	_Atomic int m_iAdmitWaiters;		// requests waiting for admission
 };
 
+// request manager, defined in SessionControl.c
+extern struct stReqManager g_objReqManager;
+
+// Hot metadata of a request node
+#define REQ_HOT_META(pstReq) (&g_objReqManager.m_pstReqHot[(pstReq)->m_ulMyId])
+
+// Node index from a transaction id
+#define REQ_TID_INDEX(u16Tid) ((uint32_t)(u16Tid) & g_objReqManager.m_u32TidIndexMask)
+
 typedef struct RTUConnectionData
 {
 	int m_fd;				//	function descriptor
@@ -293,10 +437,19 @@ typedef enum ThreadScheduler
 	UNKNOWN
 }eThreadScheduler;
 
-struct stResProcessData {
-	sem_t m_semaphoreResp;			// response semaphore type
+// Maximum number of responses taken from response queue per wakeup
+#define RESP_QUEUE_BATCH_SIZE 64
+
+typedef struct
+{
 	int32_t m_i32RespMsgQueId;      // response message queue ID
 	Thread_H m_threadIdRespToApp;   // Thread id of response to App
+}stRespDispatcher_t;
+
+struct stResProcessData {
+	// Responses of a context always go to same dispatcher, so they reach App in order
+	stRespDispatcher_t m_astDispatcher[MAX_RESP_DISPATCHERS];
+	uint32_t m_u32DispatcherCount;  // number of dispatchers in use
 };
 
 
@@ -305,11 +458,64 @@ struct stResProcessData {
  * Description
  * Initialize request manager
  *
- * @param none
+ * @param a_pstConfig [in] pool configuration, already validated
  * @return int [out] true (if success)
  * 					false (if failure)
  */
-bool initReqManager();
+bool initReqManager(const stStackInitConfig_t *a_pstConfig);
+
+/**
+ *
+ * Description
+ * De-initialize request manager and release memory of request pool
+ *
+ * @param none
+ * @return none
+ */
+void deinitReqManager(void);
+
+/**
+ *
+ * Description
+ * Register context with request manager to give it a guaranteed share of requests
+ *
+ * @param a_i32Ctx [in] int32_t context id
+ * @param a_u32RespTimeoutMs [in] uint32_t response timeout of context in ms, 0 for stack default
+ * @param a_u32MaxInFlight [in] uint32_t maximum requests in flight on device, 0 for no limit
+ * @return bool [out] true (if success)
+ * 					false (if failure)
+ */
+bool registerReqCtx(int32_t a_i32Ctx, uint32_t a_u32RespTimeoutMs, uint32_t a_u32MaxInFlight);
+
+/**
+ *
+ * Description
+ * Unregister context from request manager
+ *
+ * @param a_i32Ctx [in] int32_t context id
+ * @return none
+ */
+void unregisterReqCtx(int32_t a_i32Ctx);
+
+/**
+ *
+ * Description
+ * Get number of request nodes held by a context
+ *
+ * @param a_i32Ctx [in] int32_t context id
+ * @return uint32_t [out] request nodes in use by context
+ */
+uint32_t getReqCtxInFlight(int32_t a_i32Ctx);
+
+/**
+ *
+ * Description
+ * Fill request pool, response queue and timeout tracker occupancy in stack statistics
+ *
+ * @param a_pstStats [out] stMbusStackStats_t* statistics to fill
+ * @return none
+ */
+void getReqManagerStats(stMbusStackStats_t *a_pstStats);
 
 /**
  *
@@ -317,11 +523,38 @@ bool initReqManager();
  * This function sets data structure to process new request.
  *
  * @param tsReqRcvd [in] const struct timespec
+ * @param a_i32Ctx [in] int32_t context on which request is to be sent
  * @return int [out] pointer to emplaced request
  *
  */
 
-stMbusPacketVariables_t* emplaceNewRequest(const struct timespec tsReqRcvd);
+stMbusPacketVariables_t* emplaceNewRequest(const struct timespec tsReqRcvd, int32_t a_i32Ctx);
+
+/**
+ *
+ * Description
+ * This function sets data structures to process a batch of new requests.
+ *
+ * @param tsReqRcvd 	[in] const struct timespec
+ * @param a_pstReqs 	[in,out] stMbusBatchReq_t* requests of the batch
+ * @param a_u32Count 	[in] uint32_t number of requests in batch
+ * @param a_ppstNodes 	[out] stMbusPacketVariables_t** node emplaced for each request
+ * @return uint32_t [out] number of requests emplaced
+ *
+ */
+uint32_t emplaceNewRequestBatch(const struct timespec tsReqRcvd, stMbusBatchReq_t *a_pstReqs,
+		uint32_t a_u32Count, stMbusPacketVariables_t **a_ppstNodes);
+
+/**
+ *
+ * Description
+ * This function posts new request to message queue of its context as per admission mode.
+ *
+ * @param a_pstMsg [in] Post_Thread_Msg_t* message holding request
+ * @return t_Status [out] STS_MBUS_STACK_NO_ERROR if request is posted
+ *
+ */
+t_Status postNewRequest(Post_Thread_Msg_t *a_pstMsg);
 /**
  *
  * Description
@@ -347,33 +580,26 @@ void set_thread_sched_param();
 
 #ifdef MODBUS_STACK_TCPIP_ENABLED
 
+// Timeout timer is not armed for any deadline
+#define TIMEOUT_TIMER_DISARMED UINT64_MAX
+
 struct stTimeOutTrackerNode {
-	stMbusPacketVariables_t *m_pstStart;  // pointer to modbus start of recieve queue
-	stMbusPacketVariables_t *m_pstLast;	  // pointer to modbus last recive queue
-	int m_iIsLocked;
+	int32_t m_i32Start;	// index of first request in list, REQ_LINK_NONE if empty
+	int32_t m_i32Last;	// index of last request in list, REQ_LINK_NONE if empty
 };
 
+// Requests are kept in a hierarchical timing wheel by their deadline. Insert and removal
+// are O(1); requests of higher levels are moved down when their list becomes due.
 struct stTimeOutTracker {
-	struct stTimeOutTrackerNode *m_pstArray;// pointer to timeout tracker node
-	int m_iSize;							// size
-	_Atomic int m_iCounter;					// counter
-	int32_t m_iTimeoutActionQ;              // Timeout action queue
-	sem_t m_semTimeout;						// Timeout
-	Thread_H m_threadIdTimeoutTimer;		//Thread timeout timer
-	Thread_H m_threadTimeoutAction;			//Thread timeout action
+	struct stTimeOutTrackerNode m_astWheel[TIMEOUT_WHEEL_SIZE];	// lists of all levels of wheel
+	_Atomic int m_iIsLocked;				// spin lock guarding wheel
+	int m_iCount;							// requests in wheel
+	uint64_t m_u64WheelMs;					// deadlines up to this millisecond are processed
+	int m_iTimerFd;							// timer armed for earliest pending deadline
+	_Atomic uint64_t m_u64ArmedMs;			// deadline timer is armed for, TIMEOUT_TIMER_DISARMED if none
+	Mutex_H m_hTimerMutex;					// serializes setting of timer
 };
 
-/**
- *
- * Description
- * Timeout is implemented in the form of counter.
- * This function returns current counter.
- *
- * @param thread argument - none
- * @return return timer tracker count on success& -1 in case of error
- */
-int getTimeoutTrackerCount();
-
 /**
  *
  * Description
@@ -387,29 +613,6 @@ void releaseFromTracker(stMbusPacketVariables_t *pstMBusRequesPacket);
 #endif
 
 #ifdef MODBUS_STACK_TCPIP_ENABLED
-/**
- *
- * Description
- * Stops listening on a socket with epoll.
- * Resets associated data structures.
- * This function acquires lock for epoll data structure.
- *
- * @param Reference to epoll data structure
- * @return None
- */
-void removeEPollRef(int a_iIndex);
-
-/**
- * Description
- * Set socket failure state
- *
- * @param stIPConnect [in] pointer to struct of type IP_Connect_t
- *
- * @return void [out] return status based on condition
- *
- */
-int addtoEPollList(IP_Connect_t *a_pstIPConnect);
-
 /**
  @struct IP_address
  @brief
@@ -491,21 +694,7 @@ typedef enum
 void ApplicationCallBackHandler(stMbusPacketVariables_t *pstMBusRequesPacket,
 		t_Status eMbusStackErr);
 
-#ifdef MODBUS_STACK_TCPIP_ENABLED
-
-/**
- * Description
- * Send modbus packet on network
- *
- * @param pstMBusRequesPacket [in] pointer to request packet struct of type stMbusPacketVariables_t
- * @param a_pstIPConnect [in] pointer to socket struct of type IP_Connect_t
- *
- * @return uint8_t [out] respective error codes
- *
- */
-t_Status Modbus_SendPacket(stMbusPacketVariables_t *pstMBusRequesPacket,
-		IP_Connect_t *m_pstIPConnect);
-#else
+#ifndef MODBUS_STACK_TCPIP_ENABLED
 /**
  * Description
  * This function sends request to Modbus slave device using RTU communication mode. The function
@@ -31,6 +31,11 @@
 #include "osalLinux.h"
 #include <stdio.h>
 #include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
 
 
 /*
@@ -165,180 +170,1504 @@ bool Osal_Thread_Terminate(Thread_H pThreadTerminate)
 } // Osal_Thread_Terminate
 
 /**
- * @fn bool OSAL_Post_Message(Post_Thread_Msg_t *pstPostThreadMsg)
+ * @fn bool Osal_Set_Thread_Affinity(int32_t i32Cpu)
  *
- * @brief The OSAL API copies a message in Linux message queue.
+ * @brief The OSAL API pins calling thread to a CPU.
  *
- * @param pstPostThreadMsg [in] Post_Thread_Msg_t* Pointer to structure to be copied
- * 								in Linux message queue.
+ * @param i32Cpu [in] int32_t CPU to run calling thread on
  *
- * @return true if function succeeds to add message in Linux message queue;
- * 		   false if function fails to add message in Linux message queue
+ * @return true if affinity is set;
+ * 		   false otherwise
  *
  */
-bool OSAL_Post_Message(Post_Thread_Msg_t *pstPostThreadMsg)
+bool Osal_Set_Thread_Affinity(int32_t i32Cpu)
+{
+	cpu_set_t stCpuSet;
+
+	if(i32Cpu < 0 || i32Cpu >= CPU_SETSIZE)
+	{
+		return false;
+	}
+	CPU_ZERO(&stCpuSet);
+	CPU_SET(i32Cpu, &stCpuSet);
+	return (0 == pthread_setaffinity_np(pthread_self(), sizeof(stCpuSet), &stCpuSet));
+} // End of Osal_Set_Thread_Affinity
+
+/*
+ ===============================================================================
+ Message queue implementation
+ ===============================================================================
+ */
+
+/**
+ @struct stOsalMsgCell_t
+ @brief
+   Cell of message queue ring. Sequence number tells whether cell is free for
+   producer at given position or holds message for consumer at given position.
+*/
+typedef struct
+{
+	_Atomic size_t m_szSeq;		// sequence number of cell
+	Linux_Msg_t m_stMsg;		// message stored in cell
+}stOsalMsgCell_t;
+
+// index used as end of node list
+#define OSAL_MSG_NODE_NONE UINT32_MAX
+// id of queue slot which is being deleted, slot is not reused till deletion completes
+#define OSAL_MSG_QUEUE_DELETING (-1)
+// level shared by message types beyond per-type levels
+#define OSAL_MSG_OVERFLOW_LEVEL (OSAL_MSG_PRIORITY_LEVELS - 1)
+
+#if (OSAL_MSG_PRIORITY_LEVELS < 2) || (OSAL_MSG_PRIORITY_LEVELS > 64)
+#error "OSAL_MSG_PRIORITY_LEVELS must be between 2 and 64"
+#endif
+
+/**
+ @struct stOsalMsgNode_t
+ @brief
+   Node holding a message taken from ring by consumer, linked in list of its
+   priority level or kept in heap of overflow level.
+*/
+typedef struct
 {
-	int iStatus = 0;
-	Linux_Msg_t stMsgData;
-	size_t MsgSize = 0;
+	Linux_Msg_t m_stMsg;		// message
+	uint64_t m_u64Seq;			// posting order, used by overflow level
+	uint32_t m_u32Next;			// next node in level or free list
+}stOsalMsgNode_t;
 
-	stMsgData.mtype = pstPostThreadMsg->MsgType;
-	stMsgData.wParam = pstPostThreadMsg->wParam;
-	stMsgData.lParam = pstPostThreadMsg->lParam;
+/**
+ @struct stOsalMsgQueue_t
+ @brief
+   In-process message queue. Producers post to a bounded lock-free ring;
+   consumer moves messages from ring to FIFO lists per priority level. A bitmap
+   of non-empty levels gives the level with lowest message type in O(1), so
+   lowest message type is received first like msgrcv(). Message types beyond
+   per-type levels share an overflow level which is kept ordered in a heap.
+*/
+typedef struct
+{
+	_Atomic int32_t m_i32Id;				// queue id using this slot, 0 if slot is free,
+											// OSAL_MSG_QUEUE_DELETING while it is deleted
+	int32_t m_i32Gen;						// slot generation used to build queue id
+	uint32_t m_u32Size;						// number of ring cells and consumer nodes, power of 2
+	stOsalMsgCell_t *m_pstCells;			// ring of m_u32Size cells
+	stOsalMsgNode_t *m_pstNodes;			// consumer nodes, m_u32Size entries
+	uint32_t m_u32FreeNode;					// first free consumer node
+	uint64_t m_u64LevelMask;				// bit set for each non-empty level
+	uint32_t m_au32LevelHead[OSAL_MSG_OVERFLOW_LEVEL];	// first node of each level
+	uint32_t m_au32LevelTail[OSAL_MSG_OVERFLOW_LEVEL];	// last node of each level
+	uint32_t *m_pu32Heap;					// heap of overflow level nodes
+	uint32_t m_u32HeapCount;				// number of nodes in overflow heap
+	uint64_t m_u64HeapSeq;					// next overflow sequence number
+	_Atomic uint32_t m_u32LevelCount;		// number of messages in all levels
+	_Atomic bool m_bDeleted;				// queue is deleted
+	int m_iEventFd;							// eventfd doorbell of consumer, -1 to use futex
+	_Atomic size_t m_szEnqPos __attribute__((aligned(64)));	// producer position
+	_Atomic uint32_t m_u32SpaceSeq;			// futex for producers waiting on full ring
+	_Atomic int m_iProducersWaiting;		// number of producers waiting on full ring
+	_Atomic int m_iPostsActive;				// posts in progress, slot is not reused while > 0
+	_Atomic size_t m_szDeqPos __attribute__((aligned(64)));	// consumer position
+	_Atomic uint32_t m_u32PostSeq;			// futex for consumer waiting on empty queue
+	_Atomic int m_iConsumerWaiting;			// consumer is waiting on empty queue
+}stOsalMsgQueue_t;
 
-	//calculate the message size
-	MsgSize = sizeof(Linux_Msg_t) - sizeof(long);
+// table of message queues, chunks are allocated as more queues are created and kept
+static stOsalMsgQueue_t *_Atomic g_apstMsgQueueChunks[OSAL_MAX_MSG_QUEUES / OSAL_MSG_QUEUE_CHUNK];
+// number of queue slots in allocated chunks
+static int32_t g_i32MsgQueueSlots = 0;
+// protects allocation of message queue slots
+static pthread_mutex_t g_objMsgQueueMutex = PTHREAD_MUTEX_INITIALIZER;
 
-	//add message to message queue
-	iStatus = msgsnd( pstPostThreadMsg->idThread, &stMsgData, MsgSize, 0);
+/**
+ * @fn static stOsalMsgQueue_t *getMsgQueue(int MsgQId)
+ *
+ * @brief This function returns message queue for given queue id.
+ *
+ * @param MsgQId [in] int Message queue id
+ *
+ * @return [out] stOsalMsgQueue_t* message queue; NULL if id is not valid
+ *
+ */
+static stOsalMsgQueue_t *getMsgQueue(int MsgQId)
+{
+	stOsalMsgQueue_t *pstQueue = NULL;
+	stOsalMsgQueue_t *pstChunk = NULL;
+	int32_t i32Slot = 0;
 
-	if(iStatus == 0)
+	if(MsgQId <= 0)
 	{
-		return true;
+		return NULL;
 	}
-	else
+	i32Slot = (MsgQId - 1) % OSAL_MAX_MSG_QUEUES;
+	pstChunk = atomic_load_explicit(&g_apstMsgQueueChunks[i32Slot / OSAL_MSG_QUEUE_CHUNK],
+			memory_order_acquire);
+	if(NULL == pstChunk)
 	{
-		// addressed review comment
-		perror("Error in msgsnd:: ");
-		return false;
+		return NULL;
 	}
-} // End of OSAL_Post_Message
+	pstQueue = &pstChunk[i32Slot % OSAL_MSG_QUEUE_CHUNK];
+	if(MsgQId != atomic_load(&pstQueue->m_i32Id))
+	{
+		return NULL;
+	}
+	return pstQueue;
+} // End of getMsgQueue
+
+/**
+ * @fn static stOsalMsgQueue_t *enterMsgQueue(int MsgQId)
+ *
+ * @brief This function returns message queue for given queue id and marks a post
+ * in progress on it. Queue is validated again after marking, so a queue deleted
+ * meanwhile, or whose slot is reused by another queue, is not returned. Deletion
+ * of queue waits till posts in progress leave it by leaveMsgQueue().
+ *
+ * @param MsgQId [in] int Message queue id
+ *
+ * @return [out] stOsalMsgQueue_t* message queue; NULL if id is not valid or
+ * 								   queue is deleted
+ *
+ */
+static stOsalMsgQueue_t *enterMsgQueue(int MsgQId)
+{
+	stOsalMsgQueue_t *pstQueue = getMsgQueue(MsgQId);
 
+	if(NULL == pstQueue)
+	{
+		return NULL;
+	}
+	atomic_fetch_add(&pstQueue->m_iPostsActive, 1);
+	if(MsgQId != atomic_load(&pstQueue->m_i32Id) || atomic_load(&pstQueue->m_bDeleted))
+	{
+		atomic_fetch_sub(&pstQueue->m_iPostsActive, 1);
+		return NULL;
+	}
+	return pstQueue;
+} // End of enterMsgQueue
 
 /**
+ * @fn static void leaveMsgQueue(stOsalMsgQueue_t *pstQueue)
  *
- *@fn bool OSAL_Get_Message(Linux_Msg_t *pstQueueMsg, int   msqid)
+ * @brief This function marks end of a post started by enterMsgQueue().
  *
- * @brief The OSAL API retrieves the message from Linux message queue. This function blocks/ waits till
- * either a message is received or an error occurs. It retrieves message of the specified
- * message id and stores message in pstQueueMsg.
+ * @param pstQueue [in] stOsalMsgQueue_t* message queue
  *
- * @param pstQueueMsg [out] Linux_Msg_t* Pointer to structure where message is to be stored.
- * @param msqid 	  [in]  int Linux message id to be retrieved.
+ * @return none
  *
- * @return true if function succeeds in retrieving the message;
- * 		   false if any error occurs while retrieving the message
+ */
+static void leaveMsgQueue(stOsalMsgQueue_t *pstQueue)
+{
+	atomic_fetch_sub(&pstQueue->m_iPostsActive, 1);
+} // End of leaveMsgQueue
+
+/**
+ * @fn static bool popMsgFromRing(stOsalMsgQueue_t *pstQueue, Linux_Msg_t *pstMsg)
+ *
+ * @brief This function takes oldest message from ring of message queue and
+ * wakes producers waiting for free space.
+ *
+ * @param pstQueue 	[in] stOsalMsgQueue_t* message queue
+ * @param pstMsg 	[out] Linux_Msg_t* message taken from ring
+ *
+ * @return [out] bool true if message is taken; false if ring is empty
  *
  */
-bool OSAL_Get_Message(Linux_Msg_t *pstQueueMsg, int   msqid)
+static bool popMsgFromRing(stOsalMsgQueue_t *pstQueue, Linux_Msg_t *pstMsg)
 {
-	int32_t i32RetVal = 0;
+	stOsalMsgCell_t *pstCell = NULL;
+	size_t szPos = atomic_load_explicit(&pstQueue->m_szDeqPos, memory_order_relaxed);
 
-	size_t MsgSize = 0;
+	for(;;)
+	{
+		pstCell = &pstQueue->m_pstCells[szPos & (pstQueue->m_u32Size - 1)];
+		size_t szSeq = atomic_load_explicit(&pstCell->m_szSeq, memory_order_acquire);
+		intptr_t iDiff = (intptr_t)szSeq - (intptr_t)(szPos + 1);
+
+		if(0 == iDiff)
+		{
+			if(atomic_compare_exchange_weak_explicit(&pstQueue->m_szDeqPos, &szPos, szPos + 1,
+					memory_order_relaxed, memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if(iDiff < 0)
+		{
+			// ring is empty
+			return false;
+		}
+		else
+		{
+			szPos = atomic_load_explicit(&pstQueue->m_szDeqPos, memory_order_relaxed);
+		}
+	}
 
-	MsgSize = sizeof(Linux_Msg_t) - sizeof(long);
+	*pstMsg = pstCell->m_stMsg;
+	atomic_store_explicit(&pstCell->m_szSeq, szPos + pstQueue->m_u32Size, memory_order_release);
 
-	// Wait Till Message received or Error other than Signal interrupt
-	do
+	if(atomic_load(&pstQueue->m_iProducersWaiting) > 0)
+	{
+		atomic_fetch_add(&pstQueue->m_u32SpaceSeq, 1);
+		Osal_Futex_Wake(&pstQueue->m_u32SpaceSeq, INT32_MAX);
+	}
+	return true;
+} // End of popMsgFromRing
+
+/**
+ * @fn static uint32_t getMsgLevel(long lMsgType)
+ *
+ * @brief This function maps message type to priority level of message queue.
+ * Message types 1 to (OSAL_MSG_PRIORITY_LEVELS - 1) have a level each;
+ * larger message types share the last (overflow) level.
+ *
+ * @param lMsgType [in] long message type, > 0
+ *
+ * @return [out] uint32_t priority level
+ *
+ */
+static uint32_t getMsgLevel(long lMsgType)
+{
+	if(lMsgType < OSAL_MSG_OVERFLOW_LEVEL + 1)
+	{
+		return (uint32_t)(lMsgType - 1);
+	}
+	return OSAL_MSG_OVERFLOW_LEVEL;
+} // End of getMsgLevel
+
+/**
+ * @fn static bool isMsgNodeLess(const stOsalMsgQueue_t *pstQueue, uint32_t u32A, uint32_t u32B)
+ *
+ * @brief This function compares two nodes of overflow level heap. Lower message
+ * type comes first; messages of same type are kept in posting order.
+ *
+ * @param pstQueue 	[in] const stOsalMsgQueue_t* message queue
+ * @param u32A 		[in] uint32_t index of first node
+ * @param u32B 		[in] uint32_t index of second node
+ *
+ * @return [out] bool true if node u32A comes before node u32B
+ *
+ */
+static bool isMsgNodeLess(const stOsalMsgQueue_t *pstQueue, uint32_t u32A, uint32_t u32B)
+{
+	const stOsalMsgNode_t *pstA = &pstQueue->m_pstNodes[u32A];
+	const stOsalMsgNode_t *pstB = &pstQueue->m_pstNodes[u32B];
+
+	if(pstA->m_stMsg.mtype != pstB->m_stMsg.mtype)
 	{
-		// get the message from message queue
-		i32RetVal = msgrcv(msqid, pstQueueMsg, MsgSize, MAX_RECV_PRIORITY, 0);
-		if(i32RetVal < 0 && errno == EINTR)
+		return pstA->m_stMsg.mtype < pstB->m_stMsg.mtype;
+	}
+	return pstA->m_u64Seq < pstB->m_u64Seq;
+} // End of isMsgNodeLess
+
+/**
+ * @fn static void pushOverflowNode(stOsalMsgQueue_t *pstQueue, uint32_t u32Node)
+ *
+ * @brief This function adds node to heap of overflow level.
+ *
+ * @param pstQueue 	[in] stOsalMsgQueue_t* message queue
+ * @param u32Node 	[in] uint32_t index of node to add
+ *
+ * @return none
+ *
+ */
+static void pushOverflowNode(stOsalMsgQueue_t *pstQueue, uint32_t u32Node)
+{
+	uint32_t *pu32Heap = pstQueue->m_pu32Heap;
+	uint32_t u32Idx = pstQueue->m_u32HeapCount++;
+
+	pstQueue->m_pstNodes[u32Node].m_u64Seq = pstQueue->m_u64HeapSeq++;
+	// sift up
+	while(u32Idx > 0)
+	{
+		uint32_t u32Parent = (u32Idx - 1) / 2;
+		if(!isMsgNodeLess(pstQueue, u32Node, pu32Heap[u32Parent]))
 		{
-			// addressed review comment
-			perror("msgrcv error :; ");
-			continue;
+			break;
 		}
-		else
+		pu32Heap[u32Idx] = pu32Heap[u32Parent];
+		u32Idx = u32Parent;
+	}
+	pu32Heap[u32Idx] = u32Node;
+} // End of pushOverflowNode
+
+/**
+ * @fn static uint32_t popOverflowNode(stOsalMsgQueue_t *pstQueue)
+ *
+ * @brief This function takes node with lowest message type from heap of
+ * overflow level. Heap must not be empty.
+ *
+ * @param pstQueue [in] stOsalMsgQueue_t* message queue
+ *
+ * @return [out] uint32_t index of node taken
+ *
+ */
+static uint32_t popOverflowNode(stOsalMsgQueue_t *pstQueue)
+{
+	uint32_t *pu32Heap = pstQueue->m_pu32Heap;
+	uint32_t u32Top = pu32Heap[0];
+	uint32_t u32Count = --pstQueue->m_u32HeapCount;
+	uint32_t u32Last = pu32Heap[u32Count];
+	uint32_t u32Idx = 0;
+
+	// sift down last node from root
+	for(;;)
+	{
+		uint32_t u32Child = 2 * u32Idx + 1;
+		if(u32Child >= u32Count)
 		{
-			// success
 			break;
 		}
+		if(u32Child + 1 < u32Count && isMsgNodeLess(pstQueue, pu32Heap[u32Child + 1], pu32Heap[u32Child]))
+		{
+			u32Child++;
+		}
+		if(!isMsgNodeLess(pstQueue, pu32Heap[u32Child], u32Last))
+		{
+			break;
+		}
+		pu32Heap[u32Idx] = pu32Heap[u32Child];
+		u32Idx = u32Child;
+	}
+	pu32Heap[u32Idx] = u32Last;
+	return u32Top;
+} // End of popOverflowNode
+
+/**
+ * @fn static void fillMsgLevels(stOsalMsgQueue_t *pstQueue)
+ *
+ * @brief This function moves messages from ring to priority levels of message queue.
+ *
+ * @param pstQueue [in] stOsalMsgQueue_t* message queue
+ *
+ * @return none
+ *
+ */
+static void fillMsgLevels(stOsalMsgQueue_t *pstQueue)
+{
+	uint32_t u32Count = atomic_load_explicit(&pstQueue->m_u32LevelCount, memory_order_relaxed);
+	Linux_Msg_t stMsg;
+
+	while(u32Count < pstQueue->m_u32Size && popMsgFromRing(pstQueue, &stMsg))
+	{
+		uint32_t u32Node = pstQueue->m_u32FreeNode;
+		uint32_t u32Level = getMsgLevel(stMsg.mtype);
+		stOsalMsgNode_t *pstNode = &pstQueue->m_pstNodes[u32Node];
+
+		pstQueue->m_u32FreeNode = pstNode->m_u32Next;
+		pstNode->m_stMsg = stMsg;
+		pstNode->m_u32Next = OSAL_MSG_NODE_NONE;
+
+		if(OSAL_MSG_OVERFLOW_LEVEL == u32Level)
+		{
+			pushOverflowNode(pstQueue, u32Node);
+		}
+		else if(OSAL_MSG_NODE_NONE == pstQueue->m_au32LevelHead[u32Level])
+		{
+			pstQueue->m_au32LevelHead[u32Level] = u32Node;
+			pstQueue->m_au32LevelTail[u32Level] = u32Node;
+		}
+		else
+		{
+			pstQueue->m_pstNodes[pstQueue->m_au32LevelTail[u32Level]].m_u32Next = u32Node;
+			pstQueue->m_au32LevelTail[u32Level] = u32Node;
+		}
+		pstQueue->m_u64LevelMask |= (1ULL << u32Level);
+		atomic_store_explicit(&pstQueue->m_u32LevelCount, ++u32Count, memory_order_relaxed);
+	}
+} // End of fillMsgLevels
+
+/**
+ * @fn static bool popMsgFromLevels(stOsalMsgQueue_t *pstQueue, Linux_Msg_t *pstMsg)
+ *
+ * @brief This function takes oldest message of highest non-empty priority level.
+ *
+ * @param pstQueue 	[in] stOsalMsgQueue_t* message queue
+ * @param pstMsg 	[out] Linux_Msg_t* message taken
+ *
+ * @return [out] bool true if message is taken; false if all levels are empty
+ *
+ */
+static bool popMsgFromLevels(stOsalMsgQueue_t *pstQueue, Linux_Msg_t *pstMsg)
+{
+	uint32_t u32Level = 0;
+	uint32_t u32Node = 0;
 
-	}while(i32RetVal > 0);
+	if(0 == pstQueue->m_u64LevelMask)
+	{
+		return false;
+	}
+	u32Level = (uint32_t)__builtin_ctzll(pstQueue->m_u64LevelMask);
 
-	// Returns Number of Bytes received or Error received
-	return( i32RetVal);
-} // End of OSAL_Get_Message
+	if(OSAL_MSG_OVERFLOW_LEVEL == u32Level)
+	{
+		u32Node = popOverflowNode(pstQueue);
+		if(0 == pstQueue->m_u32HeapCount)
+		{
+			pstQueue->m_u64LevelMask &= ~(1ULL << u32Level);
+		}
+	}
+	else
+	{
+		u32Node = pstQueue->m_au32LevelHead[u32Level];
+		pstQueue->m_au32LevelHead[u32Level] = pstQueue->m_pstNodes[u32Node].m_u32Next;
+		if(OSAL_MSG_NODE_NONE == pstQueue->m_au32LevelHead[u32Level])
+		{
+			pstQueue->m_u64LevelMask &= ~(1ULL << u32Level);
+		}
+	}
+
+	*pstMsg = pstQueue->m_pstNodes[u32Node].m_stMsg;
+	pstQueue->m_pstNodes[u32Node].m_u32Next = pstQueue->m_u32FreeNode;
+	pstQueue->m_u32FreeNode = u32Node;
+	atomic_fetch_sub_explicit(&pstQueue->m_u32LevelCount, 1, memory_order_relaxed);
+	return true;
+} // End of popMsgFromLevels
 
 /**
- * @fn int32_t OSAL_Get_NonBlocking_Message(Linux_Msg_t *pstQueueMsg, int   msqid)
+ * @fn static int32_t popMsgBatch(stOsalMsgQueue_t *pstQueue, Linux_Msg_t *pstMsgs, int32_t i32MaxMsgs)
  *
- * @brief The OSAL API retrieves the message from Linux message queue, without blocking/ waiting
- * for an error or a message. It retrieves message of the specified message id and stores
- * message in pstQueueMsg.
+ * @brief This function pops messages from priority levels, up to i32MaxMsgs. Messages
+ * posted to ring meanwhile are taken as well.
  *
- * @param pstQueueMsg [out] Linux_Msg_t* Pointer to struct where data is copied.
- * @param msqid 	  [in] int Linux message id to be retrieved.
+ * @param pstQueue 		[in] stOsalMsgQueue_t* message queue
+ * @param pstMsgs 		[out] Linux_Msg_t* array where messages are to be stored
+ * @param i32MaxMsgs 	[in] int32_t size of pstMsgs array
  *
- * @return true if function succeeds in retrieving the message;
- * 		   false if any error occurs while retrieving the message
+ * @return [out] int32_t number of messages popped
  *
  */
-int32_t OSAL_Get_NonBlocking_Message(Linux_Msg_t *pstQueueMsg, int   msqid)
+static int32_t popMsgBatch(stOsalMsgQueue_t *pstQueue, Linux_Msg_t *pstMsgs, int32_t i32MaxMsgs)
 {
-	int32_t i32RetVal = 0;
+	int32_t i32Count = 0;
 
-	size_t MsgSize = 0;
+	while(i32Count < i32MaxMsgs)
+	{
+		if(false == popMsgFromLevels(pstQueue, &pstMsgs[i32Count]))
+		{
+			// take messages posted meanwhile as well
+			fillMsgLevels(pstQueue);
+			if(false == popMsgFromLevels(pstQueue, &pstMsgs[i32Count]))
+			{
+				break;
+			}
+		}
+		i32Count++;
+	}
+	return i32Count;
+} // End of popMsgBatch
 
-	MsgSize = sizeof(Linux_Msg_t) - sizeof(long);
+/**
+ * @fn static void wakeMsgConsumer(stOsalMsgQueue_t *pstQueue)
+ *
+ * @brief This function wakes consumer of message queue through its eventfd
+ * doorbell or futex.
+ *
+ * @param pstQueue [in] stOsalMsgQueue_t* message queue
+ *
+ * @return none
+ *
+ */
+static void wakeMsgConsumer(stOsalMsgQueue_t *pstQueue)
+{
+	if(pstQueue->m_iEventFd >= 0)
+	{
+		uint64_t u64Val = 1;
+		if(sizeof(u64Val) != write(pstQueue->m_iEventFd, &u64Val, sizeof(u64Val)))
+		{
+			perror("Message queue doorbell write failed:: ");
+		}
+	}
+	else
+	{
+		atomic_fetch_add(&pstQueue->m_u32PostSeq, 1);
+		Osal_Futex_Wake(&pstQueue->m_u32PostSeq, INT32_MAX);
+	}
+} // End of wakeMsgConsumer
 
-    // Wait Till Message received or Error other than Signal interrupt
-    i32RetVal = msgrcv(msqid, pstQueueMsg, MsgSize, MAX_RECV_PRIORITY, MSG_NOERROR | IPC_NOWAIT);
-    if(errno == ENOMSG && (-1 == i32RetVal) && EINTR == errno)
-    {
-    	// addressed review comment
-    	perror("failed to recv msg from queue ::");
-    	i32RetVal = -1;
-    }
+/**
+ * @fn static bool waitForMsg(stOsalMsgQueue_t *pstQueue)
+ *
+ * @brief This function moves messages from ring to priority levels and, if there
+ * are none, sleeps till a message is posted or queue is deleted. Sleep is a
+ * thread cancellation point.
+ *
+ * @param pstQueue [in] stOsalMsgQueue_t* message queue
+ *
+ * @return [out] bool true if messages are available in priority levels;
+ * 					  false if queue is deleted
+ *
+ */
+static bool waitForMsg(stOsalMsgQueue_t *pstQueue)
+{
+	for(;;)
+	{
+		uint32_t u32Seq = 0;
 
-    // Returns Number of Bytes received or Error received
-	return( i32RetVal);
-} //End of OSAL_Get_NonBlocking_Message
+		pthread_testcancel();
+		fillMsgLevels(pstQueue);
+		if(0 != atomic_load_explicit(&pstQueue->m_u32LevelCount, memory_order_relaxed))
+		{
+			return true;
+		}
+		if(atomic_load(&pstQueue->m_bDeleted))
+		{
+			return false;
+		}
 
+		// announce wait and recheck, so a post in between is not missed
+		u32Seq = atomic_load(&pstQueue->m_u32PostSeq);
+		atomic_store(&pstQueue->m_iConsumerWaiting, 1);
+		fillMsgLevels(pstQueue);
+		if(0 == atomic_load_explicit(&pstQueue->m_u32LevelCount, memory_order_relaxed)
+				&& false == atomic_load(&pstQueue->m_bDeleted))
+		{
+			if(pstQueue->m_iEventFd >= 0)
+			{
+				// read is a cancellation point and resets doorbell
+				uint64_t u64Val = 0;
+				if(-1 == read(pstQueue->m_iEventFd, &u64Val, sizeof(u64Val)) && EINTR != errno)
+				{
+					perror("Message queue doorbell read failed:: ");
+					atomic_store(&pstQueue->m_iConsumerWaiting, 0);
+					return false;
+				}
+			}
+			else
+			{
+				int iOldType = 0;
+				// futex wait is not a cancellation point, allow cancel while sleeping
+				pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, &iOldType);
+				Osal_Futex_Wait(&pstQueue->m_u32PostSeq, u32Seq, NULL);
+				pthread_setcanceltype(iOldType, NULL);
+			}
+		}
+		atomic_store(&pstQueue->m_iConsumerWaiting, 0);
+	}
+} // End of waitForMsg
 
 /**
- *@fn  int32_t OSAL_Init_Message_Queue()
+ * @fn static bool postMsgToQueue(stOsalMsgQueue_t *pstQueue, const Post_Thread_Msg_t *pstPostThreadMsg,
+ * 		long lTimeoutMs)
  *
- *@brief This OSAL API initializes the Linux message queue to store requests sent to
- * the Modbus slave device.
+ * @brief This function copies a message in ring of message queue, waiting for
+ * free space at most for given timeout. Caller must have entered queue by
+ * enterMsgQueue(), so that slot is not reused meanwhile.
  *
- * @param Nothing
+ * @param pstQueue 		   [in] stOsalMsgQueue_t* message queue
+ * @param pstPostThreadMsg [in] const Post_Thread_Msg_t* message to be copied
+ * @param lTimeoutMs 	   [in] long maximum wait in ms; 0 not to wait, < 0 to wait without timeout
  *
- * @return [out] int32_t Linux message queue id if function succeeds
- * 				   		-1 in case if function fails to create a message queue
+ * @return [out] bool true if message is added; false with errno EIDRM if queue is
+ * 					  deleted, or with errno EAGAIN if queue is still full when timeout expires
  *
  */
-int32_t OSAL_Init_Message_Queue()
+static bool postMsgToQueue(stOsalMsgQueue_t *pstQueue, const Post_Thread_Msg_t *pstPostThreadMsg,
+		long lTimeoutMs)
 {
-    int msqid = 0;
+	stOsalMsgCell_t *pstCell = NULL;
+	size_t szPos = 0;
+	struct timespec tsDeadline = {0};
+	struct timespec tsNow = {0};
+	struct timespec tsWait = {0};
 
-    // Initialize the message queue
-    msqid = msgget(IPC_PRIVATE, (IPC_CREAT | IPC_EXCL | 0666));
+	if(lTimeoutMs > 0)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &tsDeadline);
+		tsDeadline.tv_sec += lTimeoutMs / 1000;
+		tsDeadline.tv_nsec += (lTimeoutMs % 1000) * 1000000L;
+		if(tsDeadline.tv_nsec >= 1000000000L)
+		{
+			tsDeadline.tv_sec++;
+			tsDeadline.tv_nsec -= 1000000000L;
+		}
+	}
 
-    if(msqid < 0)
-    {
-    	perror("failed to create message queue:: ");
-    	return -1;
-    }
+	szPos = atomic_load_explicit(&pstQueue->m_szEnqPos, memory_order_relaxed);
+	for(;;)
+	{
+		pstCell = &pstQueue->m_pstCells[szPos & (pstQueue->m_u32Size - 1)];
+		size_t szSeq = atomic_load_explicit(&pstCell->m_szSeq, memory_order_acquire);
+		intptr_t iDiff = (intptr_t)szSeq - (intptr_t)szPos;
 
-    return msqid;
-} // End of OSAL_Init_Message_Queue
+		if(0 == iDiff)
+		{
+			if(atomic_compare_exchange_weak_explicit(&pstQueue->m_szEnqPos, &szPos, szPos + 1,
+					memory_order_relaxed, memory_order_relaxed))
+			{
+				break;
+			}
+		}
+		else if(iDiff < 0)
+		{
+			// ring is full, wait till consumer takes a message
+			uint32_t u32Seq = 0;
+			if(0 == lTimeoutMs)
+			{
+				errno = EAGAIN;
+				return false;
+			}
+			if(lTimeoutMs > 0)
+			{
+				clock_gettime(CLOCK_MONOTONIC, &tsNow);
+				tsWait.tv_sec = tsDeadline.tv_sec - tsNow.tv_sec;
+				tsWait.tv_nsec = tsDeadline.tv_nsec - tsNow.tv_nsec;
+				if(tsWait.tv_nsec < 0)
+				{
+					tsWait.tv_sec--;
+					tsWait.tv_nsec += 1000000000L;
+				}
+				if(tsWait.tv_sec < 0)
+				{
+					errno = EAGAIN;
+					return false;
+				}
+			}
+			u32Seq = atomic_load(&pstQueue->m_u32SpaceSeq);
+			atomic_fetch_add(&pstQueue->m_iProducersWaiting, 1);
+			if(atomic_load(&pstQueue->m_bDeleted))
+			{
+				atomic_fetch_sub(&pstQueue->m_iProducersWaiting, 1);
+				errno = EIDRM;
+				return false;
+			}
+			if(szSeq == atomic_load_explicit(&pstCell->m_szSeq, memory_order_acquire))
+			{
+				Osal_Futex_Wait(&pstQueue->m_u32SpaceSeq, u32Seq, (lTimeoutMs > 0) ? &tsWait : NULL);
+			}
+			atomic_fetch_sub(&pstQueue->m_iProducersWaiting, 1);
+			if(atomic_load(&pstQueue->m_bDeleted))
+			{
+				// queue is deleted while waiting, message is not to be published
+				errno = EIDRM;
+				return false;
+			}
+			szPos = atomic_load_explicit(&pstQueue->m_szEnqPos, memory_order_relaxed);
+		}
+		else
+		{
+			szPos = atomic_load_explicit(&pstQueue->m_szEnqPos, memory_order_relaxed);
+		}
+	}
+
+	pstCell->m_stMsg.mtype = pstPostThreadMsg->MsgType;
+	pstCell->m_stMsg.wParam = pstPostThreadMsg->wParam;
+	pstCell->m_stMsg.lParam = pstPostThreadMsg->lParam;
+	atomic_store_explicit(&pstCell->m_szSeq, szPos + 1, memory_order_release);
+
+	// wake consumer only if it sleeps on empty queue; first producer to see
+	// empty to non-empty transition rings the doorbell, others skip it
+	if(atomic_load(&pstQueue->m_iConsumerWaiting) &&
+			1 == atomic_exchange(&pstQueue->m_iConsumerWaiting, 0))
+	{
+		wakeMsgConsumer(pstQueue);
+	}
+	return true;
+} // End of postMsgToQueue
 
 /**
- * @fn bool OSAL_Delete_Message_Queue(int MsgQId)
+ * @fn bool OSAL_Post_Message_Timed(Post_Thread_Msg_t *pstPostThreadMsg, long lTimeoutMs)
  *
- * @brief This OSAL API deletes message queue with specified message queue id.
+ * @brief The OSAL API copies a message in message queue. If queue is full,
+ * function waits till consumer frees space, at most for given timeout.
+ * With timeout 0 function never waits, so it can be used by a thread which
+ * must not block, e.g. an event loop.
  *
- * @param MsgQId [in] int Message queue id to delete
+ * @param pstPostThreadMsg [in] Post_Thread_Msg_t* Pointer to structure to be copied
+ * 								in message queue.
+ * @param lTimeoutMs 	   [in] long maximum wait in ms for free space;
+ * 								0 not to wait, < 0 to wait without timeout
  *
- * @return [out] bool true if function deletes the message queue successfully;
- * 					  false if function fails to delete the message queue
+ * @return true if function succeeds to add message in message queue;
+ * 		   false if function fails to add message in message queue, errno is
+ * 		   EAGAIN if queue is still full when timeout expires, like msgsnd()
  *
  */
-bool OSAL_Delete_Message_Queue(int MsgQId)
+bool OSAL_Post_Message_Timed(Post_Thread_Msg_t *pstPostThreadMsg, long lTimeoutMs)
 {
-	int iStatus = 0;
-	// delete the message queue according to message id
-	iStatus = msgctl(MsgQId, IPC_RMID, NULL);
+	stOsalMsgQueue_t *pstQueue = NULL;
+	bool bRet = false;
 
-    if(iStatus < 0)
-    {
-    	perror("failed to delete message queue:: ");
-    	return false;
-    }
-    return true;
-} // End of  OSAL_Delete_Message_Queue
+	if(NULL == pstPostThreadMsg || pstPostThreadMsg->MsgType <= 0)
+	{
+		printf("Invalid message posted to message queue\n");
+		errno = EINVAL;
+		return false;
+	}
+	pstQueue = enterMsgQueue(pstPostThreadMsg->idThread);
+	if(NULL == pstQueue)
+	{
+		printf("Message posted to invalid message queue %d\n", pstPostThreadMsg->idThread);
+		errno = EINVAL;
+		return false;
+	}
+	bRet = postMsgToQueue(pstQueue, pstPostThreadMsg, lTimeoutMs);
+	leaveMsgQueue(pstQueue);
+	return bRet;
+} // End of OSAL_Post_Message_Timed
+
+/**
+ * @fn bool OSAL_Post_Message(Post_Thread_Msg_t *pstPostThreadMsg)
+ *
+ * @brief The OSAL API copies a message in message queue. If queue is full,
+ * function waits till consumer frees space.
+ *
+ * @param pstPostThreadMsg [in] Post_Thread_Msg_t* Pointer to structure to be copied
+ * 								in message queue.
+ *
+ * @return true if function succeeds to add message in message queue;
+ * 		   false if function fails to add message in message queue
+ *
+ */
+bool OSAL_Post_Message(Post_Thread_Msg_t *pstPostThreadMsg)
+{
+	return OSAL_Post_Message_Timed(pstPostThreadMsg, -1);
+} // End of OSAL_Post_Message
+
+
+/**
+ *
+ *@fn bool OSAL_Get_Message(Linux_Msg_t *pstQueueMsg, int   msqid)
+ *
+ * @brief The OSAL API retrieves the message from message queue. This function blocks/ waits till
+ * either a message is received or queue is deleted. Message with lowest message type
+ * is retrieved first and stored in pstQueueMsg. Only one thread should receive
+ * from a message queue. Waiting in this function is a thread cancellation point.
+ *
+ * @param pstQueueMsg [out] Linux_Msg_t* Pointer to structure where message is to be stored.
+ * @param msqid 	  [in]  int message queue id.
+ *
+ * @return true if function succeeds in retrieving the message;
+ * 		   false if any error occurs while retrieving the message
+ *
+ */
+bool OSAL_Get_Message(Linux_Msg_t *pstQueueMsg, int   msqid)
+{
+	stOsalMsgQueue_t *pstQueue = getMsgQueue(msqid);
+
+	if(NULL == pstQueue || NULL == pstQueueMsg)
+	{
+		return false;
+	}
+	if(false == waitForMsg(pstQueue))
+	{
+		return false;
+	}
+	return popMsgFromLevels(pstQueue, pstQueueMsg);
+} // End of OSAL_Get_Message
+
+/**
+ *
+ *@fn int32_t OSAL_Get_Message_Batch(Linux_Msg_t *pstQueueMsgs, int32_t i32MaxMsgs, int msqid)
+ *
+ * @brief The OSAL API retrieves all messages ready in message queue, up to i32MaxMsgs,
+ * in a single call. This function blocks/ waits till at least one message is received
+ * or queue is deleted. Messages are stored in order of message type like OSAL_Get_Message().
+ * Only one thread should receive from a message queue.
+ *
+ * @param pstQueueMsgs 	[out] Linux_Msg_t* array where messages are to be stored.
+ * @param i32MaxMsgs 	[in]  int32_t size of pstQueueMsgs array
+ * @param msqid 	  	[in]  int message queue id.
+ *
+ * @return [out] int32_t number of messages retrieved (> 0);
+ * 		   -1 if any error occurs while retrieving the messages
+ *
+ */
+int32_t OSAL_Get_Message_Batch(Linux_Msg_t *pstQueueMsgs, int32_t i32MaxMsgs, int msqid)
+{
+	stOsalMsgQueue_t *pstQueue = getMsgQueue(msqid);
+	int32_t i32Count = 0;
+
+	if(NULL == pstQueue || NULL == pstQueueMsgs || i32MaxMsgs <= 0)
+	{
+		return -1;
+	}
+	if(false == waitForMsg(pstQueue))
+	{
+		return -1;
+	}
+	i32Count = popMsgBatch(pstQueue, pstQueueMsgs, i32MaxMsgs);
+	return i32Count;
+} // End of OSAL_Get_Message_Batch
+
+/**
+ *
+ *@fn int32_t OSAL_Poll_Message_Batch(Linux_Msg_t *pstQueueMsgs, int32_t i32MaxMsgs, int msqid)
+ *
+ * @brief The OSAL API retrieves messages ready in message queue, up to i32MaxMsgs, without
+ * blocking/ waiting. It is used by a consumer which polls eventfd doorbell of a queue created
+ * using OSAL_Init_Event_Message_Queue() along with other descriptors. If queue is empty,
+ * doorbell is armed, so that next posted message writes it. Consumer should call this
+ * function till it returns 0, else doorbell is not armed.
+ * Only one thread should receive from a message queue.
+ *
+ * @param pstQueueMsgs 	[out] Linux_Msg_t* array where messages are to be stored.
+ * @param i32MaxMsgs 	[in]  int32_t size of pstQueueMsgs array
+ * @param msqid 	  	[in]  int message queue id.
+ *
+ * @return [out] int32_t number of messages retrieved; 0 if queue is empty and doorbell is armed;
+ * 		   -1 if queue is deleted or any error occurs
+ *
+ */
+int32_t OSAL_Poll_Message_Batch(Linux_Msg_t *pstQueueMsgs, int32_t i32MaxMsgs, int msqid)
+{
+	stOsalMsgQueue_t *pstQueue = getMsgQueue(msqid);
+	int32_t i32Count = 0;
+
+	if(NULL == pstQueue || NULL == pstQueueMsgs || i32MaxMsgs <= 0 ||
+			atomic_load(&pstQueue->m_bDeleted))
+	{
+		return -1;
+	}
+	fillMsgLevels(pstQueue);
+	i32Count = popMsgBatch(pstQueue, pstQueueMsgs, i32MaxMsgs);
+	if(0 == i32Count)
+	{
+		// announce wait and recheck, so a post in between is not missed
+		atomic_store(&pstQueue->m_iConsumerWaiting, 1);
+		fillMsgLevels(pstQueue);
+		i32Count = popMsgBatch(pstQueue, pstQueueMsgs, i32MaxMsgs);
+		if(0 != i32Count)
+		{
+			// at most a spurious doorbell is left if a producer rang it meanwhile
+			atomic_store(&pstQueue->m_iConsumerWaiting, 0);
+		}
+	}
+	return i32Count;
+} // End of OSAL_Poll_Message_Batch
+
+/**
+ * @fn int32_t OSAL_Get_NonBlocking_Message(Linux_Msg_t *pstQueueMsg, int   msqid)
+ *
+ * @brief The OSAL API retrieves the message from message queue, without blocking/ waiting
+ * for a message. Message with lowest message type is retrieved first and stored
+ * in pstQueueMsg.
+ *
+ * @param pstQueueMsg [out] Linux_Msg_t* Pointer to struct where data is copied.
+ * @param msqid 	  [in] int message queue id.
+ *
+ * @return [out] int32_t size of message data if message is retrieved;
+ * 		   -1 if queue is empty or any error occurs
+ *
+ */
+int32_t OSAL_Get_NonBlocking_Message(Linux_Msg_t *pstQueueMsg, int   msqid)
+{
+	stOsalMsgQueue_t *pstQueue = getMsgQueue(msqid);
+
+	if(NULL == pstQueue || NULL == pstQueueMsg)
+	{
+		return -1;
+	}
+
+	fillMsgLevels(pstQueue);
+	if(popMsgFromLevels(pstQueue, pstQueueMsg))
+	{
+		return (int32_t)(sizeof(Linux_Msg_t) - sizeof(long));
+	}
+	return -1;
+} //End of OSAL_Get_NonBlocking_Message
+
+
+/**
+ * @fn static int32_t initMsgQueue(bool bEventFd, uint32_t u32Size)
+ *
+ * @brief This function allocates and initializes a message queue slot.
+ *
+ * @param bEventFd [in] bool true to wake consumer through an eventfd doorbell;
+ * 						false to wake it through a futex
+ * @param u32Size  [in] uint32_t number of messages ring holds, rounded up to power of 2;
+ * 						0 selects OSAL_MSG_QUEUE_SIZE
+ *
+ * @return [out] int32_t message queue id (> 0) if function succeeds
+ * 				   		-1 in case if function fails to create a message queue
+ *
+ */
+static int32_t initMsgQueue(bool bEventFd, uint32_t u32Size)
+{
+	stOsalMsgQueue_t *pstQueue = NULL;
+	int32_t i32Slot = 0;
+	int32_t i32Id = -1;
+	size_t szIdx = 0;
+	int iEventFd = -1;
+	uint32_t u32RingSize = OSAL_MSG_QUEUE_SIZE;
+
+	if(u32Size > OSAL_MSG_QUEUE_MAX_SIZE)
+	{
+		printf("failed to create message queue:: size %u is too large\n", u32Size);
+		return -1;
+	}
+	if(0 != u32Size)
+	{
+		u32RingSize = 1;
+		while(u32RingSize < u32Size)
+		{
+			u32RingSize <<= 1;
+		}
+	}
+
+	if(bEventFd)
+	{
+		iEventFd = eventfd(0, EFD_CLOEXEC);
+		if(iEventFd < 0)
+		{
+			perror("failed to create message queue doorbell:: ");
+			return -1;
+		}
+	}
+
+	pthread_mutex_lock(&g_objMsgQueueMutex);
+	for(i32Slot = 0; i32Slot < g_i32MsgQueueSlots; i32Slot++)
+	{
+		stOsalMsgQueue_t *pstSlot = atomic_load(&g_apstMsgQueueChunks[i32Slot / OSAL_MSG_QUEUE_CHUNK]) +
+				(i32Slot % OSAL_MSG_QUEUE_CHUNK);
+		// slot is reused only when no post on its previous queue is in progress
+		if(0 == atomic_load(&pstSlot->m_i32Id) && 0 == atomic_load(&pstSlot->m_iPostsActive))
+		{
+			pstQueue = pstSlot;
+			break;
+		}
+	}
+	if(NULL == pstQueue && g_i32MsgQueueSlots < OSAL_MAX_MSG_QUEUES)
+	{
+		// all queues are in use, grow table by a chunk
+		stOsalMsgQueue_t *pstChunk = aligned_alloc(_Alignof(stOsalMsgQueue_t),
+				OSAL_MSG_QUEUE_CHUNK * sizeof(stOsalMsgQueue_t));
+		if(NULL != pstChunk)
+		{
+			memset(pstChunk, 0, OSAL_MSG_QUEUE_CHUNK * sizeof(stOsalMsgQueue_t));
+			atomic_store_explicit(&g_apstMsgQueueChunks[g_i32MsgQueueSlots / OSAL_MSG_QUEUE_CHUNK],
+					pstChunk, memory_order_release);
+			i32Slot = g_i32MsgQueueSlots;
+			pstQueue = &pstChunk[0];
+			g_i32MsgQueueSlots += OSAL_MSG_QUEUE_CHUNK;
+		}
+	}
+	if(NULL == pstQueue)
+	{
+		pthread_mutex_unlock(&g_objMsgQueueMutex);
+		printf("failed to create message queue:: no free queue\n");
+		if(iEventFd >= 0)
+		{
+			close(iEventFd);
+		}
+		return -1;
+	}
+
+	// memory is kept when queue is deleted and reused with slot if size is same
+	if(NULL != pstQueue->m_pstCells && u32RingSize != pstQueue->m_u32Size)
+	{
+		free(pstQueue->m_pstCells);
+		free(pstQueue->m_pstNodes);
+		free(pstQueue->m_pu32Heap);
+		pstQueue->m_pstCells = NULL;
+		pstQueue->m_pstNodes = NULL;
+		pstQueue->m_pu32Heap = NULL;
+	}
+	if(NULL == pstQueue->m_pstCells)
+	{
+		pstQueue->m_u32Size = u32RingSize;
+		pstQueue->m_pstCells = calloc(u32RingSize, sizeof(stOsalMsgCell_t));
+		pstQueue->m_pstNodes = calloc(u32RingSize, sizeof(stOsalMsgNode_t));
+		pstQueue->m_pu32Heap = calloc(u32RingSize, sizeof(uint32_t));
+		if(NULL == pstQueue->m_pstCells || NULL == pstQueue->m_pstNodes || NULL == pstQueue->m_pu32Heap)
+		{
+			free(pstQueue->m_pstCells);
+			free(pstQueue->m_pstNodes);
+			free(pstQueue->m_pu32Heap);
+			pstQueue->m_pstCells = NULL;
+			pstQueue->m_pstNodes = NULL;
+			pstQueue->m_pu32Heap = NULL;
+			pthread_mutex_unlock(&g_objMsgQueueMutex);
+			printf("failed to create message queue:: no memory\n");
+			if(iEventFd >= 0)
+			{
+				close(iEventFd);
+			}
+			return -1;
+		}
+	}
+	for(szIdx = 0; szIdx < u32RingSize; szIdx++)
+	{
+		atomic_store_explicit(&pstQueue->m_pstCells[szIdx].m_szSeq, szIdx, memory_order_relaxed);
+		pstQueue->m_pstNodes[szIdx].m_u32Next = (szIdx + 1 < u32RingSize) ?
+				(uint32_t)(szIdx + 1) : OSAL_MSG_NODE_NONE;
+	}
+	for(szIdx = 0; szIdx < OSAL_MSG_OVERFLOW_LEVEL; szIdx++)
+	{
+		pstQueue->m_au32LevelHead[szIdx] = OSAL_MSG_NODE_NONE;
+		pstQueue->m_au32LevelTail[szIdx] = OSAL_MSG_NODE_NONE;
+	}
+	pstQueue->m_u32FreeNode = 0;
+	pstQueue->m_u64LevelMask = 0;
+	pstQueue->m_u32HeapCount = 0;
+	atomic_store(&pstQueue->m_szEnqPos, 0);
+	atomic_store(&pstQueue->m_szDeqPos, 0);
+	atomic_store(&pstQueue->m_u32LevelCount, 0);
+	pstQueue->m_u64HeapSeq = 0;
+	atomic_store(&pstQueue->m_iProducersWaiting, 0);
+	atomic_store(&pstQueue->m_iConsumerWaiting, 0);
+	atomic_store(&pstQueue->m_bDeleted, false);
+	pstQueue->m_iEventFd = iEventFd;
+
+	// queue id carries slot generation, so id of deleted queue is not reused at once
+	pstQueue->m_i32Gen = (pstQueue->m_i32Gen + 1) % (INT32_MAX / OSAL_MAX_MSG_QUEUES);
+	i32Id = pstQueue->m_i32Gen * OSAL_MAX_MSG_QUEUES + i32Slot + 1;
+	atomic_store(&pstQueue->m_i32Id, i32Id);
+	pthread_mutex_unlock(&g_objMsgQueueMutex);
+
+	return i32Id;
+} // End of initMsgQueue
+
+/**
+ *@fn  int32_t OSAL_Init_Message_Queue()
+ *
+ *@brief This OSAL API initializes the message queue to store requests sent to
+ * the Modbus slave device.
+ *
+ * @param Nothing
+ *
+ * @return [out] int32_t message queue id (> 0) if function succeeds
+ * 				   		-1 in case if function fails to create a message queue
+ *
+ */
+int32_t OSAL_Init_Message_Queue()
+{
+	return initMsgQueue(false, 0);
+} // End of OSAL_Init_Message_Queue
+
+/**
+ *@fn  int32_t OSAL_Init_Event_Message_Queue(uint32_t u32Size)
+ *
+ *@brief This OSAL API initializes a message queue whose consumer sleeps on an
+ * eventfd doorbell. Doorbell is written only when a message is posted to a
+ * queue whose consumer waits on it empty, and can be polled using
+ * OSAL_Get_Message_Queue_Event_Fd().
+ *
+ * @param u32Size [in] uint32_t number of messages ring of queue holds, rounded up
+ * 					   to power of 2; 0 selects OSAL_MSG_QUEUE_SIZE
+ *
+ * @return [out] int32_t message queue id (> 0) if function succeeds
+ * 				   		-1 in case if function fails to create a message queue
+ *
+ */
+int32_t OSAL_Init_Event_Message_Queue(uint32_t u32Size)
+{
+	return initMsgQueue(true, u32Size);
+} // End of OSAL_Init_Event_Message_Queue
+
+/**
+ * @fn int32_t OSAL_Get_Message_Queue_Event_Fd(int MsgQId)
+ *
+ * @brief This OSAL API returns eventfd doorbell of message queue created using
+ * OSAL_Init_Event_Message_Queue().
+ *
+ * @param MsgQId [in] int Message queue id
+ *
+ * @return [out] int32_t eventfd of message queue;
+ * 						 -1 if queue id is not valid or queue has no doorbell
+ *
+ */
+int32_t OSAL_Get_Message_Queue_Event_Fd(int MsgQId)
+{
+	stOsalMsgQueue_t *pstQueue = getMsgQueue(MsgQId);
+
+	if(NULL == pstQueue)
+	{
+		return -1;
+	}
+	return pstQueue->m_iEventFd;
+} // End of OSAL_Get_Message_Queue_Event_Fd
+
+/**
+ * @fn bool OSAL_Ring_Message_Queue(int MsgQId)
+ *
+ * @brief This OSAL API wakes consumer of message queue without posting a message.
+ * Unlike OSAL_Post_Message(), consumer is woken even if it does not wait on empty
+ * queue; it is used when consumer has left messages in queue and is to take them now.
+ *
+ * @param MsgQId [in] int Message queue id
+ *
+ * @return [out] bool true if consumer is woken;
+ * 					  false if queue id is not valid or queue is deleted
+ *
+ */
+bool OSAL_Ring_Message_Queue(int MsgQId)
+{
+	// doorbell is not closed by deletion while it is rung
+	stOsalMsgQueue_t *pstQueue = enterMsgQueue(MsgQId);
+
+	if(NULL == pstQueue)
+	{
+		return false;
+	}
+	wakeMsgConsumer(pstQueue);
+	leaveMsgQueue(pstQueue);
+	return true;
+} // End of OSAL_Ring_Message_Queue
+
+/**
+ * @fn bool OSAL_Delete_Message_Queue(int MsgQId)
+ *
+ * @brief This OSAL API deletes message queue with specified message queue id.
+ * Threads waiting on queue are woken up and messages still in queue are dropped.
+ * Function returns after posts in progress on queue have left it; slot of queue
+ * and its doorbell are not reused before that.
+ *
+ * @param MsgQId [in] int Message queue id to delete
+ *
+ * @return [out] bool true if function deletes the message queue successfully;
+ * 					  false if function fails to delete the message queue
+ *
+ */
+bool OSAL_Delete_Message_Queue(int MsgQId)
+{
+	stOsalMsgQueue_t *pstQueue = NULL;
+
+	pthread_mutex_lock(&g_objMsgQueueMutex);
+	pstQueue = getMsgQueue(MsgQId);
+	if(NULL == pstQueue)
+	{
+		pthread_mutex_unlock(&g_objMsgQueueMutex);
+		printf("failed to delete message queue:: invalid queue id %d\n", MsgQId);
+		return false;
+	}
+	atomic_store(&pstQueue->m_bDeleted, true);
+	// id is invalid from now on, but slot is not free till deletion completes
+	atomic_store(&pstQueue->m_i32Id, OSAL_MSG_QUEUE_DELETING);
+	pthread_mutex_unlock(&g_objMsgQueueMutex);
+
+	// wake waiting threads so that they see deleted queue
+	wakeMsgConsumer(pstQueue);
+	atomic_fetch_add(&pstQueue->m_u32SpaceSeq, 1);
+	Osal_Futex_Wake(&pstQueue->m_u32SpaceSeq, INT32_MAX);
+	// posts in progress see deleted queue and leave it soon; doorbell
+	// may still be rung by them, so it is closed only after that
+	while(atomic_load(&pstQueue->m_iPostsActive) > 0)
+	{
+		sched_yield();
+	}
+	if(pstQueue->m_iEventFd >= 0)
+	{
+		close(pstQueue->m_iEventFd);
+		pstQueue->m_iEventFd = -1;
+	}
+
+	pthread_mutex_lock(&g_objMsgQueueMutex);
+	atomic_store(&pstQueue->m_i32Id, 0);
+	pthread_mutex_unlock(&g_objMsgQueueMutex);
+
+    return true;
+} // End of  OSAL_Delete_Message_Queue
+
+/**
+ * @fn int32_t OSAL_Get_Message_Count(int MsgQId)
+ *
+ * @brief This OSAL API gets number of messages currently in message queue.
+ *
+ * @param MsgQId [in] int Message queue id
+ *
+ * @return [out] int32_t number of messages in queue;
+ * 						 -1 if queue id is not valid
+ *
+ */
+int32_t OSAL_Get_Message_Count(int MsgQId)
+{
+	stOsalMsgQueue_t *pstQueue = getMsgQueue(MsgQId);
+	size_t szEnq = 0;
+	size_t szDeq = 0;
+
+	if(NULL == pstQueue)
+	{
+		return -1;
+	}
+	szDeq = atomic_load(&pstQueue->m_szDeqPos);
+	szEnq = atomic_load(&pstQueue->m_szEnqPos);
+	// positions are read without lock, do not report less than zero
+	if(szEnq < szDeq)
+	{
+		szEnq = szDeq;
+	}
+	return (int32_t)(szEnq - szDeq) + (int32_t)atomic_load(&pstQueue->m_u32LevelCount);
+} // End of OSAL_Get_Message_Count
+
+/**
+ * @fn int32_t Osal_Futex_Wait(_Atomic uint32_t *pu32Addr, uint32_t u32Expected,
+ * 		const struct timespec *pstTimeout)
+ *
+ * @brief This OSAL API puts calling thread to sleep as long as value at pu32Addr is
+ * equal to u32Expected, until it is woken by Osal_Futex_Wake() or timeout expires.
+ * Function may also return early, so caller must recheck its condition.
+ *
+ * @param pu32Addr 		[in] _Atomic uint32_t* address to wait on
+ * @param u32Expected 	[in] uint32_t value at address to sleep on
+ * @param pstTimeout 	[in] const struct timespec* relative timeout; NULL to wait without timeout
+ *
+ * @return [out] int32_t 0 if thread is woken or value has changed;
+ * 						 -1 if timeout expired or function failed
+ *
+ */
+int32_t Osal_Futex_Wait(_Atomic uint32_t *pu32Addr, uint32_t u32Expected,
+		const struct timespec *pstTimeout)
+{
+	long lRet = syscall(SYS_futex, (uint32_t *)pu32Addr, FUTEX_WAIT_PRIVATE,
+			u32Expected, pstTimeout, NULL, 0);
+
+	if(-1 == lRet && (EAGAIN == errno || EINTR == errno))
+	{
+		// value has changed before sleeping or signal is received
+		return 0;
+	}
+	return (0 == lRet) ? 0 : -1;
+} // End of Osal_Futex_Wait
+
+/**
+ * @fn int32_t Osal_Futex_Wake(_Atomic uint32_t *pu32Addr, int32_t i32Count)
+ *
+ * @brief This OSAL API wakes threads waiting in Osal_Futex_Wait() on pu32Addr.
+ *
+ * @param pu32Addr 	[in] _Atomic uint32_t* address threads are waiting on
+ * @param i32Count 	[in] int32_t maximum number of threads to wake
+ *
+ * @return [out] int32_t number of threads woken;
+ * 						 -1 if function failed
+ *
+ */
+int32_t Osal_Futex_Wake(_Atomic uint32_t *pu32Addr, int32_t i32Count)
+{
+	return (int32_t)syscall(SYS_futex, (uint32_t *)pu32Addr, FUTEX_WAKE_PRIVATE,
+			i32Count, NULL, NULL, 0);
+} // End of Osal_Futex_Wake
+
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+/**
+ * @fn bool Osal_Uring_Init(stOsalUring_t *pstUring, uint32_t u32Entries, uint32_t u32Flags)
+ *
+ * @brief This OSAL API sets up an io_uring and maps its submission and completion rings
+ * with raw system calls. Rings are mapped once if kernel supports a single mapping.
+ *
+ * @param pstUring 		[out] stOsalUring_t* io_uring to set up
+ * @param u32Entries 	[in] uint32_t number of submission queue entries
+ * @param u32Flags 		[in] uint32_t IORING_SETUP_* flags
+ *
+ * @return [out] bool true if io_uring is set up;
+ * 					  false if kernel does not support io_uring or flags, or function fails
+ *
+ */
+bool Osal_Uring_Init(stOsalUring_t *pstUring, uint32_t u32Entries, uint32_t u32Flags)
+{
+	struct io_uring_params stParams;
+	uint8_t *pu8Sq = NULL;
+	uint8_t *pu8Cq = NULL;
+
+	memset(pstUring, 0, sizeof(stOsalUring_t));
+	memset(&stParams, 0, sizeof(stParams));
+	stParams.flags = u32Flags;
+	pstUring->m_iFd = (int)syscall(__NR_io_uring_setup, u32Entries, &stParams);
+	if(pstUring->m_iFd < 0)
+	{
+		return false;
+	}
+	pstUring->m_u32Features = stParams.features;
+
+	pstUring->m_szSqRing = stParams.sq_off.array + stParams.sq_entries * sizeof(uint32_t);
+	pstUring->m_szCqRing = stParams.cq_off.cqes + stParams.cq_entries * sizeof(struct io_uring_cqe);
+	if(0 != (stParams.features & IORING_FEAT_SINGLE_MMAP))
+	{
+		if(pstUring->m_szCqRing > pstUring->m_szSqRing)
+		{
+			pstUring->m_szSqRing = pstUring->m_szCqRing;
+		}
+		pstUring->m_szCqRing = pstUring->m_szSqRing;
+	}
+	pstUring->m_pvSqRing = mmap(NULL, pstUring->m_szSqRing, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, pstUring->m_iFd, IORING_OFF_SQ_RING);
+	if(MAP_FAILED == pstUring->m_pvSqRing)
+	{
+		pstUring->m_pvSqRing = NULL;
+		Osal_Uring_Deinit(pstUring);
+		return false;
+	}
+	if(0 != (stParams.features & IORING_FEAT_SINGLE_MMAP))
+	{
+		pstUring->m_pvCqRing = pstUring->m_pvSqRing;
+	}
+	else
+	{
+		pstUring->m_pvCqRing = mmap(NULL, pstUring->m_szCqRing, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_POPULATE, pstUring->m_iFd, IORING_OFF_CQ_RING);
+		if(MAP_FAILED == pstUring->m_pvCqRing)
+		{
+			pstUring->m_pvCqRing = NULL;
+			Osal_Uring_Deinit(pstUring);
+			return false;
+		}
+	}
+	pstUring->m_szSqes = stParams.sq_entries * sizeof(struct io_uring_sqe);
+	pstUring->m_pstSqes = mmap(NULL, pstUring->m_szSqes, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, pstUring->m_iFd, IORING_OFF_SQES);
+	if(MAP_FAILED == pstUring->m_pstSqes)
+	{
+		pstUring->m_pstSqes = NULL;
+		Osal_Uring_Deinit(pstUring);
+		return false;
+	}
+
+	pu8Sq = pstUring->m_pvSqRing;
+	pstUring->m_pu32SqHead = (_Atomic uint32_t *)(pu8Sq + stParams.sq_off.head);
+	pstUring->m_pu32SqTail = (_Atomic uint32_t *)(pu8Sq + stParams.sq_off.tail);
+	pstUring->m_pu32SqArray = (uint32_t *)(pu8Sq + stParams.sq_off.array);
+	pstUring->m_u32SqMask = *(uint32_t *)(pu8Sq + stParams.sq_off.ring_mask);
+	pstUring->m_u32SqEntries = *(uint32_t *)(pu8Sq + stParams.sq_off.ring_entries);
+	pu8Cq = pstUring->m_pvCqRing;
+	pstUring->m_pu32CqHead = (_Atomic uint32_t *)(pu8Cq + stParams.cq_off.head);
+	pstUring->m_pu32CqTail = (_Atomic uint32_t *)(pu8Cq + stParams.cq_off.tail);
+	pstUring->m_u32CqMask = *(uint32_t *)(pu8Cq + stParams.cq_off.ring_mask);
+	pstUring->m_pstCqes = (struct io_uring_cqe *)(pu8Cq + stParams.cq_off.cqes);
+	return true;
+} // End of Osal_Uring_Init
+
+/**
+ * @fn void Osal_Uring_Deinit(stOsalUring_t *pstUring)
+ *
+ * @brief This OSAL API unmaps rings of an io_uring and closes it.
+ *
+ * @param pstUring [in] stOsalUring_t* io_uring
+ *
+ * @return [out] none
+ *
+ */
+void Osal_Uring_Deinit(stOsalUring_t *pstUring)
+{
+	if(NULL != pstUring->m_pstSqes)
+	{
+		munmap(pstUring->m_pstSqes, pstUring->m_szSqes);
+	}
+	if(NULL != pstUring->m_pvCqRing && pstUring->m_pvCqRing != pstUring->m_pvSqRing)
+	{
+		munmap(pstUring->m_pvCqRing, pstUring->m_szCqRing);
+	}
+	if(NULL != pstUring->m_pvSqRing)
+	{
+		munmap(pstUring->m_pvSqRing, pstUring->m_szSqRing);
+	}
+	if(pstUring->m_iFd >= 0)
+	{
+		close(pstUring->m_iFd);
+	}
+	memset(pstUring, 0, sizeof(stOsalUring_t));
+	pstUring->m_iFd = -1;
+} // End of Osal_Uring_Deinit
+
+/**
+ * @fn struct io_uring_sqe* Osal_Uring_Get_Sqe(stOsalUring_t *pstUring)
+ *
+ * @brief This OSAL API takes next submission queue entry and clears it. Entry is
+ * submitted with next call of Osal_Uring_Submit().
+ *
+ * @param pstUring [in] stOsalUring_t* io_uring
+ *
+ * @return [out] struct io_uring_sqe* entry to fill;
+ * 				 NULL if submission ring is full
+ *
+ */
+struct io_uring_sqe* Osal_Uring_Get_Sqe(stOsalUring_t *pstUring)
+{
+	uint32_t u32Tail = atomic_load_explicit(pstUring->m_pu32SqTail, memory_order_relaxed);
+	uint32_t u32Head = atomic_load_explicit(pstUring->m_pu32SqHead, memory_order_acquire);
+	uint32_t u32Index = 0;
+
+	if(u32Tail - u32Head >= pstUring->m_u32SqEntries)
+	{
+		return NULL;
+	}
+	u32Index = u32Tail & pstUring->m_u32SqMask;
+	pstUring->m_pu32SqArray[u32Index] = u32Index;
+	memset(&pstUring->m_pstSqes[u32Index], 0, sizeof(struct io_uring_sqe));
+	// entry is filled by caller before it is submitted
+	atomic_store_explicit(pstUring->m_pu32SqTail, u32Tail + 1, memory_order_release);
+	pstUring->m_u32SqPending++;
+	return &pstUring->m_pstSqes[u32Index];
+} // End of Osal_Uring_Get_Sqe
+
+/**
+ * @fn int32_t Osal_Uring_Submit(stOsalUring_t *pstUring, uint32_t u32WaitNr)
+ *
+ * @brief This OSAL API submits all filled entries with one system call and waits
+ * till at least given number of completions are available. Wait is a thread
+ * cancellation point.
+ *
+ * @param pstUring 	[in] stOsalUring_t* io_uring
+ * @param u32WaitNr [in] uint32_t number of completions to wait for; 0 not to wait
+ *
+ * @return [out] int32_t number of entries submitted;
+ * 						 -1 if function failed
+ *
+ */
+int32_t Osal_Uring_Submit(stOsalUring_t *pstUring, uint32_t u32WaitNr)
+{
+	long lRet = 0;
+	int iOldType = 0;
+
+	if(0 != u32WaitNr)
+	{
+		// io_uring_enter is not a cancellation point, allow cancel while waiting
+		pthread_setcanceltype(PTHREAD_CANCEL_ASYNCHRONOUS, &iOldType);
+	}
+	do
+	{
+		lRet = syscall(__NR_io_uring_enter, pstUring->m_iFd, pstUring->m_u32SqPending, u32WaitNr,
+				(0 != u32WaitNr) ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+	} while(-1 == lRet && EINTR == errno);
+	if(0 != u32WaitNr)
+	{
+		pthread_setcanceltype(iOldType, NULL);
+	}
+
+	if(lRet < 0)
+	{
+		return -1;
+	}
+	pstUring->m_u32SqPending -= (uint32_t)lRet;
+	return (int32_t)lRet;
+} // End of Osal_Uring_Submit
+
+/**
+ * @fn struct io_uring_cqe* Osal_Uring_Peek_Cqe(stOsalUring_t *pstUring)
+ *
+ * @brief This OSAL API gets oldest completion of an io_uring without waiting.
+ * Completion stays in ring till Osal_Uring_Cqe_Seen() is called.
+ *
+ * @param pstUring [in] stOsalUring_t* io_uring
+ *
+ * @return [out] struct io_uring_cqe* completion;
+ * 				 NULL if there is none
+ *
+ */
+struct io_uring_cqe* Osal_Uring_Peek_Cqe(stOsalUring_t *pstUring)
+{
+	uint32_t u32Head = atomic_load_explicit(pstUring->m_pu32CqHead, memory_order_relaxed);
+
+	if(u32Head == atomic_load_explicit(pstUring->m_pu32CqTail, memory_order_acquire))
+	{
+		return NULL;
+	}
+	return &pstUring->m_pstCqes[u32Head & pstUring->m_u32CqMask];
+} // End of Osal_Uring_Peek_Cqe
+
+/**
+ * @fn void Osal_Uring_Cqe_Seen(stOsalUring_t *pstUring)
+ *
+ * @brief This OSAL API gives oldest completion back to kernel.
+ *
+ * @param pstUring [in] stOsalUring_t* io_uring
+ *
+ * @return [out] none
+ *
+ */
+void Osal_Uring_Cqe_Seen(stOsalUring_t *pstUring)
+{
+	atomic_store_explicit(pstUring->m_pu32CqHead,
+			atomic_load_explicit(pstUring->m_pu32CqHead, memory_order_relaxed) + 1, memory_order_release);
+} // End of Osal_Uring_Cqe_Seen
+#endif
 
 /**
  * @fn Mutex_H Osal_Mutex(void)
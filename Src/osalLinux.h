@@ -30,13 +30,21 @@
 #define INC_OSALLINUX_H_
 
 #include <pthread.h>
-#include <sys/ipc.h>
-#include <sys/msg.h>
 #include <errno.h>
+#include <stdatomic.h>
+#include <time.h>
 #include "API.h"
 
-// Maximum received priority supported
-#define MAX_RECV_PRIORITY -100000
+// Default number of messages ring of a message queue holds before post waits, must be power of 2
+#define OSAL_MSG_QUEUE_SIZE 4096
+// Largest ring size of a message queue
+#define OSAL_MSG_QUEUE_MAX_SIZE (1U << 20)
+// Number of message priority levels, message types above (levels - 1) share last level
+#define OSAL_MSG_PRIORITY_LEVELS 64
+// Maximum number of message queues, must be a multiple of OSAL_MSG_QUEUE_CHUNK
+#define OSAL_MAX_MSG_QUEUES 16384
+// Number of message queues allocated at once when table of queues grows
+#define OSAL_MSG_QUEUE_CHUNK 64
 
 typedef pthread_t  Thread_H;
 typedef pthread_mutex_t*  Mutex_H;
@@ -88,6 +96,8 @@ void OSAL_Free(void *pvPointer);
 Thread_H Osal_Thread_Create(thread_Create_t *pThreadParam);
 // The OSAL Thread Terminate API will terminate Thread.
 bool Osal_Thread_Terminate(Thread_H pThreadTerminate);
+// Pin calling thread to a CPU
+bool Osal_Set_Thread_Affinity(int32_t i32Cpu);
 // The OSAL Mutex create API will generate Mutex
 Mutex_H Osal_Mutex(void);
 // The OSAL API Releases the Mutex acquired by process
@@ -98,13 +108,79 @@ int32_t Osal_Release_Mutex(Mutex_H pMtxHandle);
 int32_t Osal_Close_Mutex( Mutex_H pMtxHandle);
 // Copies a message to message queue
 int32_t OSAL_Init_Message_Queue();
+// Creates message queue with eventfd doorbell
+int32_t OSAL_Init_Event_Message_Queue(uint32_t u32Size);
+// Get eventfd doorbell of message queue
+int32_t OSAL_Get_Message_Queue_Event_Fd(int MsgQId);
+// Wake consumer of message queue without posting a message
+bool OSAL_Ring_Message_Queue(int MsgQId);
 // Copies a message to message queue
 bool OSAL_Post_Message(Post_Thread_Msg_t *pstPostThreadMsg);
+// Copies a message to message queue, waits for free space at most for given timeout
+bool OSAL_Post_Message_Timed(Post_Thread_Msg_t *pstPostThreadMsg, long lTimeoutMs);
 // Copies a message from message queue
 bool OSAL_Get_Message(Linux_Msg_t *pstQueueMsg, int   msqid);
+// Copies all ready messages from message queue
+int32_t OSAL_Get_Message_Batch(Linux_Msg_t *pstQueueMsgs, int32_t i32MaxMsgs, int msqid);
+// Copies ready messages from message queue without waiting, arms doorbell when empty
+int32_t OSAL_Poll_Message_Batch(Linux_Msg_t *pstQueueMsgs, int32_t i32MaxMsgs, int msqid);
 // Copies a message from message queue
 int32_t OSAL_Get_NonBlocking_Message(Linux_Msg_t *pstQueueMsg, int   msqid);
 // Delete a message from message queue.
 bool OSAL_Delete_Message_Queue(int MsgQId);
+// Get number of messages in message queue
+int32_t OSAL_Get_Message_Count(int MsgQId);
+// Wait while value at address is equal to expected value
+int32_t Osal_Futex_Wait(_Atomic uint32_t *pu32Addr, uint32_t u32Expected,
+		const struct timespec *pstTimeout);
+// Wake threads waiting on address
+int32_t Osal_Futex_Wake(_Atomic uint32_t *pu32Addr, int32_t i32Count);
+
+#ifdef MODBUS_STACK_IO_URING_ENABLED
+#include <linux/io_uring.h>
+// kernel headers define MAX_INPUT of terminals, stack defines its own in StackConfig.h
+#undef MAX_INPUT
+
+/**
+ @struct OsalUring
+ @brief
+    This structure defines an io_uring instance set up and mapped with raw system calls.
+    It must be used by a single thread.
+*/
+typedef struct OsalUring
+{
+	int m_iFd;									// io_uring descriptor
+	uint32_t m_u32Features;						// IORING_FEAT_* flags reported by kernel
+	void *m_pvSqRing;							// mapped submission ring
+	size_t m_szSqRing;							// size of submission ring mapping
+	void *m_pvCqRing;							// mapped completion ring, same as submission ring if shared
+	size_t m_szCqRing;							// size of completion ring mapping
+	struct io_uring_sqe *m_pstSqes;				// mapped submission queue entries
+	size_t m_szSqes;							// size of submission queue entries mapping
+	_Atomic uint32_t *m_pu32SqHead;				// submission ring head, moved by kernel
+	_Atomic uint32_t *m_pu32SqTail;				// submission ring tail
+	uint32_t *m_pu32SqArray;					// submission ring entries
+	uint32_t m_u32SqMask;						// submission ring mask
+	uint32_t m_u32SqEntries;					// submission ring size
+	uint32_t m_u32SqPending;					// entries filled, not submitted yet
+	_Atomic uint32_t *m_pu32CqHead;				// completion ring head
+	_Atomic uint32_t *m_pu32CqTail;				// completion ring tail, moved by kernel
+	uint32_t m_u32CqMask;						// completion ring mask
+	struct io_uring_cqe *m_pstCqes;				// completion queue entries
+}stOsalUring_t;
+
+// Set up io_uring with given number of submission entries and setup flags
+bool Osal_Uring_Init(stOsalUring_t *pstUring, uint32_t u32Entries, uint32_t u32Flags);
+// Release io_uring
+void Osal_Uring_Deinit(stOsalUring_t *pstUring);
+// Get an empty submission queue entry, NULL if submission ring is full
+struct io_uring_sqe* Osal_Uring_Get_Sqe(stOsalUring_t *pstUring);
+// Submit filled entries and wait for given number of completions
+int32_t Osal_Uring_Submit(stOsalUring_t *pstUring, uint32_t u32WaitNr);
+// Get oldest completion, NULL if there is none
+struct io_uring_cqe* Osal_Uring_Peek_Cqe(stOsalUring_t *pstUring);
+// Release oldest completion
+void Osal_Uring_Cqe_Seen(stOsalUring_t *pstUring);
+#endif
 
 #endif // INC_OSALLINUX_H_